@@ -18,10 +18,13 @@ test-groups.depends  = qanava
 test-styles.subdir   = tests/styles
 test-styles.depends  = qanava
 
+test-metrics.subdir   = tests/metrics
+test-metrics.depends  = qanava
+
 menubar..file    = qmlmenubar/qmlmenubar.pro
 menubar.subdir   = qmlmenubar
 
-SUBDIRS     +=  qanava test-basic test-container test-custom test-groups test-styles qmlmenubar
+SUBDIRS     +=  qanava test-basic test-container test-custom test-groups test-styles test-metrics qmlmenubar
 
 
 
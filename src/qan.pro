@@ -6,7 +6,7 @@ TARGET		= qanava
 DESTDIR		= ../build
 CONFIG		+= warn_on qt thread staticlib
 INCLUDEPATH	+= $(QTPROPERTYBROWSER)/src
-QT		+= core widgets gui xml
+QT		+= core widgets gui xml concurrent
  
 HEADERS +=	./qanConfig.h                   \
                 ./qanEdge.h                     \
@@ -15,11 +15,21 @@ HEADERS +=	./qanConfig.h                   \
                 ./qanLayout.h                   \
                 ./qanSimpleLayout.h             \
                 ./qanTreeLayout.h               \
+                ./qanLayoutCache.h              \
+                ./qanGraphIndex.h               \
+                ./qanStressLayout.h             \
+                ./qanLayoutMetrics.h            \
+                ./qanComponentLayout.h          \
+                ./qanOverlapRemoval.h           \
+                ./qanCompoundLayout.h           \
+                ./qanLayoutAnimator.h           \
                 ./qanNode.h                     \
                 ./qanController.h               \
                 ./qanNodeItem.h                 \
                 ./qanNodeRectItem.h             \
                 ./qanEdgeItem.h                 \
+                ./qanEdgeRouter.h               \
+                ./qanEdgeLayer.h                \
                 ./qanGraphItem.h                \
                 ./qanProperties.h               \
                 ./qanStyleManager.h             \
@@ -28,6 +38,10 @@ HEADERS +=	./qanConfig.h                   \
                 ./qanGraphScene.h               \
                 ./qanNodeGroup.h                \
                 ./qanGridItem.h                 \
+                ./qanTileCache.h                \
+                ./qanGraphExporter.h            \
+                ./qanPaintStatistics.h          \
+                ./qanEdgeBundle.h               \
                 ./ui/uiStyleEditorWidget.h      \
                 ./ui/uiStyleBrowserWidget.h     \
                 ./ui/uiNodeGroupFilterWidget.h  \
@@ -42,11 +56,21 @@ SOURCES += 	./qanEdge.cpp                       \
                 ./qanLayout.cpp                     \
                 ./qanSimpleLayout.cpp               \
                 ./qanTreeLayout.cpp                 \
+                ./qanLayoutCache.cpp                \
+                ./qanGraphIndex.cpp                 \
+                ./qanStressLayout.cpp               \
+                ./qanLayoutMetrics.cpp              \
+                ./qanComponentLayout.cpp            \
+                ./qanOverlapRemoval.cpp             \
+                ./qanCompoundLayout.cpp             \
+                ./qanLayoutAnimator.cpp             \
                 ./qanNode.cpp                       \
                 ./qanController.cpp                 \
                 ./qanNodeItem.cpp                   \
                 ./qanNodeRectItem.cpp               \
                 ./qanEdgeItem.cpp                   \
+                ./qanEdgeRouter.cpp                 \
+                ./qanEdgeLayer.cpp                  \
                 ./qanProperties.cpp                 \
                 ./qanStyleManager.cpp               \
                 ./qanGraphView.cpp                  \
@@ -55,6 +79,10 @@ SOURCES += 	./qanEdge.cpp                       \
                 ./qanNodeGroup.cpp                  \
                 ./qanGraphItem.cpp                  \
                 ./qanGridItem.cpp                   \
+                ./qanTileCache.cpp                  \
+                ./qanGraphExporter.cpp              \
+                ./qanPaintStatistics.cpp            \
+                ./qanEdgeBundle.cpp                 \
                 ./ui/uiStyleEditorWidget.cpp        \
                 ./ui/uiStyleBrowserWidget.cpp       \
                 ./ui/uiNodeGroupFilterWidget.cpp    \
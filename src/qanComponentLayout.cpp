@@ -0,0 +1,286 @@
+/*
+	Copyright (C) 2008-2015 Benoit AUTHEMAN
+
+    This file is part of Qanava.
+
+    Qanava is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Qanava is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with Qanava.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//-----------------------------------------------------------------------------
+// This file is a part of the Qanava software.
+//
+// \file	qanComponentLayout.cpp
+// \author	benoit@qanava.org
+// \date	2015 October 19
+//-----------------------------------------------------------------------------
+
+// Qt headers
+#include <QtMath>
+#include <QtAlgorithms>
+#include <QPair>
+#include <QtConcurrent/QtConcurrentMap>
+
+// Qanava headers
+#include "./qanComponentLayout.h"
+#include "./qanGraphIndex.h"
+
+
+namespace qan { // ::qan
+
+
+/* Component Layout Generation Management *///---------------------------------
+struct ComponentTask
+{
+	int				component;
+	Node::List		rootNodes;
+	Node::Set		nodes;
+	QRectF			br;
+	Layout*			layout;
+	int				iterationCount;
+};
+
+static bool	componentTaskLessThan( const ComponentTask& a, const ComponentTask& b )
+{
+	if ( a.nodes.size( ) != b.nodes.size( ) )
+		return a.nodes.size( ) > b.nodes.size( );	// Largest components first for a better load balancing
+	return a.component < b.component;
+}
+
+struct ComponentTaskFunctor
+{
+	typedef void result_type;
+	void	operator()( ComponentTask& task )
+	{
+		if ( task.layout == 0 )	// Single node component
+		{
+			foreach ( Node* node, task.nodes )
+				node->setPosition( task.br.topLeft( ) );
+			return;
+		}
+		task.layout->layout( task.rootNodes, task.nodes, task.br, 0, 0 );
+		task.iterationCount = task.layout->getIterationCount( );
+	}
+};
+
+void	ComponentLayout::layout( qan::Node::List& rootNodes, qan::Node::Set& nodes, QRectF br, qan::Node* center, QProgressDialog* progress )
+{
+    Q_UNUSED( center );
+	_iterationCount = 0;
+	if ( nodes.isEmpty( ) || _factory == 0 )
+		return;
+	if ( progress != 0 )
+	{
+		progress->setMaximum( 2 );
+		progress->setValue( 0 );
+	}
+
+	// Sub layouts run on worker threads where graphics items can't be accessed, they read the nodes sizes
+	// snapshot taken on the calling thread
+	snapshotNodeSizes( nodes );
+	GraphIndex index( nodes );
+	int n = index.getNodeCount( );
+	QVector< QSizeF > sizes( n );
+	for ( int i = 0; i < n; i++ )
+		sizes[ i ] = getNodeSize( *index.getNode( i ) );
+
+	// Split nodes by connected components, components without root node use their first node as root
+	QVector< int > components;
+	int componentCount = index.collectComponents( components );
+	Node::Set rootNodesSet = rootNodes.toSet( );
+	QVector< ComponentTask > tasks( componentCount );
+	for ( int c = 0; c < componentCount; c++ )
+	{
+		tasks[ c ].component = c;
+		tasks[ c ].layout = 0;
+		tasks[ c ].iterationCount = 0;
+	}
+	QVector< Node* > firstNodes( componentCount, 0 );
+	for ( int i = 0; i < n; i++ )
+	{
+		ComponentTask& task = tasks[ components[ i ] ];
+		Node* node = index.getNode( i );
+		task.nodes.insert( node );
+		if ( rootNodesSet.contains( node ) )
+			task.rootNodes << node;
+		if ( firstNodes[ components[ i ] ] == 0 )
+			firstNodes[ components[ i ] ] = node;
+	}
+	for ( int c = 0; c < componentCount; c++ )
+	{
+		ComponentTask& task = tasks[ c ];
+		if ( task.rootNodes.isEmpty( ) )
+			task.rootNodes << firstNodes[ c ];
+
+		// Keep the same nodes density than in the global layout rect
+		qreal scale = qSqrt( task.nodes.size( ) / ( qreal )n );
+		task.br = QRectF( 0., 0., qMax( br.width( ) * scale, ( qreal )100. ), qMax( br.height( ) * scale, ( qreal )100. ) );
+		if ( task.nodes.size( ) > 1 )
+			task.layout = _factory->create( );
+	}
+	qSort( tasks.begin( ), tasks.end( ), componentTaskLessThan );
+
+	QtConcurrent::blockingMap( tasks, ComponentTaskFunctor( ) );
+	if ( progress != 0 )
+		progress->setValue( 1 );
+
+	// Pack components bounding boxes, then translate components nodes in br
+	QVector< QRectF > boxes( tasks.size( ) );
+	QVector< QSizeF > boxSizes( tasks.size( ) );
+	for ( int t = 0; t < tasks.size( ); t++ )
+	{
+		_iterationCount = qMax( _iterationCount, tasks[ t ].iterationCount );
+		foreach ( Node* node, tasks[ t ].nodes )
+			boxes[ t ] = boxes[ t ].united( QRectF( node->getPosition( ), sizes[ index.getIndex( node ) ] ) );
+		boxSizes[ t ] = boxes[ t ].size( );
+	}
+	QVector< QPointF > positions;
+	pack( boxSizes, _aspectRatio, _spacing, positions );
+	for ( int t = 0; t < tasks.size( ); t++ )
+	{
+		QPointF delta = br.topLeft( ) + positions[ t ] - boxes[ t ].topLeft( );
+		foreach ( Node* node, tasks[ t ].nodes )
+			node->setPosition( node->getPosition( ) + delta );
+		delete tasks[ t ].layout;
+	}
+
+	if ( progress != 0 )
+		progress->close( );
+}
+
+QString	ComponentLayout::getParameters( ) const
+{
+	Layout* layout = ( _factory != 0 ? _factory->create( ) : 0 );
+	QString parameters = QString( "qan::ComponentLayout %1 %2 (%3)" ).arg( _aspectRatio ).arg( _spacing ).
+			arg( layout != 0 ? layout->getParameters( ) : QString( ) );
+	delete layout;
+	return parameters;
+}
+
+struct SkylineSegment
+{
+	qreal	x;
+	qreal	width;
+	qreal	y;
+};
+
+static bool	packOrderLessThan( const QPair< QSizeF, int >& a, const QPair< QSizeF, int >& b )
+{
+	if ( a.first.height( ) != b.first.height( ) )
+		return a.first.height( ) > b.first.height( );
+	if ( a.first.width( ) != b.first.width( ) )
+		return a.first.width( ) > b.first.width( );
+	return a.second < b.second;
+}
+
+void	ComponentLayout::pack( const QVector< QSizeF >& sizes, qreal aspectRatio, qreal spacing, QVector< QPointF >& positions )
+{
+	positions.fill( QPointF( 0., 0. ), sizes.size( ) );
+	if ( sizes.isEmpty( ) )
+		return;
+
+	// Rectangles are packed with their spacing, by decreasing height
+	QVector< QPair< QSizeF, int > > order;
+	order.reserve( sizes.size( ) );
+	qreal area = 0., maxWidth = 0.;
+	for ( int r = 0; r < sizes.size( ); r++ )
+	{
+		QSizeF size = sizes[ r ] + QSizeF( spacing, spacing );
+		order << qMakePair( size, r );
+		area += size.width( ) * size.height( );
+		maxWidth = qMax( maxWidth, size.width( ) );
+	}
+	qSort( order.begin( ), order.end( ), packOrderLessThan );
+	qreal stripWidth = qMax( maxWidth, qSqrt( area * qMax( aspectRatio, ( qreal )0.01 ) ) );
+
+	QVector< SkylineSegment > skyline;
+	SkylineSegment ground = { 0., stripWidth, 0. };
+	skyline << ground;
+	QVector< SkylineSegment > updated;
+	for ( int o = 0; o < order.size( ); o++ )
+	{
+		qreal w = order[ o ].first.width( );
+		qreal h = order[ o ].first.height( );
+
+		// Find the lowest (then leftmost) position starting on a skyline segment
+		qreal bestX = 0., bestY = -1.;
+		for ( int s = 0; s < skyline.size( ); s++ )
+		{
+			qreal x = skyline[ s ].x;
+			if ( x + w > stripWidth + 1e-6 )
+				break;
+			qreal y = 0.;
+			for ( int t = s; t < skyline.size( ) && skyline[ t ].x < x + w - 1e-9; t++ )
+				y = qMax( y, skyline[ t ].y );
+			if ( bestY < 0. || y < bestY )
+			{
+				bestX = x;
+				bestY = y;
+			}
+		}
+		positions[ order[ o ].second ] = QPointF( bestX, bestY );
+
+		// Raise the skyline under the packed rectangle
+		SkylineSegment packed = { bestX, w, bestY + h };
+		qreal packedEnd = bestX + w;
+		bool inserted = false;
+		updated.resize( 0 );
+		foreach ( const SkylineSegment& segment, skyline )
+		{
+			qreal end = segment.x + segment.width;
+			if ( end <= bestX )
+			{
+				updated << segment;
+				continue;
+			}
+			if ( segment.x >= packedEnd )
+			{
+				if ( !inserted )
+					updated << packed;
+				inserted = true;
+				updated << segment;
+				continue;
+			}
+			if ( segment.x < bestX )
+			{
+				SkylineSegment left = { segment.x, bestX - segment.x, segment.y };
+				updated << left;
+			}
+			if ( !inserted )
+				updated << packed;
+			inserted = true;
+			if ( end > packedEnd )
+			{
+				SkylineSegment right = { packedEnd, end - packedEnd, segment.y };
+				updated << right;
+			}
+		}
+		if ( !inserted )
+			updated << packed;
+
+		// Merge adjacent segments of same height
+		skyline.resize( 0 );
+		foreach ( const SkylineSegment& segment, updated )
+		{
+			if ( !skyline.isEmpty( ) && skyline.last( ).y == segment.y )
+				skyline.last( ).width += segment.width;
+			else
+				skyline << segment;
+		}
+	}
+}
+//-----------------------------------------------------------------------------
+
+
+} // ::qan
+
@@ -0,0 +1,105 @@
+/*
+	Copyright (C) 2008-2015 Benoit AUTHEMAN
+
+    This file is part of Qanava.
+
+    Qanava is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Qanava is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with Qanava.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//-----------------------------------------------------------------------------
+// This file is a part of the Qanava software.
+//
+// \file	qanComponentLayout.h
+// \author	benoit@qanava.org
+// \date	2015 October 19
+//-----------------------------------------------------------------------------
+
+
+#ifndef qanComponentLayout_h
+#define qanComponentLayout_h
+
+
+// Qanava headers
+#include "./qanLayout.h"
+
+
+// QT headers
+#include <QVector>
+#include <QRectF>
+
+
+//-----------------------------------------------------------------------------
+namespace qan { // ::qan
+
+	//! Layout each connected component independently and in parallel, then pack components bounding boxes.
+	/*!
+		Components are laid out on the global thread pool, each with its own layout instance created
+		by the layout factory given at construction (sub layouts must not rely on a progress dialog).
+		Nodes items sizes are copied to nodes dimension before (see Layout::snapshotNodeSizes()): sub
+		layouts get nodes sizes with Layout::getNodeSize() and must not access graphics items.
+		Resulting components bounding boxes are then packed with a bottom-left skyline packer, largest
+		components first, in a strip whose width is chosen to approach a target aspect ratio.
+
+		\nosubgrouping
+	*/
+	class ComponentLayout : public Layout
+	{
+		Q_OBJECT
+
+		/*! \name ComponentLayout Constructor/Destructor *///-------------------
+		//@{
+	public:
+
+		//! ComponentLayout constructor, layout factory ownership goes to this layout.
+		/*!	\param	factory		Factory creating the layout applied to each component.
+			\param	aspectRatio	Target width / height ratio of the packed components.
+			\param	spacing		Minimum distance between components bounding boxes.	*/
+		ComponentLayout( Layout::Factory* factory, qreal aspectRatio = 1.5, qreal spacing = 40. ) :
+			Layout( ), _factory( factory ), _aspectRatio( aspectRatio ), _spacing( spacing ) { }
+
+		virtual ~ComponentLayout( ) { delete _factory; }
+
+	protected:
+
+		Layout::Factory*	_factory;
+
+		qreal				_aspectRatio;
+
+		qreal				_spacing;
+		//@}
+		//---------------------------------------------------------------------
+
+
+
+		/*! \name Component Layout Generation Management *///------------------
+		//@{
+	public:
+
+		virtual void	layout( qan::Node::List& rootNodes, qan::Node::Set& nodes, QRectF br, qan::Node* center, QProgressDialog* progress = 0 );
+
+		virtual QString	getParameters( ) const;
+
+		//! Pack a list of rectangles sizes with a bottom-left skyline packer, return packed rectangles top left corners.
+		/*!	Rectangles are inserted by decreasing height, in a strip whose width is chosen so that packing aspect ratio is
+			close to aspectRatio, O(k.s) for k rectangles and a skyline of s segments.	*/
+		static void		pack( const QVector< QSizeF >& sizes, qreal aspectRatio, qreal spacing, QVector< QPointF >& positions );
+		//@}
+		//---------------------------------------------------------------------
+	};
+} // ::qan
+//-----------------------------------------------------------------------------
+
+
+#endif // qanComponentLayout_h
+
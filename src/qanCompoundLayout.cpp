@@ -0,0 +1,234 @@
+/*
+	Copyright (C) 2008-2015 Benoit AUTHEMAN
+
+    This file is part of Qanava.
+
+    Qanava is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Qanava is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with Qanava.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//-----------------------------------------------------------------------------
+// This file is a part of the Qanava software.
+//
+// \file	qanCompoundLayout.cpp
+// \author	benoit@qanava.org
+// \date	2015 October 20
+//-----------------------------------------------------------------------------
+
+// Qt headers
+#include <QHash>
+#include <QPair>
+#include <QtConcurrent/QtConcurrentMap>
+
+// Qanava headers
+#include "./qanCompoundLayout.h"
+#include "./qanStressLayout.h"
+#include "./qanOverlapRemoval.h"
+#include "./qanGraphScene.h"
+
+
+namespace qan { // ::qan
+
+
+/* CompoundLayout Constructor/Destructor *///----------------------------------
+CompoundLayout::CompoundLayout( GraphScene& scene, Layout* metaLayout ) :
+	Layout( ),
+	_scene( scene ),
+	_metaLayout( metaLayout )
+{
+	if ( _metaLayout == 0 )
+		_metaLayout = new OverlapRemoval( new StressMajorization( ), 20. );
+}
+//-----------------------------------------------------------------------------
+
+
+
+/* Compound Layout Generation Management *///----------------------------------
+//! Groups sharing the same graph layout instance, laid out sequentially.
+struct GroupLayoutTask
+{
+	QList< NodeGroup* >	groups;
+	QRectF				br;
+};
+
+struct GroupLayoutTaskFunctor
+{
+	typedef void result_type;
+	void	operator()( GroupLayoutTask& task )
+	{
+		foreach ( NodeGroup* group, task.groups )
+			group->layoutContent( task.br );
+	}
+};
+
+void	CompoundLayout::layout( qan::Node::List& rootNodes, qan::Node::Set& nodes, QRectF br, qan::Node* center, QProgressDialog* progress )
+{
+    Q_UNUSED( rootNodes ); Q_UNUSED( center );
+	_iterationCount = 0;
+	if ( progress != 0 )
+	{
+		progress->setMaximum( 3 );
+		progress->setValue( 0 );
+	}
+
+	// Collect top level groups laid out with a graph layout, and group them by layout instance
+	QList< NodeGroup* > groups;
+	QHash< Node*, NodeGroup* > nodeGroups;
+	Node::Set groupsNodes;
+	Node::Set ignoredNodes;		// Nodes of groups that are not laid out
+	QList< Layout* > groupLayouts;
+	QHash< Layout*, int > groupLayoutTasks;
+	QVector< GroupLayoutTask > tasks;
+	QRectF sceneRect = _scene.sceneRect( );
+	foreach ( NodeGroup* group, _scene.getNodeGroups( ) )
+	{
+		if ( group->getGraphLayout( ) == 0 || group->parentItem( ) != 0 || group->parentLayoutItem( ) != 0 )
+		{
+			ignoredNodes.unite( group->getNodes( ) );
+			continue;
+		}
+		groups << group;
+		foreach ( Node* node, group->getNodes( ) )
+			nodeGroups.insert( node, group );
+		groupsNodes.unite( group->getNodes( ) );
+
+		Layout* groupLayout = group->getGraphLayout( );
+		if ( !groupLayoutTasks.contains( groupLayout ) )
+		{
+			groupLayoutTasks.insert( groupLayout, tasks.size( ) );
+			groupLayouts << groupLayout;
+			GroupLayoutTask task;
+			task.br = sceneRect;
+			tasks << task;
+		}
+		tasks[ groupLayoutTasks.value( groupLayout ) ].groups << group;
+	}
+
+	// Layout groups content concurrently from a nodes size snapshot (graphics items can't be accessed from worker
+	// threads), then update groups items on the calling thread
+	snapshotNodeSizes( groupsNodes );
+	QtConcurrent::blockingMap( tasks, GroupLayoutTaskFunctor( ) );
+	foreach ( Layout* groupLayout, groupLayouts )
+		_iterationCount = qMax( _iterationCount, groupLayout->getIterationCount( ) );
+	foreach ( NodeGroup* group, groups )
+		group->updateContent( );
+	if ( progress != 0 )
+		progress->setValue( 1 );
+
+	// Build the meta graph: one meta node per group and per ungrouped node
+	QList< Node* > metaNodes;
+	QHash< NodeGroup*, Node* > groupMetaNodes;
+	QHash< Node*, Node* > nodeMetaNodes;
+	QHash< Node*, QRectF > metaNodeRects;	// Collapsed group rect in group CS
+	foreach ( NodeGroup* group, groups )
+	{
+		QRectF groupRect = group->boundingRect( ).united( group->childrenBoundingRect( ) );
+		Node* metaNode = new Node( group->getName( ) );
+		metaNode->setDimension( QPointF( groupRect.width( ), groupRect.height( ) ) );
+		metaNode->setPosition( group->pos( ) + groupRect.topLeft( ) );
+		metaNodes << metaNode;
+		groupMetaNodes.insert( group, metaNode );
+		metaNodeRects.insert( metaNode, groupRect );
+	}
+	foreach ( Node* node, nodes )
+	{
+		NodeGroup* group = nodeGroups.value( node, 0 );
+		if ( group != 0 )
+		{
+			nodeMetaNodes.insert( node, groupMetaNodes.value( group ) );
+			continue;
+		}
+		if ( ignoredNodes.contains( node ) )
+			continue;
+
+		QSizeF size = getNodeSize( *node );
+		Node* metaNode = new Node( node->getLabel( ) );
+		metaNode->setDimension( QPointF( size.width( ), size.height( ) ) );
+		metaNode->setPosition( node->getPosition( ) );
+		metaNodes << metaNode;
+		nodeMetaNodes.insert( node, metaNode );
+	}
+
+	// Meta edges weight is the number of edges between two meta nodes
+	QHash< QPair< Node*, Node* >, float > metaEdgeWeights;
+	foreach ( Node* node, nodes )
+	{
+		Node* metaSrc = nodeMetaNodes.value( node, 0 );
+		if ( metaSrc == 0 )
+			continue;
+		foreach ( Edge* edge, node->getOutEdges( ) )
+		{
+			Node* metaDst = nodeMetaNodes.value( &edge->getDst( ), 0 );
+			if ( metaDst != 0 && metaDst != metaSrc )
+				metaEdgeWeights[ qMakePair( metaSrc, metaDst ) ] += edge->getWeight( );
+		}
+	}
+	QList< Edge* > metaEdges;
+	QHash< QPair< Node*, Node* >, float >::const_iterator metaEdgeWeight = metaEdgeWeights.constBegin( );
+	for ( ; metaEdgeWeight != metaEdgeWeights.constEnd( ); ++metaEdgeWeight )
+	{
+		Node* metaSrc = metaEdgeWeight.key( ).first;
+		Node* metaDst = metaEdgeWeight.key( ).second;
+		Edge* metaEdge = new Edge( *metaSrc, *metaDst, metaEdgeWeight.value( ) );
+		metaSrc->addOutEdge( *metaEdge );
+		metaDst->addInEdge( *metaEdge );
+		metaEdges << metaEdge;
+	}
+
+	// Layout the meta graph
+	Node::List metaRootNodes;
+	Node::Set metaNodesSet;
+	foreach ( Node* metaNode, metaNodes )
+	{
+		metaNodesSet.insert( metaNode );
+		if ( metaNode->getInDegree( ) == 0 )
+			metaRootNodes << metaNode;
+	}
+	_metaLayout->layout( metaRootNodes, metaNodesSet, br, 0, 0 );
+	_iterationCount = qMax( _iterationCount, _metaLayout->getIterationCount( ) );
+	if ( progress != 0 )
+		progress->setValue( 2 );
+
+	// Move groups and ungrouped nodes to their meta node position
+	Edge::Set groupEdges;
+	foreach ( NodeGroup* group, groups )
+	{
+		Node* metaNode = groupMetaNodes.value( group );
+		group->setPos( metaNode->getPosition( ) - metaNodeRects.value( metaNode ).topLeft( ) );
+		foreach ( Node* node, group->getNodes( ) )
+		{
+			groupEdges.unite( node->getInEdges( ).toSet( ) );
+			groupEdges.unite( node->getOutEdges( ).toSet( ) );
+		}
+	}
+	foreach ( Node* node, nodes )
+		if ( !nodeGroups.contains( node ) && nodeMetaNodes.contains( node ) )
+			node->setPosition( nodeMetaNodes.value( node )->getPosition( ) );
+	foreach ( Edge* edge, groupEdges )
+		_scene.updateEdgeItem( *edge );
+
+	qDeleteAll( metaEdges );
+	qDeleteAll( metaNodes );
+	if ( progress != 0 )
+		progress->close( );
+}
+
+QString	CompoundLayout::getParameters( ) const
+{
+	return QString( "qan::CompoundLayout (%1)" ).arg( _metaLayout->getParameters( ) );
+}
+//-----------------------------------------------------------------------------
+
+
+} // ::qan
+
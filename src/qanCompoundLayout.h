@@ -0,0 +1,96 @@
+/*
+	Copyright (C) 2008-2015 Benoit AUTHEMAN
+
+    This file is part of Qanava.
+
+    Qanava is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Qanava is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with Qanava.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//-----------------------------------------------------------------------------
+// This file is a part of the Qanava software.
+//
+// \file	qanCompoundLayout.h
+// \author	benoit@qanava.org
+// \date	2015 October 20
+//-----------------------------------------------------------------------------
+
+
+#ifndef qanCompoundLayout_h
+#define qanCompoundLayout_h
+
+
+// Qanava headers
+#include "./qanLayout.h"
+
+
+//-----------------------------------------------------------------------------
+namespace qan { // ::qan
+
+	class GraphScene;
+
+	//! Layout a graph with node groups by laying out groups content, then placing groups relatively to each others.
+	/*!
+		Layout proceeds in four steps:
+		\li The content of every scene node group with a graph layout is laid out with NodeGroup::layoutContent(), concurrently
+		for groups using distinct graph layout instances (groups sharing a layout instance are laid out sequentially). Group
+		layouts read nodes sizes from a snapshot of their dimension (see Layout::snapshotNodeSizes()).
+		\li Each group is collapsed in a meta node whose size is the group size, nodes outside of groups are their own meta node.
+		\li The meta graph is laid out with the meta layout, meta edges weight is the number of edges between two meta nodes.
+		\li Groups are moved to their meta node position, ungrouped nodes positions are set to their meta node position.
+
+		Only top level groups laid out with a graph layout are collapsed, nodes of other groups are ignored. As with other layouts,
+		call GraphScene::updatePositions() to apply ungrouped nodes positions.
+
+		\nosubgrouping
+	*/
+	class CompoundLayout : public Layout
+	{
+		Q_OBJECT
+
+		/*! \name CompoundLayout Constructor/Destructor *///--------------------
+		//@{
+	public:
+
+		//! CompoundLayout constructor, meta layout ownership goes to this layout.
+		/*!	\param	metaLayout	Layout used for the meta graph, default to a stress majorization followed by an overlap removal. */
+		CompoundLayout( GraphScene& scene, Layout* metaLayout = 0 );
+
+		virtual ~CompoundLayout( ) { delete _metaLayout; }
+
+	protected:
+
+		GraphScene&		_scene;
+
+		Layout*			_metaLayout;
+		//@}
+		//---------------------------------------------------------------------
+
+
+
+		/*! \name Compound Layout Generation Management *///-------------------
+		//@{
+	public:
+
+		virtual void	layout( qan::Node::List& rootNodes, qan::Node::Set& nodes, QRectF br, qan::Node* center, QProgressDialog* progress = 0 );
+
+		virtual QString	getParameters( ) const;
+		//@}
+		//---------------------------------------------------------------------
+	};
+} // ::qan
+//-----------------------------------------------------------------------------
+
+
+#endif // qanCompoundLayout_h
+
@@ -0,0 +1,151 @@
+/*
+	Copyright (C) 2008-2015 Benoit AUTHEMAN
+
+    This file is part of Qanava.
+
+    Qanava is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Qanava is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with Qanava.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//-----------------------------------------------------------------------------
+// This file is a part of the Qanava software.
+//
+// \file	qanEdgeBundle.cpp
+// \author	benoit@qanava.org
+// \date	2015 October 25
+//-----------------------------------------------------------------------------
+
+// Qt headers
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <QtMath>
+
+// Qanava headers
+#include "./qanEdgeBundle.h"
+#include "./qanEdgeItem.h"
+#include "./qanGraphScene.h"
+
+
+namespace qan { // ::qan
+
+
+/* EdgeBundleItem Constructor/Destructor *///----------------------------------
+EdgeBundleItem::EdgeBundleItem( GraphScene& scene, NodeGroup& src, NodeGroup& dst ) :
+	QGraphicsItem( 0 ),
+	_scene( scene ),
+	_src( src ),
+	_dst( dst ),
+	_aggregated( false ),
+	_lineColor( 50, 50, 50 )
+{
+	setAcceptedMouseButtons( Qt::NoButton );
+	setFlag( QGraphicsItem::ItemIsMovable, false );
+	setFlag( QGraphicsItem::ItemIsSelectable, false );
+
+	Style* style = scene.getStyleManager( ).getTargetStyle( "qan::Edge" );
+	if ( style != 0 && style->has( "Line Color" ) )
+		_lineColor = style->getColor( "Line Color" );
+	_lineColor.setAlpha( 200 );
+}
+//-----------------------------------------------------------------------------
+
+
+
+/* Bundled Edges Management *///-----------------------------------------------
+void	EdgeBundleItem::addEdge( Edge& edge )
+{
+	_edges.insert( &edge );
+	updateBoundingRect( );
+	update( );
+}
+
+void	EdgeBundleItem::removeEdge( Edge& edge )
+{
+	_edges.remove( &edge );
+	updateBoundingRect( );
+	update( );
+}
+
+void	EdgeBundleItem::setAggregated( bool aggregated )
+{
+	if ( aggregated == _aggregated )
+		return;
+	_aggregated = aggregated;
+	update( );
+	foreach ( Edge* edge, _edges )	// Bundled edges are drawn again when the bundle is expanded
+		_scene.updateEdgeItem( *edge );
+}
+
+bool	EdgeBundleItem::isAggregated( qreal lod ) const
+{
+	return _aggregated || lod < _scene.getEdgeBundleThreshold( );
+}
+//-----------------------------------------------------------------------------
+
+
+
+/* Graphics Item Management *///-----------------------------------------------
+void	EdgeBundleItem::updateItem( )
+{
+	setVisible( _src.isVisible( ) && _dst.isVisible( ) );
+	setAggregated( _src.isCollapsed( ) || _dst.isCollapsed( ) );
+	setZValue( qMax( _src.zValue( ), _dst.zValue( ) ) + 0.5 );	// Over groups background, under group nodes
+
+	QRectF srcBr = _src.sceneBoundingRect( );
+	QRectF dstBr = _dst.sceneBoundingRect( );
+	QLineF line = EdgeItem::getLineIntersection( QLineF( srcBr.center( ), dstBr.center( ) ), srcBr, dstBr );
+	if ( line == _line )
+		return;
+	_line = line;
+	updateBoundingRect( );
+}
+
+qreal	EdgeBundleItem::getLineWidth( int edgeCount )
+{
+	return qMin( 1. + 2. * qLn( qMax( edgeCount, 1 ) ) / qLn( 2. ), 24. );
+}
+
+/*!	Line width is cosmetic, bounding rect margin covers the line width down to a 5% view scale.
+ */
+void	EdgeBundleItem::updateBoundingRect( )
+{
+	qreal margin = getLineWidth( getEdgeCount( ) ) / 0.05;
+	prepareGeometryChange( );
+	_br = QRectF( _line.p1( ), _line.p2( ) ).normalized( ).adjusted( -margin, -margin, margin, margin );
+}
+
+void	EdgeBundleItem::paint( QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget )
+{
+	Q_UNUSED( option ); Q_UNUSED( widget );
+	qreal lod = QStyleOptionGraphicsItem::levelOfDetailFromTransform( painter->worldTransform( ) );
+	if ( _edges.isEmpty( ) || !isAggregated( lod ) )
+		return;
+
+	QPen pen( _lineColor, getLineWidth( getEdgeCount( ) ), Qt::SolidLine, Qt::RoundCap );
+	pen.setCosmetic( true );
+	painter->setPen( pen );
+	painter->drawLine( _line );
+
+	// Edge count is drawn in device CS, so that it remains readable at any scale
+	QPointF center = painter->worldTransform( ).map( _line.pointAt( 0.5 ) );
+	painter->save( );
+	painter->resetTransform( );
+	painter->setPen( Qt::black );
+	painter->drawText( QRectF( center - QPointF( 40., 20. ), QSizeF( 80., 16. ) ), Qt::AlignCenter, QString::number( getEdgeCount( ) ) );
+	painter->restore( );
+}
+//-----------------------------------------------------------------------------
+
+
+} // ::qan
+
@@ -0,0 +1,151 @@
+/*
+	Copyright (C) 2008-2015 Benoit AUTHEMAN
+
+    This file is part of Qanava.
+
+    Qanava is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Qanava is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with Qanava.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//-----------------------------------------------------------------------------
+// This file is a part of the Qanava software.
+//
+// \file	qanEdgeBundle.h
+// \author	benoit@qanava.org
+// \date	2015 October 25
+//-----------------------------------------------------------------------------
+
+
+#ifndef qanEdgeBundle_h
+#define qanEdgeBundle_h
+
+
+// Qanava headers
+#include "./qanEdge.h"
+
+
+// QT headers
+#include <QGraphicsItem>
+#include <QColor>
+#include <QLineF>
+
+
+//-----------------------------------------------------------------------------
+namespace qan { // ::qan
+
+	class GraphScene;
+	class NodeGroup;
+
+	//! Draw every edge between two node groups as a single weighted line (see GraphScene::setEdgeBundlesEnabled()).
+	/*!
+		A bundle is drawn between its groups bounding rects when the view level of detail is lower than the scene
+		bundle threshold, or when one of its groups is collapsed. Bundled edges are not drawn while their bundle is
+		aggregated, so that zooming in expands the bundle back into individual edges.
+
+		Bundle line width is in pixels and grows with the logarithm of the number of bundled edges.
+
+		\nosubgrouping
+	*/
+	class EdgeBundleItem : public QGraphicsItem
+	{
+		/*! \name EdgeBundleItem Constructor/Destructor *///--------------------
+		//@{
+	public:
+
+		//! Bundle edges between src and dst groups, src and dst order is irrelevant.
+		EdgeBundleItem( GraphScene& scene, NodeGroup& src, NodeGroup& dst );
+
+		virtual ~EdgeBundleItem( ) { }
+
+		enum { Type = UserType + 42 + 5 };
+
+		virtual int		type( ) const { return Type; }
+
+		NodeGroup&		getSrc( ) { return _src; }
+
+		NodeGroup&		getDst( ) { return _dst; }
+
+	protected:
+
+		GraphScene&		_scene;
+
+		NodeGroup&		_src;
+
+		NodeGroup&		_dst;
+		//@}
+		//---------------------------------------------------------------------
+
+
+
+		/*! \name Bundled Edges Management *///--------------------------------
+		//@{
+	public:
+
+		void			addEdge( Edge& edge );
+
+		void			removeEdge( Edge& edge );
+
+		const Edge::Set&	getEdges( ) const { return _edges; }
+
+		int				getEdgeCount( ) const { return _edges.size( ); }
+
+		//! Force the bundle to be drawn instead of its edges at any level of detail (set by updateItem() when one of the groups is collapsed).
+		void			setAggregated( bool aggregated );
+
+		bool			isAggregated( ) const { return _aggregated; }
+
+		//! Return true if the bundle is drawn instead of its edges at a given level of detail.
+		bool			isAggregated( qreal lod ) const;
+
+	protected:
+
+		Edge::Set		_edges;
+
+		bool			_aggregated;
+		//@}
+		//---------------------------------------------------------------------
+
+
+
+		/*! \name Graphics Item Management *///--------------------------------
+		//@{
+	public:
+
+		//! Update bundle line, visibility and aggregation according to its groups bounding rect, visibility and collapse state.
+		void			updateItem( );
+
+		//! Return bundle line width in pixels for a given number of edges.
+		static qreal	getLineWidth( int edgeCount );
+
+		virtual QRectF	boundingRect( ) const { return _br; }
+
+		virtual void	paint( QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget = 0 );
+
+	protected:
+
+		void			updateBoundingRect( );
+
+		QLineF			_line;
+
+		QRectF			_br;
+
+		QColor			_lineColor;
+		//@}
+		//---------------------------------------------------------------------
+	};
+} // ::qan
+//-----------------------------------------------------------------------------
+
+
+#endif // qanEdgeBundle_h
+
@@ -36,6 +36,7 @@
 #include "./qanEdge.h"
 #include "./qanEdgeItem.h"
 #include "./qanGraphScene.h"
+#include "./qanEdgeRouter.h"
 
 
 namespace qan {	// ::qan
@@ -77,7 +78,7 @@ EdgeItem::EdgeItem( GraphScene& scene, Edge& edge ) :
     updateItemStyle( );
 
 	// Inititalize edge label item
-	_labelItem = new QGraphicsSimpleTextItem( this );
+	_labelItem = new EdgeLabelItem( this, _lodFullDetail );
 	_labelItem->setText( getEdge( ).getLabel( ) );
 }
 
@@ -88,19 +89,21 @@ EdgeItem::~EdgeItem( ) { }
 /* EdgeItem Graphics Item Management *///--------------------------------------
 void	EdgeItem::updateItem( )
 {
-    // Get the source and destination node graphics items
-    QGraphicsItem* srcGraphicsItem = getEdge( ).getSrc( ).getGraphicsItem( );
-    QGraphicsItem* dstGraphicsItem = getEdge( ).getDst( ).getGraphicsItem( );
+    if ( _scene.getPaintStatistics( ) != 0 )
+        _scene.getPaintStatistics( )->edgeUpdated( );
 
-    if ( srcGraphicsItem == 0 || dstGraphicsItem == 0 )
+    // Get the source and destination node graph items (or their group proxy item when their group is collapsed)
+    GraphItem* srcGraphItem = _scene.getEndpointItem( getEdge( ).getSrc( ) );
+    GraphItem* dstGraphItem = _scene.getEndpointItem( getEdge( ).getDst( ) );
+
+    if ( srcGraphItem == 0 || dstGraphItem == 0 )
         return;
 
-    QPolygonF srcBp = srcGraphicsItem->shape( ).toFillPolygon( QTransform( ).translate( srcGraphicsItem->scenePos( ).x( ),
-                                                                                        srcGraphicsItem->scenePos( ).y( ) ) );
-    QPolygonF dstBp = dstGraphicsItem->shape( ).toFillPolygon( QTransform( ).translate( dstGraphicsItem->scenePos( ).x( ),
-                                                                                        dstGraphicsItem->scenePos( ).y( ) ) );
-    QRectF srcBr = srcGraphicsItem->sceneBoundingRect( );
-	QRectF dstBr = dstGraphicsItem->sceneBoundingRect( );
+    // Endpoints shape polygons are cached by node items until they move
+    QPolygonF srcBp = srcGraphItem->getSceneShapePolygon( );
+    QPolygonF dstBp = dstGraphItem->getSceneShapePolygon( );
+    QRectF srcBr = srcGraphItem->getSceneContentRect( );
+	QRectF dstBr = dstGraphItem->getSceneContentRect( );
     _line = QLineF( srcBr.center( ), dstBr.center( ) ),
 
     //_line = getLineIntersection( _line, srcBr, dstBr );
@@ -153,6 +156,9 @@ void	EdgeItem::updateItemStyle( )
 	_arrowSize = 6.;
 
 	qan::Style* style = _styleManager.getStyle( getEdge( ) );
+	updateLodThresholds( style );
+	if ( _labelItem != 0 )
+		_labelItem->setLodThreshold( _lodFullDetail );
 	if ( style != 0 )
 	{
 		if ( style->has( "Draw Bounding Rect" ) )
@@ -173,12 +179,33 @@ void	EdgeItem::updateItemStyle( )
 
 
 /* Edge Drawing Management *///------------------------------------------------
+void	EdgeLabelItem::paint( QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget )
+{
+	if ( text( ).isEmpty( ) || GraphItem::getLod( painter ) < _lodThreshold )
+		return;
+	QGraphicsSimpleTextItem::paint( painter, option, widget );
+}
+
 void	EdgeItem::paint( QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget )
 {
     Q_UNUSED( option ); Q_UNUSED( widget );
 	if ( !isVisible( ) )
 		return;
 
+	// At low level of detail, draw a thin line without arrow, or nothing when the line is only a few pixels long
+	qreal lod = getLod( painter );
+	if ( _scene.isEdgeBundled( getEdge( ), lod ) )
+		return;	// Drawn by its bundle
+	LodTier lodTier = getLodTier( lod );
+	if ( lodTier >= LodMinimal )
+	{
+		if ( lodTier == LodDot && _line.length( ) * lod < 4. )
+			return;
+		painter->setPen( QPen( _lineColor, 0. ) );
+		painter->drawLine( mapFromScene( _line.p1( ) ), mapFromScene( _line.p2( ) ) );
+		return;
+	}
+
 	// Paint the line between src and dst
 	QPen arrowPen( _lineColor, _lineWidth, ( Qt::PenStyle )_lineStyle, Qt::RoundCap, Qt::RoundJoin );
 	if ( _hasArrow && _line.length( ) >= _arrowSize + 1. )
@@ -327,7 +354,8 @@ HEdgeItem::HEdgeItem( GraphScene& scene, HEdge& hEdge ) :
 	_inLineStyle( Qt::SolidLine ), 
 	_outLineStyle( Qt::SolidLine ),
 	_hLineWidth( 2. ),
-	_hLabelRect( )
+	_hLabelRect( ),
+	_hOrigin( )
 {
 	qan::Style* style = _styleManager.getStyle( hEdge );
 	if ( style == 0 )
@@ -336,17 +364,10 @@ HEdgeItem::HEdgeItem( GraphScene& scene, HEdge& hEdge ) :
 		if ( style != 0 )
 			_styleManager.styleEdge( _edge, style->getName( ), false );	// doNotUpdateItem = false to avoid infinite recursion
 	}
+	updateItemStyle( );
 }
 
-HEdgeItem::~HEdgeItem( ) 
-{ 
-	foreach ( QGraphicsSimpleTextItem* outLabelItem, _edgeOutLabels )
-		_scene.removeItem( outLabelItem );
-	_edgeOutLabels.clear( );
-	foreach ( QGraphicsSimpleTextItem* inLabelItem, _edgeInLabels )
-		_scene.removeItem( inLabelItem );
-	_edgeInLabels.clear( );
-}
+HEdgeItem::~HEdgeItem( ) { }	// Label items are deleted with their parent item
 //-----------------------------------------------------------------------------
 
 
@@ -355,61 +376,78 @@ void	HEdgeItem::updateItem( )
 {
 	EdgeItem::updateItem( );
 
-	// Put the in ou out hedge lines in cache
-	_edgeOutLines.clear( );
-	foreach ( QGraphicsSimpleTextItem* outLabelItem, _edgeOutLabels )
-		_scene.removeItem( outLabelItem );
-	_edgeOutLabels.clear( );
+	// Member lines only depend on the hyper edge origin and on member nodes rects
 	QPointF hOrigin = QPointF( _line.p1( ) + QPointF( _line.dx( ) / 2., _line.dy( ) / 2. ) );
+	bool originMoved = ( hOrigin != _hOrigin );
+	_hOrigin = hOrigin;
 
 	QPolygonF edgePolygon;
 	edgePolygon << _line.p1( ) << _line.p2( );
-
-	foreach ( qan::Node* hDst, _hEdge.getHDst( ) )
-	{
-		QGraphicsItem* hDstGraphicsItem = hDst->getGraphicsItem( );
-		Q_ASSERT( hDstGraphicsItem != 0 );
-
-		QRectF hDstBr = hDstGraphicsItem->sceneBoundingRect( );
-		QLineF line = QLineF( hOrigin, hDstBr.center( ) );
-		line = EdgeItem::getLineIntersection( line, QRectF( ), hDstBr );
-		_edgeOutLines.append( line );
-
-		QGraphicsSimpleTextItem* outLabel = new QGraphicsSimpleTextItem( this );
-		outLabel->setText( _hEdge.getHNodeLabelMap( ).value( hDst, QString( ) ) );
-		_edgeOutLabels.append( outLabel );
-		edgePolygon << line.p1( ) << line.p2( );
-	}
-	_edgeInLines.clear( );
-	foreach ( QGraphicsSimpleTextItem* inLabelItem, _edgeInLabels )
-		_scene.removeItem( inLabelItem );
-	_edgeInLabels.clear( );
-	foreach ( qan::Node* hSrc, _hEdge.getHSrc( ) )
-	{
-		QGraphicsItem* hSrcGraphicsItem = hSrc->getGraphicsItem( );
-		Q_ASSERT( hSrcGraphicsItem != 0 );
-
-		QRectF hSrcBr = hSrcGraphicsItem->sceneBoundingRect( );
-		QLineF line = QLineF( hSrcBr.center( ), hOrigin );
-		line = EdgeItem::getLineIntersection( line, hSrcBr, QRectF( ) );
-		_edgeInLines.append( line );
-
-		QGraphicsSimpleTextItem* inLabel = new QGraphicsSimpleTextItem( this );
-		inLabel->setText( _hEdge.getHNodeLabelMap( ).value( hSrc, QString( ) ) );
-		_edgeInLabels.append( inLabel );
-		edgePolygon << line.p1( ) << line.p2( );
-	}
-
-	updateItemStyle( );
+	updateMemberLines( _hEdge.getHDst( ), _edgeOutLines, true, originMoved, edgePolygon );
+	updateMemberLines( _hEdge.getHSrc( ), _edgeInLines, false, originMoved, edgePolygon );
 
 	// Configure the hedge base source and destination node
-	prepareGeometryChange( );
 	QRectF br( edgePolygon.boundingRect( ) );
 	br = br.normalized( ).adjusted( -_arrowSize, -_arrowSize, _arrowSize, _arrowSize );
 
 	prepareGeometryChange( );
 	setPos( br.topLeft( ) );
 	_br = QRectF( QPointF( 0., 0. ), br.size( ) );
+
+	// Center labels on their member line, once item position is known
+	for ( int m = 0; m < _edgeOutLines.size( ); m++ )
+	{
+		EdgeLabelItem* label = _edgeOutLines[ m ].label;
+		label->setPos( mapFromScene( _edgeOutLines[ m ].line.pointAt( 0.5 ) ) - QPointF( label->boundingRect( ).width( ) / 2., 0. ) );
+	}
+	for ( int m = 0; m < _edgeInLines.size( ); m++ )
+	{
+		EdgeLabelItem* label = _edgeInLines[ m ].label;
+		label->setPos( mapFromScene( _edgeInLines[ m ].line.pointAt( 0.5 ) ) - QPointF( label->boundingRect( ).width( ) / 2., 0. ) );
+	}
+}
+
+/*!	Label items are reused across updates: items are created or deleted only when the number of members changes,
+	and their text is set only when it has been modified.
+ */
+void	HEdgeItem::updateMemberLines( QSet< Node* >& members, QVector< MemberLine >& memberLines, bool out, bool originMoved, QPolygonF& edgePolygon )
+{
+	while ( memberLines.size( ) > members.size( ) )
+	{
+		delete memberLines.last( ).label;
+		memberLines.removeLast( );
+	}
+	while ( memberLines.size( ) < members.size( ) )
+	{
+		MemberLine memberLine;
+		memberLine.node = 0;
+		memberLine.label = new EdgeLabelItem( this, _lodFullDetail );
+		memberLines.append( memberLine );
+	}
+
+	int m = 0;
+	foreach ( Node* member, members )
+	{
+		MemberLine& memberLine = memberLines[ m++ ];
+		GraphItem* memberItem = _scene.getEndpointItem( *member );
+		Q_ASSERT( memberItem != 0 );
+
+		QRectF memberBr = memberItem->getSceneContentRect( );
+		if ( originMoved || memberLine.node != member || memberLine.nodeRect != memberBr )
+		{
+			if ( out )
+				memberLine.line = EdgeItem::getLineIntersection( QLineF( _hOrigin, memberBr.center( ) ), QRectF( ), memberBr );
+			else
+				memberLine.line = EdgeItem::getLineIntersection( QLineF( memberBr.center( ), _hOrigin ), memberBr, QRectF( ) );
+			memberLine.nodeRect = memberBr;
+		}
+		if ( memberLine.node != member )
+		{
+			memberLine.node = member;
+			memberLine.label->setText( _hEdge.getHNodeLabelMap( ).value( member, QString( ) ) );
+		}
+		edgePolygon << memberLine.line.p1( ) << memberLine.line.p2( );
+	}
 }
 
 void	HEdgeItem::updateItemStyle( )
@@ -431,6 +469,18 @@ void	HEdgeItem::updateItemStyle( )
 		const QVariant& hLineWidth = style->get( "Hyper Line Width" );
 		_hLineWidth = ( hLineWidth.isValid( ) ? hLineWidth.toFloat( ) : _hLineWidth );
 	}
+
+	// Force a full member lines and labels update
+	for ( int m = 0; m < _edgeOutLines.size( ); m++ )
+		_edgeOutLines[ m ].node = 0;
+	for ( int m = 0; m < _edgeInLines.size( ); m++ )
+		_edgeInLines[ m ].node = 0;
+	EdgeItem::updateItemStyle( );	// Update main line style and lod thresholds, then geometry
+
+	for ( int m = 0; m < _edgeOutLines.size( ); m++ )
+		_edgeOutLines[ m ].label->setLodThreshold( _lodFullDetail );
+	for ( int m = 0; m < _edgeInLines.size( ); m++ )
+		_edgeInLines[ m ].label->setLodThreshold( _lodFullDetail );
 }
 //-----------------------------------------------------------------------------
 
@@ -442,6 +492,26 @@ void	HEdgeItem::paint( QPainter* painter, const QStyleOptionGraphicsItem* option
 	if ( !isVisible( ) )
 		return;
 
+	// At low level of detail, draw thin lines without arrows and junction point, or nothing when the edge is only a few pixels wide
+	qreal lod = getLod( painter );
+	if ( _scene.isEdgeBundled( getEdge( ), lod ) )
+		return;
+	LodTier lodTier = getLodTier( lod );
+	if ( lodTier >= LodMinimal )
+	{
+		if ( lodTier == LodDot && qMax( _br.width( ), _br.height( ) ) * lod < 4. )
+			return;
+		painter->setPen( QPen( _lineColor, 0. ) );
+		painter->drawLine( mapFromScene( _line.p1( ) ), mapFromScene( _line.p2( ) ) );
+		painter->setPen( QPen( _outLineColor, 0. ) );
+		foreach ( const MemberLine& outLine, _edgeOutLines )
+			painter->drawLine( mapFromScene( outLine.line.p1( ) ), mapFromScene( outLine.line.p2( ) ) );
+		painter->setPen( QPen( _inLineColor, 0. ) );
+		foreach ( const MemberLine& inLine, _edgeInLines )
+			painter->drawLine( mapFromScene( inLine.line.p1( ) ), mapFromScene( inLine.line.p2( ) ) );
+		return;
+	}
+
 	QPen arrowPen( _lineColor, _lineWidth, ( Qt::PenStyle )_lineStyle, Qt::RoundCap, Qt::RoundJoin );
 	painter->setPen( arrowPen );
 
@@ -458,28 +528,20 @@ void	HEdgeItem::paint( QPainter* painter, const QStyleOptionGraphicsItem* option
 
 	// Paint the out lines
 	arrowPen = QPen( _outLineColor, _hLineWidth, ( Qt::PenStyle )_outLineStyle, Qt::RoundCap, Qt::RoundJoin );
-	int lineIndex( 0 );
-	foreach ( QLineF outLine, _edgeOutLines )
+	foreach ( const MemberLine& outLine, _edgeOutLines )
 	{
 		painter->setPen( arrowPen );
-		QLineF localOutLine( mapFromScene( outLine.p1( ) ), mapFromScene( outLine.p2( ) ) );
+		QLineF localOutLine( mapFromScene( outLine.line.p1( ) ), mapFromScene( outLine.line.p2( ) ) );
 		EdgeItem::drawArrow( painter, localOutLine, _outLineColor, _arrowSize );
-
-		QGraphicsSimpleTextItem* outLabel = _edgeOutLabels.at( lineIndex++ );
-		outLabel->setPos( localOutLine.pointAt( 0.5 ) - QPointF( outLabel->boundingRect( ).width( ) / 2., 0. ) );
 	}
 
 	// Paint the in line
 	arrowPen = QPen( _inLineColor, _hLineWidth, ( Qt::PenStyle )_inLineStyle, Qt::RoundCap, Qt::RoundJoin );
-	lineIndex = 0;
-	foreach ( QLineF inLine, _edgeInLines )
+	foreach ( const MemberLine& inLine, _edgeInLines )
 	{
 		painter->setPen( arrowPen );
-		QLineF localInLine( mapFromScene( inLine.p1( ) ), mapFromScene( inLine.p2( ) ) );
+		QLineF localInLine( mapFromScene( inLine.line.p1( ) ), mapFromScene( inLine.line.p2( ) ) );
 		EdgeItem::drawArrow( painter, localInLine, _inLineColor, _arrowSize );
-
-		QGraphicsSimpleTextItem* inLabel = _edgeInLabels.at( lineIndex++ );
-		inLabel->setPos( localInLine.pointAt( 0.5 ) - QPointF( inLabel->boundingRect( ).width( ) / 2., 0. ) );
 	}
 
 	// Debug code to visualize edge bbox
@@ -502,9 +564,36 @@ QRectF	HEdgeItem::boundingRect( ) const
 
 
 /* Ortho Edge Graphics Item Management *///------------------------------------
+/*! Route is taken from the scene edge router cache, it is recomputed only when a node in its corridor has moved. */
 void	OrthoEdgeItem::updateItem( )
 {
-	EdgeItem::updateItem( );
+	QPolygonF route = getScene( ).getEdgeRouter( ).getRoute( getEdge( ) );
+	if ( route.size( ) < 2 )
+		return;
+
+	QRectF br = route.boundingRect( );
+	qreal aSize = _arrowSize + _lineWidth;
+	br.adjust( -aSize, -aSize, aSize, aSize );
+
+	prepareGeometryChange( );
+	setPos( br.topLeft( ) );
+	_br = QRectF( QPointF( 0., 0. ), br.size( ) );
+	_route = route.translated( -br.topLeft( ) );
+	_line = QLineF( route.at( route.size( ) - 2 ), route.last( ) );
+
+	QPainterPath path;
+	path.addPolygon( _route );
+	QPainterPathStroker stroker;
+	stroker.setWidth( 2. * aSize );
+	_shape = stroker.createStroke( path );
+
+	// Label is centered on the route middle segment
+	if ( _labelItem != 0 )
+	{
+		int middle = ( _route.size( ) - 1 ) / 2;
+		QPointF center = ( _route.at( middle ) + _route.at( middle + 1 ) ) / 2.;
+		_labelItem->setPos( center - ( QPointF( _labelItem->boundingRect( ).width( ) / 2., 0. ) ) );
+	}
 }
 //-----------------------------------------------------------------------------
 
@@ -513,101 +602,38 @@ void	OrthoEdgeItem::updateItem( )
 void	OrthoEdgeItem::paint( QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget )
 {
     Q_UNUSED( option ); Q_UNUSED( widget );
-	// Get the source and destination node corresponding graph items
-	GraphItem* srcGraphItem = getScene( ).getGraphItem( getEdge( ).getSrc( ) );
-	GraphItem* dstGraphItem = getScene( ).getGraphItem( getEdge( ).getDst( ) );
-	if ( srcGraphItem == 0 || dstGraphItem == 0 )
+	if ( !isVisible( ) || _route.size( ) < 2 )
 		return;
 
-	QGraphicsItem* srcGraphicsItem = srcGraphItem->getGraphicsItem( );
-	QGraphicsItem* dstGraphicsItem = dstGraphItem->getGraphicsItem( );
-
+	qreal lod = getLod( painter );
+	LodTier lodTier = getLodTier( lod );
+	if ( lodTier >= LodMinimal )
 	{
-		QRectF srcBb = srcGraphicsItem->boundingRect( );
-		QRectF dstBb = dstGraphicsItem->boundingRect( );
-
-		QPointF srcCenter = srcGraphicsItem->mapToScene( srcBb.center( ) );
-		QPointF dstCenter = dstGraphicsItem->mapToScene( dstBb.center( ) );
-
-		QLineF finalLine;
-
-		// src is top right from dst
-		if ( ( srcCenter.x( ) > dstCenter.x( ) ) && ( srcCenter.y( ) < dstCenter.y( ) ) )
-		{
-			QRectF srcDstBb( QPointF( dstCenter.x( ), srcCenter.y( ) ), 
-							 QSizeF( abs( srcCenter.x( ) - dstCenter.x( ) ), abs( srcCenter.y( ) - dstCenter.y( ) ) ) );
-
-			QLineF lineA( mapFromScene( srcDstBb.topRight() ), mapFromScene( srcDstBb.bottomRight() ) );
-			finalLine = QLineF( mapFromScene( srcDstBb.bottomRight() ), mapFromScene( srcDstBb.bottomLeft() ) );
-
-			QPen arrowPen( Qt::black, _lineWidth, ( Qt::PenStyle )_lineStyle, Qt::RoundCap, Qt::RoundJoin );
-			painter->setPen( arrowPen );
-			painter->drawLine( lineA );
-		}
-		// src is top left from dst
-		else if ( ( srcCenter.x( ) < dstCenter.x( ) ) && ( srcCenter.y( ) < dstCenter.y( ) ) )
-		{
-			QRectF srcDstBb( QPointF( srcCenter.x( ), srcCenter.y( ) ), 
-							 QSizeF( abs( srcCenter.x( ) - dstCenter.x( ) ), abs( srcCenter.y( ) - dstCenter.y( ) ) ) );
-
-			QLineF lineA( mapFromScene( srcDstBb.topLeft() ), mapFromScene( srcDstBb.bottomLeft() ) );
-			finalLine = QLineF( mapFromScene( srcDstBb.bottomLeft() ), mapFromScene( srcDstBb.bottomRight() ) );
-
-			QPen arrowPen( Qt::black, _lineWidth, ( Qt::PenStyle )_lineStyle, Qt::RoundCap, Qt::RoundJoin );
-			painter->setPen( arrowPen );
-			painter->drawLine( lineA );
-		}
-		// src is bottom left from dst
-		else if ( ( srcCenter.x( ) < dstCenter.x( ) ) && ( srcCenter.y( ) > dstCenter.y( ) ) )
-		{
-			QRectF srcDstBb( QPointF( srcCenter.x( ), dstCenter.y( ) ), 
-							 QSizeF( abs( srcCenter.x( ) - dstCenter.x( ) ), abs( srcCenter.y( ) - dstCenter.y( ) ) ) );
-
-			QLineF lineA( mapFromScene( srcDstBb.bottomLeft() ), mapFromScene( srcDstBb.topLeft() ) );
-			finalLine = QLineF( mapFromScene( srcDstBb.topLeft() ), mapFromScene( srcDstBb.topRight() ) );
-
-			QPen arrowPen( Qt::black, _lineWidth, ( Qt::PenStyle )_lineStyle, Qt::RoundCap, Qt::RoundJoin );
-			painter->setPen( arrowPen );
-			painter->drawLine( lineA );
-		}
-		// src is bottom right from dst
-		else if ( ( srcCenter.x( ) > dstCenter.x( ) ) && ( srcCenter.y( ) > dstCenter.y( ) ) )
-		{
-			QRectF srcDstBb( QPointF( dstCenter.x( ), dstCenter.y( ) ), 
-							 QSizeF( abs( srcCenter.x( ) - dstCenter.x( ) ), abs( srcCenter.y( ) - dstCenter.y( ) ) ) );
+		if ( lodTier == LodDot && qMax( _br.width( ), _br.height( ) ) * lod < 4. )
+			return;
+		painter->setPen( QPen( _lineColor, 0. ) );
+		painter->drawPolyline( _route );
+		return;
+	}
 
-			QLineF lineA( mapFromScene( srcDstBb.bottomRight() ), mapFromScene( srcDstBb.topRight() ) );
-			finalLine = QLineF( mapFromScene( srcDstBb.topRight() ), mapFromScene( srcDstBb.topLeft() ) );
+	painter->setPen( QPen( _lineColor, _lineWidth, ( Qt::PenStyle )_lineStyle, Qt::RoundCap, Qt::RoundJoin ) );
+	int last = _route.size( ) - 1;
+	QLineF finalLine( _route.at( last - 1 ), _route.at( last ) );
+	if ( _hasArrow && finalLine.length( ) >= _arrowSize + 1. )
+	{
+		painter->drawPolyline( _route.constData( ), last );		// Final segment is drawn with the arrow
+		drawArrow( painter, finalLine, _lineColor, _arrowSize );
+	}
+	else
+		painter->drawPolyline( _route );
 
-			QPen arrowPen( Qt::black, _lineWidth, ( Qt::PenStyle )_lineStyle, Qt::RoundCap, Qt::RoundJoin );
-			painter->setPen( arrowPen );
-			painter->drawLine( lineA );
-		}
+	if ( _drawBRect )
+		painter->drawRect( boundingRect( ).adjusted( +1., +1., -1., -1. ) );
+}
 
-		// Find the intersection between final line and dst bounding box
-		QRectF br = mapFromItem( dstGraphicsItem, dstGraphicsItem->boundingRect( ) ).boundingRect( );
-		//QRectF br = mapFromScene( dstBb ).boundingRect( );   // FIXME v0.5.0, why mapFromScene doesn't works compared to mapFromItem ? (because EdgeItem has no common parent with dst...?)
-		QLineF dstTop( br.topLeft( ), br.topRight( ) );
-		QLineF dstRight( br.topRight( ), br.bottomRight( ) );
-		QLineF dstBottom( br.bottomLeft( ), br.bottomRight( ) );
-		QLineF dstLeft( br.topLeft( ), br.bottomLeft( ) );
-
-		QPointF arrowEnd;
-		if ( finalLine.intersect( dstTop, &arrowEnd ) == QLineF::BoundedIntersection ||
-			finalLine.intersect( dstRight, &arrowEnd ) == QLineF::BoundedIntersection ||
-			finalLine.intersect( dstBottom, &arrowEnd ) == QLineF::BoundedIntersection ||
-			finalLine.intersect( dstLeft, &arrowEnd ) == QLineF::BoundedIntersection )
-		{
-			// Draw the arrow
-			const double Pi = 3.141592653;
-			double TwoPi = 2.0 * Pi;
-			double angle = ::acos( finalLine.dx( ) / finalLine.length( ) );
-			if ( finalLine.dy( ) <= 0 )
-				angle = TwoPi - angle;
-			painter->setPen( QPen( Qt::black, _lineWidth, ( Qt::PenStyle )_lineStyle, Qt::RoundCap, Qt::RoundJoin ) );
-			EdgeItem::drawArrow( painter, QLineF( finalLine.p1( ), arrowEnd ), QColor( Qt::black ) );
-		}
-	}
+QPainterPath	OrthoEdgeItem::shape( ) const
+{
+	return _shape;
 }
 //-----------------------------------------------------------------------------
 
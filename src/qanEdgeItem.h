@@ -44,6 +44,22 @@ namespace qan { // ::qan
 
 	class NodeItem;
 
+	//! Edge label item, label is not drawn under a given level of detail.
+	class EdgeLabelItem : public QGraphicsSimpleTextItem
+	{
+	public:
+
+		EdgeLabelItem( QGraphicsItem* parent, qreal lodThreshold = 0. ) : QGraphicsSimpleTextItem( parent ), _lodThreshold( lodThreshold ) { }
+
+		void			setLodThreshold( qreal lodThreshold ) { _lodThreshold = lodThreshold; }
+
+		virtual void	paint( QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget = 0 );
+
+	protected:
+
+		qreal			_lodThreshold;
+	};
+
 	//! Models an edge as a direct graphic line on the graph scene (edge is ended with an arrow and supports several style options).
 	class EdgeItem : public GraphItem
 	{
@@ -117,7 +133,7 @@ namespace qan { // ::qan
 
 		QPolygonF					_bp;
 
-		QGraphicsSimpleTextItem*	_labelItem;
+		EdgeLabelItem*				_labelItem;
 
 	public:
 
@@ -175,10 +191,11 @@ namespace qan { // ::qan
 	public:
 		virtual	QGraphicsItem*	getGraphicsItem( ) { return static_cast< QGraphicsItem* >( this ); }
 
+		//! Update hyper edge geometry, only member lines whose node or hyper edge origin has moved are recomputed.
 		virtual void			updateItem( );
 
-		//! Parse a given hyper edge style, and setup this item protected style properties.
-		void					updateItemStyle( ); 
+		//! Parse a given hyper edge style, and setup this item protected style properties (geometry is then updated).
+		virtual void			updateItemStyle( ); 
 
 	protected:
 
@@ -199,15 +216,27 @@ namespace qan { // ::qan
 
 	protected:
 
-		QRectF								_hLabelRect;
+		//! Line between the hyper edge origin and one of its member nodes, with a reusable label item.
+		struct MemberLine
+		{
+			Node*			node;
+			//! Member node content rect the line has been computed for.
+			QRectF			nodeRect;
+			QLineF			line;
+			EdgeLabelItem*	label;
+		};
 
-		QList< QLineF >						_edgeOutLines;
+		//! Update member lines for a set of in or out member nodes, and add lines ends to a polygon enclosing the hyper edge.
+		void								updateMemberLines( QSet< Node* >& members, QVector< MemberLine >& memberLines, bool out, bool originMoved, QPolygonF& edgePolygon );
 
-		QList< QGraphicsSimpleTextItem* >	_edgeOutLabels;
+		QRectF								_hLabelRect;
 
-		QList< QLineF >						_edgeInLines;
+		//! Hyper edge origin (middle of its main line) member lines have been computed for.
+		QPointF								_hOrigin;
 
-		QList< QGraphicsSimpleTextItem* >	_edgeInLabels;
+		QVector< MemberLine >				_edgeOutLines;
+
+		QVector< MemberLine >				_edgeInLines;
 		//@}
 		//---------------------------------------------------------------------
 
@@ -231,6 +260,7 @@ namespace qan { // ::qan
 
 
 	//! Model an edge on the graphic scene wich is modelled only with vertical and horizontal lines.
+	/*! Edge route avoids other nodes, it is computed and cached by the scene qan::EdgeRouter. */
 	class OrthoEdgeItem : public EdgeItem
 	{
 		Q_OBJECT
@@ -251,6 +281,11 @@ namespace qan { // ::qan
 	public:
 
 		virtual void	updateItem( );
+
+	protected:
+
+		//! Route polyline in item CS.
+		QPolygonF		_route;
 		//@}
 		//---------------------------------------------------------------------
 
@@ -260,6 +295,12 @@ namespace qan { // ::qan
 	public:
 
 		void			paint( QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget = 0 );
+
+		QPainterPath	shape( ) const;
+
+	protected:
+
+		QPainterPath	_shape;
 		//@}
 		//---------------------------------------------------------------------	};
 
@@ -268,7 +309,11 @@ namespace qan { // ::qan
 		public:
 
             virtual	GraphItem*	create( GraphScene& scene, Edge& edge )
-                { return new OrthoEdgeItem( scene, edge ); }
+			{
+                GraphItem* edgeItem = new OrthoEdgeItem( scene, edge );
+				edgeItem->updateItem( );
+				return edgeItem;
+			}
 
 			virtual	QString		getTargetClassName( ) { return QString( "qan::Edge" ); }
 		};	
@@ -0,0 +1,332 @@
+/*
+	Copyright (C) 2008-2015 Benoit AUTHEMAN
+
+    This file is part of Qanava.
+
+    Qanava is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Qanava is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with Qanava.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//-----------------------------------------------------------------------------
+// This file is a part of the Qanava software.
+//
+// \file	qanEdgeLayer.cpp
+// \author	benoit@qanava.org
+// \date	2015 October 22
+//-----------------------------------------------------------------------------
+
+// Qt headers
+#include <QPainter>
+#include <QPainterPath>
+#include <QStyleOptionGraphicsItem>
+#include <QGraphicsSceneHoverEvent>
+#include <QtMath>
+
+// Qanava headers
+#include "./qanEdgeLayer.h"
+#include "./qanEdgeItem.h"
+#include "./qanGraphScene.h"
+
+
+namespace qan { // ::qan
+
+
+/* EdgeLayer Constructor/Destructor *///---------------------------------------
+EdgeLayer::EdgeLayer( GraphScene& scene ) :
+	QGraphicsItem( 0 ),
+	_scene( scene ),
+	_index( 200. ),
+	_br( ),
+	_hoveredEdge( 0 )
+{
+	setZValue( 1. );
+	setAcceptedMouseButtons( Qt::NoButton );	// Propagate mouse events to items behind the layer
+	setAcceptHoverEvents( true );
+	setFlag( QGraphicsItem::ItemIsMovable, false );
+	setFlag( QGraphicsItem::ItemIsSelectable, false );
+}
+//-----------------------------------------------------------------------------
+
+
+
+/* Edge Management *///--------------------------------------------------------
+void	EdgeLayer::insertEdge( Edge& edge )
+{
+	int slot = _edgeSlots.value( &edge, -1 );
+	if ( slot < 0 )
+	{
+		if ( !_freeSlots.isEmpty( ) )
+		{
+			slot = _freeSlots.last( );
+			_freeSlots.pop_back( );
+		}
+		else
+		{
+			slot = _slots.size( );
+			_slots.resize( slot + 1 );
+		}
+		_edgeSlots.insert( &edge, slot );
+		_slots[ slot ].edge = &edge;
+	}
+	_slots[ slot ].bucket = getBucket( edge );
+	updateEdge( edge );
+}
+
+void	EdgeLayer::updateEdge( Edge& edge )
+{
+	int slot = _edgeSlots.value( &edge, -1 );
+	if ( slot < 0 )
+		return;
+
+	// Both previous and new edge areas must be repainted
+	QLineF& line = _slots[ slot ].line;
+	qreal margin = _buckets[ _slots[ slot ].bucket ].arrowSize + _buckets[ _slots[ slot ].bucket ].pen.widthF( );
+	if ( !line.isNull( ) )
+	{
+		QRectF oldLineBr = QRectF( line.p1( ), line.p2( ) ).normalized( ).adjusted( -margin, -margin, margin, margin );
+		update( oldLineBr );
+		_scene.addDirtyRect( oldLineBr );
+	}
+	line = getEdgeLine( edge );
+	QRectF lineBr = QRectF( line.p1( ), line.p2( ) ).normalized( ).adjusted( -margin, -margin, margin, margin );
+	_index.insert( slot, lineBr );
+	extendBoundingRect( line, margin );
+	update( lineBr );
+	_scene.addDirtyRect( lineBr );
+}
+
+void	EdgeLayer::removeEdge( Edge& edge )
+{
+	if ( _hoveredEdge == &edge )
+		_hoveredEdge = 0;
+	int slot = _edgeSlots.value( &edge, -1 );
+	if ( slot < 0 )
+		return;
+	update( _index.getRect( slot ) );
+	_scene.addDirtyRect( _index.getRect( slot ) );
+	_index.remove( slot );
+	_edgeSlots.remove( &edge );
+	_slots[ slot ].edge = 0;
+	_slots[ slot ].line = QLineF( );
+	_freeSlots << slot;
+}
+
+void	EdgeLayer::clear( )
+{
+	prepareGeometryChange( );
+	_buckets.clear( );
+	_bucketKeys.clear( );
+	_slots.clear( );
+	_freeSlots.clear( );
+	_edgeSlots.clear( );
+	_index.clear( );
+	_br = QRectF( );
+	_hoveredEdge = 0;
+}
+
+static qreal	getSegmentDistance( const QLineF& line, QPointF p )
+{
+	QPointF d = line.p2( ) - line.p1( );
+	qreal length2 = d.x( ) * d.x( ) + d.y( ) * d.y( );
+	qreal t = ( length2 > 0. ? QPointF::dotProduct( p - line.p1( ), d ) / length2 : 0. );
+	t = qBound( 0., t, 1. );
+	QPointF v = p - ( line.p1( ) + d * t );
+	return qSqrt( v.x( ) * v.x( ) + v.y( ) * v.y( ) );
+}
+
+Edge*	EdgeLayer::getEdgeAt( QPointF scenePos, qreal distance ) const
+{
+	QVector< int > slotIds;
+	_index.query( QRectF( scenePos - QPointF( distance, distance ), QSizeF( 2. * distance, 2. * distance ) ), slotIds );
+	Edge* closest = 0;
+	qreal closestDistance = distance;
+	foreach ( int slot, slotIds )
+	{
+		const Slot& s = _slots[ slot ];
+		if ( s.edge == 0 )
+			continue;
+		qreal d = getSegmentDistance( s.line, scenePos );
+		if ( d <= closestDistance )
+		{
+			closest = s.edge;
+			closestDistance = d;
+		}
+	}
+	return closest;
+}
+
+/*! Bucket key is made of the style line color, width, style and arrow size, so edges with different styles
+	but identical rendering share the same bucket.
+ */
+int		EdgeLayer::getBucket( Edge& edge )
+{
+	QColor lineColor( Qt::black );
+	qreal lineWidth = 2.;
+	int lineStyle = Qt::SolidLine;
+	qreal arrowSize = 6.;
+	StyleManager& styleManager = _scene.getStyleManager( );
+	qan::Style* style = styleManager.getStyle( edge );
+	if ( style == 0 )
+		style = styleManager.getTargetStyle( "qan::Edge" );
+	if ( style != 0 )
+	{
+		if ( style->has( "Line Style" ) )
+			lineStyle = style->get( "Line Style" ).toInt( ) + 1;	// +1 since 0 is noline and does not appears in style selection dialog
+		if ( style->has( "Line Color" ) )
+			lineColor = style->getColor( "Line Color" );
+		if ( style->has( "Line Width" ) )
+			lineWidth = style->get( "Line Width" ).toDouble( );
+		if ( style->has( "Arrow Size" ) )
+			arrowSize = style->get( "Arrow Size" ).toDouble( );
+	}
+
+	QString key = QString( "%1 %2 %3 %4" ).arg( lineColor.rgba( ) ).arg( lineWidth ).arg( lineStyle ).arg( arrowSize );
+	int bucket = _bucketKeys.value( key, -1 );
+	if ( bucket < 0 )
+	{
+		Bucket newBucket;
+		newBucket.pen = QPen( lineColor, lineWidth, ( Qt::PenStyle )lineStyle, Qt::RoundCap, Qt::RoundJoin );
+		newBucket.arrowSize = arrowSize;
+		bucket = _buckets.size( );
+		_buckets << newBucket;
+		_bucketKeys.insert( key, bucket );
+	}
+	return bucket;
+}
+
+QLineF	EdgeLayer::getEdgeLine( Edge& edge ) const
+{
+	GraphItem* srcItem = _scene.getEndpointItem( edge.getSrc( ) );
+	GraphItem* dstItem = _scene.getEndpointItem( edge.getDst( ) );
+	if ( srcItem == 0 || dstItem == 0 )
+		return QLineF( );
+	QRectF srcBr = srcItem->getSceneContentRect( );
+	QRectF dstBr = dstItem->getSceneContentRect( );
+	return EdgeItem::getLineIntersection( QLineF( srcBr.center( ), dstBr.center( ) ), srcBr, dstBr );
+}
+//-----------------------------------------------------------------------------
+
+
+
+/* Edge Layer Drawing Management *///------------------------------------------
+void	EdgeLayer::paint( QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget )
+{
+	Q_UNUSED( widget );
+	QVector< int > slotIds;
+	_index.query( option->exposedRect, slotIds );
+	if ( slotIds.isEmpty( ) )
+		return;
+
+	// Group visible edges by bucket, edges drawn by an edge bundle are skipped
+	qreal lod = QStyleOptionGraphicsItem::levelOfDetailFromTransform( painter->worldTransform( ) );
+	QVector< QVector< QLineF > > lines( _buckets.size( ) );
+	foreach ( int slot, slotIds )
+	{
+		const Slot& s = _slots[ slot ];
+		if ( s.edge != 0 && !s.line.isNull( ) && !_scene.isEdgeBundled( *s.edge, lod ) )
+			lines[ s.bucket ] << s.line;
+	}
+
+	for ( int b = 0; b < _buckets.size( ); b++ )
+	{
+		const QVector< QLineF >& bucketLines = lines[ b ];
+		if ( bucketLines.isEmpty( ) )
+			continue;
+		const Bucket& bucket = _buckets[ b ];
+		painter->setPen( bucket.pen );
+		painter->drawLines( bucketLines );
+
+		// Arrows are filled in one path, they are not drawn when smaller than a pixel
+		if ( bucket.arrowSize * lod < 1. )
+			continue;
+		QPainterPath arrows;
+		foreach ( const QLineF& line, bucketLines )
+		{
+			qreal length = line.length( );
+			if ( length < bucket.arrowSize + 1. )
+				continue;
+			QPointF u = ( line.p2( ) - line.p1( ) ) / length;
+			QPointF n( -u.y( ), u.x( ) );
+			QPointF base = line.p2( ) - u * ( 2. * bucket.arrowSize );
+			QPolygonF arrow;
+			arrow << base + n * bucket.arrowSize << line.p2( ) << base - n * bucket.arrowSize;
+			arrows.addPolygon( arrow );
+			arrows.closeSubpath( );
+		}
+		painter->fillPath( arrows, bucket.pen.color( ) );
+	}
+}
+
+void	EdgeLayer::extendBoundingRect( const QLineF& line, qreal margin )
+{
+	QRectF lineBr = QRectF( line.p1( ), line.p2( ) ).normalized( ).adjusted( -margin, -margin, margin, margin );
+	if ( _br.contains( lineBr ) )
+		return;
+	prepareGeometryChange( );
+	_br = ( _br.isNull( ) ? lineBr : _br.united( lineBr ) );
+}
+//-----------------------------------------------------------------------------
+
+
+
+/* Edge Promotion Management *///----------------------------------------------
+static const qreal	hoverDistance = 4.;
+
+void	EdgeLayer::hoverEnterEvent( QGraphicsSceneHoverEvent* e )
+{
+	// Mouse usually comes back from a promoted edge item
+	hoverMoveEvent( e );
+}
+
+void	EdgeLayer::hoverMoveEvent( QGraphicsSceneHoverEvent* e )
+{
+	QPointF p = e->scenePos( );
+
+	// Hovered edge is no longer in the layer, test it explicitly
+	if ( _hoveredEdge != 0 && getSegmentDistance( getEdgeLine( *_hoveredEdge ), p ) <= hoverDistance )
+		return;
+
+	Edge* edge = getEdgeAt( p, hoverDistance );
+	if ( _hoveredEdge != 0 )
+		releaseHoveredEdge( );
+	if ( edge != 0 )
+	{
+		_scene.promoteEdge( *edge );
+		_hoveredEdge = edge;
+	}
+}
+
+/*!	Hover leaves as soon as the promoted item is shown under the mouse: hovered edge is kept while the mouse
+	is still close to it.
+ */
+void	EdgeLayer::hoverLeaveEvent( QGraphicsSceneHoverEvent* e )
+{
+	if ( _hoveredEdge != 0 && getSegmentDistance( getEdgeLine( *_hoveredEdge ), e->scenePos( ) ) > hoverDistance )
+		releaseHoveredEdge( );
+}
+
+void	EdgeLayer::releaseHoveredEdge( )
+{
+	Edge* hoveredEdge = _hoveredEdge;
+	_hoveredEdge = 0;
+
+	// Selected edges are demoted when they are deselected (see GraphScene::demoteDeselectedEdges())
+	QGraphicsItem* edgeItem = hoveredEdge->getGraphicsItem( );
+	if ( edgeItem == 0 || !edgeItem->isSelected( ) )
+		_scene.demoteEdge( *hoveredEdge );
+}
+//-----------------------------------------------------------------------------
+
+
+} // ::qan
+
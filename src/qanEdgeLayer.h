@@ -0,0 +1,194 @@
+/*
+	Copyright (C) 2008-2015 Benoit AUTHEMAN
+
+    This file is part of Qanava.
+
+    Qanava is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Qanava is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with Qanava.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//-----------------------------------------------------------------------------
+// This file is a part of the Qanava software.
+//
+// \file	qanEdgeLayer.h
+// \author	benoit@qanava.org
+// \date	2015 October 22
+//-----------------------------------------------------------------------------
+
+
+#ifndef qanEdgeLayer_h
+#define qanEdgeLayer_h
+
+
+// Qanava headers
+#include "./qanEdge.h"
+#include "./qanEdgeRouter.h"
+
+
+// QT headers
+#include <QGraphicsItem>
+#include <QPen>
+#include <QHash>
+#include <QVector>
+#include <QLineF>
+
+
+//-----------------------------------------------------------------------------
+namespace qan { // ::qan
+
+	class GraphScene;
+
+	//! Draw plain edges from a single scene item, edges sharing the same pen and arrow are drawn in one call.
+	/*!
+		Edge geometry (a straight line clipped to source and destination node bounding rects) is stored in flat
+		arrays, grouped in buckets of edges with the same pen and arrow size. Edges are indexed in a uniform grid,
+		so that painting only draws edges intersecting the exposed rect, with one drawLines() and one path fill
+		(for arrows) per bucket.
+
+		The layer accepts hover events: the edge under the mouse is promoted to a real edge item (see
+		GraphScene::promoteEdge()) until the mouse moves away from it, and until it is deselected when it has
+		been selected meanwhile. Promoted items accept hover events (for their properties popup), the layer
+		decides demotion from the mouse distance to the promoted edge, not from the hover leave caused by the
+		promoted item.
+
+		\nosubgrouping
+	*/
+	class EdgeLayer : public QGraphicsItem
+	{
+		/*! \name EdgeLayer Constructor/Destructor *///-------------------------
+		//@{
+	public:
+
+		EdgeLayer( GraphScene& scene );
+
+		virtual ~EdgeLayer( ) { }
+
+		enum { Type = UserType + 42 + 4 };
+
+		virtual int		type( ) const { return Type; }
+
+	protected:
+
+		GraphScene&		_scene;
+		//@}
+		//---------------------------------------------------------------------
+
+
+
+		/*! \name Edge Management *///-----------------------------------------
+		//@{
+	public:
+
+		//! Insert an edge in this layer, or update its style and geometry if it is already registered.
+		void			insertEdge( Edge& edge );
+
+		//! Update an edge geometry (after one of its node has moved).
+		void			updateEdge( Edge& edge );
+
+		void			removeEdge( Edge& edge );
+
+		bool			hasEdge( Edge& edge ) const { return _edgeSlots.contains( &edge ); }
+
+		//! Get all edges drawn by this layer.
+		Edge::List		getEdges( ) const { return _edgeSlots.keys( ); }
+
+		void			clear( );
+
+		//! Get the top edge whose line is closer than a given distance from a scene position (0 if there is none).
+		Edge*			getEdgeAt( QPointF scenePos, qreal distance ) const;
+
+	protected:
+
+		struct Bucket
+		{
+			QPen			pen;
+			qreal			arrowSize;
+		};
+
+		struct Slot
+		{
+			Edge*			edge;
+			int				bucket;
+			QLineF			line;
+		};
+
+		//! Get the bucket of an edge according to its style (bucket is created if necessary).
+		int				getBucket( Edge& edge );
+
+		//! Compute an edge line clipped to its nodes bounding rect (or to their group proxy when the group is collapsed).
+		QLineF			getEdgeLine( Edge& edge ) const;
+
+		QVector< Bucket >		_buckets;
+
+		QHash< QString, int >	_bucketKeys;
+
+		QVector< Slot >			_slots;
+
+		QVector< int >			_freeSlots;
+
+		QHash< Edge*, int >		_edgeSlots;
+
+		RectIndex				_index;
+		//@}
+		//---------------------------------------------------------------------
+
+
+
+		/*! \name Edge Layer Drawing Management *///---------------------------
+		//@{
+	public:
+
+		virtual QRectF	boundingRect( ) const { return _br; }
+
+		virtual void	paint( QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget = 0 );
+
+	protected:
+
+		//! Extend this layer bounding rect to a given edge line.
+		void			extendBoundingRect( const QLineF& line, qreal margin );
+
+		QRectF			_br;
+		//@}
+		//---------------------------------------------------------------------
+
+
+
+		/*! \name Edge Promotion Management *///-------------------------------
+		//@{
+	public:
+
+		//! Get the edge promoted because it is under the mouse (0 if there is none).
+		Edge*			getHoveredEdge( ) const { return _hoveredEdge; }
+
+	protected:
+
+		virtual void	hoverEnterEvent( QGraphicsSceneHoverEvent* e );
+
+		virtual void	hoverMoveEvent( QGraphicsSceneHoverEvent* e );
+
+		virtual void	hoverLeaveEvent( QGraphicsSceneHoverEvent* e );
+
+		//! Forget the hovered edge, it is demoted unless it is selected.
+		void			releaseHoveredEdge( );
+
+		//! Edge promoted because it is under the mouse.
+		Edge*			_hoveredEdge;
+		//@}
+		//---------------------------------------------------------------------
+	};
+} // ::qan
+//-----------------------------------------------------------------------------
+
+
+#endif // qanEdgeLayer_h
+
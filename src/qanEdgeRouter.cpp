@@ -0,0 +1,496 @@
+/*
+	Copyright (C) 2008-2015 Benoit AUTHEMAN
+
+    This file is part of Qanava.
+
+    Qanava is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Qanava is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with Qanava.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//-----------------------------------------------------------------------------
+// This file is a part of the Qanava software.
+//
+// \file	qanEdgeRouter.cpp
+// \author	benoit@qanava.org
+// \date	2015 October 17
+//-----------------------------------------------------------------------------
+
+// Qt headers
+#include <QtMath>
+#include <QMultiMap>
+#include <QGraphicsItem>
+#include <QtAlgorithms>
+
+// Qanava headers
+#include "./qanEdgeRouter.h"
+#include "./qanNode.h"
+#include "./qanGraphItem.h"
+
+
+namespace qan { // ::qan
+
+
+/* Rectangle Index Management *///---------------------------------------------
+void	RectIndex::insert( int id, const QRectF& rect )
+{
+	if ( _rects.contains( id ) )
+		remove( id );
+	_rects.insert( id, rect );
+
+	int left, top, right, bottom;
+	getCells( rect, left, top, right, bottom );
+	for ( int y = top; y <= bottom; y++ )
+		for ( int x = left; x <= right; x++ )
+			_cells[ getCellKey( x, y ) ] << id;
+}
+
+void	RectIndex::remove( int id )
+{
+	if ( !_rects.contains( id ) )
+		return;
+
+	int left, top, right, bottom;
+	getCells( _rects.take( id ), left, top, right, bottom );
+	for ( int y = top; y <= bottom; y++ )
+		for ( int x = left; x <= right; x++ )
+		{
+			QHash< quint64, QVector< int > >::iterator cell = _cells.find( getCellKey( x, y ) );
+			if ( cell == _cells.end( ) )
+				continue;
+			int i = cell->indexOf( id );
+			if ( i >= 0 )
+				cell->remove( i );
+			if ( cell->isEmpty( ) )
+				_cells.erase( cell );
+		}
+}
+
+/*! Ids are appended to the given vector, the whole vector is then sorted and made unique. */
+void	RectIndex::query( const QRectF& rect, QVector< int >& ids ) const
+{
+	int left, top, right, bottom;
+	getCells( rect, left, top, right, bottom );
+	for ( int y = top; y <= bottom; y++ )
+		for ( int x = left; x <= right; x++ )
+		{
+			QHash< quint64, QVector< int > >::const_iterator cell = _cells.constFind( getCellKey( x, y ) );
+			if ( cell == _cells.constEnd( ) )
+				continue;
+			foreach ( int id, *cell )
+				if ( _rects.value( id ).intersects( rect ) )
+					ids << id;
+		}
+
+	qSort( ids );
+	int unique = 0;
+	for ( int i = 0; i < ids.size( ); i++ )
+		if ( i == 0 || ids[ i ] != ids[ unique - 1 ] )
+			ids[ unique++ ] = ids[ i ];
+	ids.resize( unique );
+}
+
+void	RectIndex::getCells( const QRectF& rect, int& left, int& top, int& right, int& bottom ) const
+{
+	left = qFloor( rect.left( ) / _cellSize );
+	top = qFloor( rect.top( ) / _cellSize );
+	right = qFloor( rect.right( ) / _cellSize );
+	bottom = qFloor( rect.bottom( ) / _cellSize );
+}
+//-----------------------------------------------------------------------------
+
+
+
+/* EdgeRouter Constructor/Destructor *///--------------------------------------
+EdgeRouter::EdgeRouter( qreal margin, qreal bendPenalty ) :
+	_margin( margin ),
+	_bendPenalty( bendPenalty ),
+	_obstacles( 150. ),
+	_nextNodeId( 0 ),
+	_corridors( 300. ),
+	_nextRouteId( 0 ),
+	_updating( false )
+{
+
+}
+//-----------------------------------------------------------------------------
+
+
+
+/* Obstacle Management *///----------------------------------------------------
+void	EdgeRouter::insertNode( Node& node )
+{
+	int id = _nodeIds.value( &node, -1 );
+	if ( id < 0 )
+	{
+		id = _nextNodeId++;
+		_nodeIds.insert( &node, id );
+		_idNodes.insert( id, &node );
+	}
+	_obstacles.insert( id, getNodeRect( node ) );
+}
+
+void	EdgeRouter::removeNode( Node& node )
+{
+	int id = _nodeIds.value( &node, -1 );
+	if ( id < 0 )
+		return;
+	_obstacles.remove( id );
+	_nodeIds.remove( &node );
+	_idNodes.remove( id );
+
+	foreach ( Edge* edge, node.getInEdges( ) )
+		removeEdge( *edge );
+	foreach ( Edge* edge, node.getOutEdges( ) )
+		removeEdge( *edge );
+}
+
+void	EdgeRouter::nodeMoved( Node& node, Edge::Set& rerouted )
+{
+	int id = _nodeIds.value( &node, -1 );
+	QRectF oldRect = ( id >= 0 ? _obstacles.getRect( id ) : QRectF( ) );
+	insertNode( node );
+	QRectF newRect = getNodeRect( node );
+
+	// Node edges are updated by the caller, just invalidate their routes
+	foreach ( Edge* edge, node.getInEdges( ) )
+	{
+		QHash< Edge*, Route >::iterator route = _routes.find( edge );
+		if ( route != _routes.end( ) )
+			route->dirty = true;
+	}
+	foreach ( Edge* edge, node.getOutEdges( ) )
+	{
+		QHash< Edge*, Route >::iterator route = _routes.find( edge );
+		if ( route != _routes.end( ) )
+			route->dirty = true;
+	}
+
+	// Invalidate routes whose corridor intersects node previous or new position
+	QVector< int > routeIds;
+	if ( !oldRect.isNull( ) )
+		_corridors.query( oldRect.adjusted( -_margin, -_margin, _margin, _margin ), routeIds );
+	_corridors.query( newRect.adjusted( -_margin, -_margin, _margin, _margin ), routeIds );
+	foreach ( int routeId, routeIds )
+	{
+		Edge* edge = _idEdges.value( routeId, 0 );
+		if ( edge == 0 || &edge->getSrc( ) == &node || &edge->getDst( ) == &node )
+			continue;
+		Route& route = _routes[ edge ];
+		if ( !route.dirty )
+		{
+			route.dirty = true;
+			rerouted.insert( edge );
+		}
+	}
+}
+
+void	EdgeRouter::clear( )
+{
+	_obstacles.clear( );
+	_nodeIds.clear( );
+	_idNodes.clear( );
+	_routes.clear( );
+	_idEdges.clear( );
+	_corridors.clear( );
+	_nextNodeId = 0;
+	_nextRouteId = 0;
+	_updating = false;	// Cleared during a batch (for example by GraphScene::clear()), routes must not stay deferred
+}
+
+QRectF	EdgeRouter::getNodeRect( Node& node ) const
+{
+	if ( node.getGraphItem( ) != 0 )
+		return node.getGraphItem( )->getSceneContentRect( );
+	return QRectF( node.getPosition( ), QSizeF( node.getDimension( ).x( ), node.getDimension( ).y( ) ) );
+}
+//-----------------------------------------------------------------------------
+
+
+
+/* Route Management *///-------------------------------------------------------
+/*! Returned reference is valid until another route is requested. */
+const QPolygonF&	EdgeRouter::getRoute( Edge& edge )
+{
+	if ( !edge.hasSrc( ) || !edge.hasDst( ) )
+		return _emptyRoute;
+
+	QHash< Edge*, Route >::iterator route = _routes.find( &edge );
+	if ( route == _routes.end( ) )
+	{
+		if ( !_nodeIds.contains( &edge.getSrc( ) ) )
+			insertNode( edge.getSrc( ) );
+		if ( !_nodeIds.contains( &edge.getDst( ) ) )
+			insertNode( edge.getDst( ) );
+
+		Route newRoute;
+		newRoute.id = _nextRouteId++;
+		newRoute.dirty = true;
+		route = _routes.insert( &edge, newRoute );
+		_idEdges.insert( newRoute.id, &edge );
+	}
+	if ( route->dirty && ( !_updating || route->polyline.isEmpty( ) ) )
+		computeRoute( edge, *route );
+	return route->polyline;
+}
+
+void	EdgeRouter::removeEdge( Edge& edge )
+{
+	QHash< Edge*, Route >::iterator route = _routes.find( &edge );
+	if ( route == _routes.end( ) )
+		return;
+	_corridors.remove( route->id );
+	_idEdges.remove( route->id );
+	_routes.erase( route );
+}
+
+void	EdgeRouter::endUpdate( Edge::Set& rerouted )
+{
+	_updating = false;
+	QHash< Edge*, Route >::iterator route = _routes.begin( );
+	for ( ; route != _routes.end( ); ++route )
+		if ( route->dirty )
+		{
+			computeRoute( *route.key( ), *route );
+			rerouted.insert( route.key( ) );
+		}
+}
+
+void	EdgeRouter::computeRoute( Edge& edge, Route& route )
+{
+	route.dirty = false;
+	Node& src = edge.getSrc( );
+	Node& dst = edge.getDst( );
+	QRectF srcRect = getNodeRect( src );
+	QRectF dstRect = getNodeRect( dst );
+	if ( srcRect.isNull( ) || dstRect.isNull( ) )
+	{
+		route.polyline.clear( );
+		_corridors.remove( route.id );
+		return;
+	}
+
+	// Collect obstacles in the corridor between source and destination
+	QRectF corridor = srcRect.united( dstRect ).adjusted( -4. * _margin, -4. * _margin, 4. * _margin, 4. * _margin );
+	QVector< int > obstacleIds;
+	_obstacles.query( corridor, obstacleIds );
+	QVector< QRectF > obstacles;
+	obstacles.reserve( obstacleIds.size( ) );
+	foreach ( int obstacleId, obstacleIds )
+	{
+		Node* node = _idNodes.value( obstacleId, 0 );
+		if ( node == &src || node == &dst )
+			continue;
+		obstacles << _obstacles.getRect( obstacleId ).adjusted( -_margin, -_margin, _margin, _margin );
+	}
+
+	route.polyline = this->route( srcRect, dstRect, obstacles );
+	_corridors.insert( route.id, route.polyline.boundingRect( ).adjusted( -_margin, -_margin, _margin, _margin ) );
+}
+
+static void	uniqueCoordinates( QVector< qreal >& coordinates )
+{
+	qSort( coordinates );
+	int unique = 0;
+	for ( int i = 0; i < coordinates.size( ); i++ )
+		if ( i == 0 || coordinates[ i ] != coordinates[ unique - 1 ] )
+			coordinates[ unique++ ] = coordinates[ i ];
+	coordinates.resize( unique );
+}
+
+static int	coordinateIndex( const QVector< qreal >& coordinates, qreal c )
+{
+	return qLowerBound( coordinates.begin( ), coordinates.end( ), c ) - coordinates.begin( );
+}
+
+/*!
+	Search is done on the grid formed by obstacles borders, source and destination centers: since obstacles
+	borders are grid lines, a grid segment is either completely inside or outside an obstacle. Search state
+	is a grid vertex and the direction used to reach it, so that bends could be penalized.
+ */
+QPolygonF	EdgeRouter::route( const QRectF& srcRect, const QRectF& dstRect, const QVector< QRectF >& obstacles ) const
+{
+	static const int MaxGridVertices = 128 * 128;
+
+	QPointF s = srcRect.center( );
+	QPointF t = dstRect.center( );
+
+	// Build the sparse grid, with an outer border allowing routes to go around every obstacle
+	QRectF bounds = srcRect.united( dstRect );
+	foreach ( const QRectF& obstacle, obstacles )
+		bounds = bounds.united( obstacle );
+	bounds.adjust( -_margin, -_margin, _margin, _margin );
+
+	QVector< qreal > xs, ys;
+	xs.reserve( obstacles.size( ) * 2 + 4 );
+	ys.reserve( obstacles.size( ) * 2 + 4 );
+	xs << s.x( ) << t.x( ) << bounds.left( ) << bounds.right( );
+	ys << s.y( ) << t.y( ) << bounds.top( ) << bounds.bottom( );
+	foreach ( const QRectF& obstacle, obstacles )
+	{
+		xs << obstacle.left( ) << obstacle.right( );
+		ys << obstacle.top( ) << obstacle.bottom( );
+	}
+	uniqueCoordinates( xs );
+	uniqueCoordinates( ys );
+	int nx = xs.size( );
+	int ny = ys.size( );
+	if ( nx * ny > MaxGridVertices )
+		return routeElbow( srcRect, dstRect );
+
+	// Mark grid segments lying inside obstacles: blockedH[v] is segment v to v+1 on x, blockedV[v] segment v to v+nx on y
+	QVector< bool > blockedH( nx * ny, false );
+	QVector< bool > blockedV( nx * ny, false );
+	foreach ( const QRectF& obstacle, obstacles )
+	{
+		int x0 = coordinateIndex( xs, obstacle.left( ) );
+		int x1 = coordinateIndex( xs, obstacle.right( ) );
+		int y0 = coordinateIndex( ys, obstacle.top( ) );
+		int y1 = coordinateIndex( ys, obstacle.bottom( ) );
+		for ( int iy = y0 + 1; iy < y1; iy++ )
+			for ( int ix = x0; ix < x1; ix++ )
+				blockedH[ iy * nx + ix ] = true;
+		for ( int ix = x0 + 1; ix < x1; ix++ )
+			for ( int iy = y0; iy < y1; iy++ )
+				blockedV[ iy * nx + ix ] = true;
+	}
+
+	// A* search, states are ( vertex * 5 + incoming direction ), direction 4 is the start state
+	const int dx[ 4 ] = { 1, -1, 0, 0 };
+	const int dy[ 4 ] = { 0, 0, 1, -1 };
+	const int reverse[ 4 ] = { 1, 0, 3, 2 };
+	int source = coordinateIndex( ys, s.y( ) ) * nx + coordinateIndex( xs, s.x( ) );
+	int target = coordinateIndex( ys, t.y( ) ) * nx + coordinateIndex( xs, t.x( ) );
+	int tx = target % nx, ty = target / nx;
+
+	QVector< qreal > costs( nx * ny * 5, -1. );
+	QVector< int > parents( nx * ny * 5, -1 );
+	QVector< bool > closed( nx * ny * 5, false );
+	QMultiMap< qreal, int > open;
+	costs[ source * 5 + 4 ] = 0.;
+	open.insert( 0., source * 5 + 4 );
+
+	int found = -1;
+	while ( !open.isEmpty( ) )
+	{
+		int state = open.begin( ).value( );
+		open.erase( open.begin( ) );
+		if ( closed[ state ] )
+			continue;
+		closed[ state ] = true;
+
+		int vertex = state / 5;
+		int direction = state % 5;
+		if ( vertex == target )
+		{
+			found = state;
+			break;
+		}
+
+		int ix = vertex % nx, iy = vertex / nx;
+		for ( int d = 0; d < 4; d++ )
+		{
+			if ( direction < 4 && d == reverse[ direction ] )
+				continue;
+			int jx = ix + dx[ d ], jy = iy + dy[ d ];
+			if ( jx < 0 || jx >= nx || jy < 0 || jy >= ny )
+				continue;
+			bool blocked = ( dy[ d ] == 0 ? blockedH[ iy * nx + qMin( ix, jx ) ] : blockedV[ qMin( iy, jy ) * nx + ix ] );
+			if ( blocked )
+				continue;
+
+			int next = ( jy * nx + jx ) * 5 + d;
+			qreal cost = costs[ state ] + qAbs( xs[ jx ] - xs[ ix ] ) + qAbs( ys[ jy ] - ys[ iy ] );
+			if ( direction < 4 && direction != d )
+				cost += _bendPenalty;
+			if ( closed[ next ] || ( costs[ next ] >= 0. && costs[ next ] <= cost ) )
+				continue;
+			costs[ next ] = cost;
+			parents[ next ] = state;
+
+			qreal heuristic = qAbs( xs[ tx ] - xs[ jx ] ) + qAbs( ys[ ty ] - ys[ jy ] );
+			if ( jx != tx && jy != ty )
+				heuristic += _bendPenalty;	// At least one more bend is necessary
+			open.insert( cost + heuristic, next );
+		}
+	}
+	if ( found < 0 )
+		return routeElbow( srcRect, dstRect );
+
+	// Build the polyline from target to source, keeping target, bend points and source: a vertex is a bend when
+	// the direction used to reach it differs from the direction used to leave it (source state direction is 4)
+	QPolygonF polyline;
+	int previousDirection = -1;
+	for ( int state = found; state >= 0; state = parents[ state ] )
+	{
+		int vertex = state / 5;
+		int direction = state % 5;
+		if ( polyline.isEmpty( ) || direction != previousDirection )
+			polyline.prepend( QPointF( xs[ vertex % nx ], ys[ vertex / nx ] ) );
+		previousDirection = direction;
+	}
+	clipRoute( polyline, srcRect, dstRect );
+	return polyline;
+}
+
+QPolygonF	EdgeRouter::routeElbow( const QRectF& srcRect, const QRectF& dstRect )
+{
+	QPointF s = srcRect.center( );
+	QPointF t = dstRect.center( );
+	QPolygonF polyline;
+	polyline << s;
+	if ( s.x( ) != t.x( ) && s.y( ) != t.y( ) )
+		polyline << QPointF( t.x( ), s.y( ) );
+	polyline << t;
+	clipRoute( polyline, srcRect, dstRect );
+	return polyline;
+}
+
+static QPointF	exitPoint( const QPointF& inside, const QPointF& outside, const QRectF& rect )
+{
+	if ( inside.y( ) == outside.y( ) )	// Horizontal segment
+		return QPointF( outside.x( ) > inside.x( ) ? rect.right( ) : rect.left( ), inside.y( ) );
+	return QPointF( inside.x( ), outside.y( ) > inside.y( ) ? rect.bottom( ) : rect.top( ) );
+}
+
+void	EdgeRouter::clipRoute( QPolygonF& polyline, const QRectF& srcRect, const QRectF& dstRect )
+{
+	if ( polyline.size( ) < 2 )
+		return;
+
+	// Remove the route part inside source
+	int first = 0;
+	while ( first < polyline.size( ) && srcRect.contains( polyline[ first ] ) )
+		first++;
+	if ( first > 0 && first < polyline.size( ) )
+	{
+		QPointF start = exitPoint( polyline[ first - 1 ], polyline[ first ], srcRect );
+		polyline.remove( 0, first );
+		polyline.prepend( start );
+	}
+
+	// Remove the route part inside destination
+	int last = polyline.size( ) - 1;
+	while ( last >= 0 && dstRect.contains( polyline[ last ] ) )
+		last--;
+	if ( last >= 0 && last < polyline.size( ) - 1 )
+	{
+		QPointF end = exitPoint( polyline[ last + 1 ], polyline[ last ], dstRect );
+		polyline.resize( last + 1 );
+		polyline << end;
+	}
+}
+//-----------------------------------------------------------------------------
+
+
+} // ::qan
+
@@ -0,0 +1,236 @@
+/*
+	Copyright (C) 2008-2015 Benoit AUTHEMAN
+
+    This file is part of Qanava.
+
+    Qanava is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Qanava is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with Qanava.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//-----------------------------------------------------------------------------
+// This file is a part of the Qanava software.
+//
+// \file	qanEdgeRouter.h
+// \author	benoit@qanava.org
+// \date	2015 October 17
+//-----------------------------------------------------------------------------
+
+
+#ifndef qanEdgeRouter_h
+#define qanEdgeRouter_h
+
+
+// Qanava headers
+#include "./qanNode.h"
+#include "./qanEdge.h"
+
+
+// QT headers
+#include <QRectF>
+#include <QPolygonF>
+#include <QHash>
+#include <QVector>
+
+
+//-----------------------------------------------------------------------------
+namespace qan { // ::qan
+
+	//! Uniform grid spatial index of rectangles identified by an integer id.
+	/*!
+		\nosubgrouping
+	*/
+	class RectIndex
+	{
+		/*! \name RectIndex Constructor/Destructor *///-------------------------
+		//@{
+	public:
+
+		//! RectIndex constructor with grid cell size initialization (cell size should be close to indexed rectangles average size).
+		RectIndex( qreal cellSize = 200. ) : _cellSize( cellSize ) { }
+
+		virtual ~RectIndex( ) { }
+		//@}
+		//---------------------------------------------------------------------
+
+
+
+		/*! \name Rectangle Index Management *///------------------------------
+		//@{
+	public:
+
+		//! Insert or move a rectangle in the index.
+		void			insert( int id, const QRectF& rect );
+
+		//! Remove a rectangle from the index.
+		void			remove( int id );
+
+		//! Remove every rectangle from the index.
+		void			clear( ) { _cells.clear( ); _rects.clear( ); }
+
+		//! Test if a given rectangle id is registered in this index.
+		bool			contains( int id ) const { return _rects.contains( id ); }
+
+		//! Get a registered rectangle (return a null rect if id is not registered).
+		QRectF			getRect( int id ) const { return _rects.value( id ); }
+
+		//! Collect ids of rectangles intersecting a given query rectangle, without duplicates.
+		void			query( const QRectF& rect, QVector< int >& ids ) const;
+
+	protected:
+
+		//! Get the cells range covered by a rectangle.
+		void			getCells( const QRectF& rect, int& left, int& top, int& right, int& bottom ) const;
+
+		static quint64	getCellKey( int x, int y ) { return ( ( quint64 )( quint32 )x << 32 ) | ( quint32 )y; }
+
+		qreal								_cellSize;
+
+		QHash< quint64, QVector< int > >	_cells;
+
+		QHash< int, QRectF >				_rects;
+		//@}
+		//---------------------------------------------------------------------
+	};
+
+
+	//! Compute and cache obstacle avoiding orthogonal routes for edges.
+	/*!
+		Routes are computed with an A* search on a sparse orthogonal grid built from the borders
+		of the obstacles (node rectangles expanded by a margin) found in the corridor between
+		edge source and destination. Bends are penalized, the grid is limited in size, and a
+		simple elbow route is used when no route could be found.
+
+		Routes are cached: when a node moves, only the routes of its edges and the routes whose
+		corridor intersects the node previous or new rectangle are invalidated. Between beginUpdate()
+		and endUpdate() (typically while a layout is applied), routes are only invalidated and are
+		all recomputed once in endUpdate().
+
+		\nosubgrouping
+	*/
+	class EdgeRouter
+	{
+		/*! \name EdgeRouter Constructor/Destructor *///------------------------
+		//@{
+	public:
+
+		//! EdgeRouter constructor.
+		/*!	\param	margin		Minimum distance between routes and obstacles.
+			\param	bendPenalty	Cost of a route bend, expressed as a route length.	*/
+		EdgeRouter( qreal margin = 10., qreal bendPenalty = 40. );
+
+		virtual ~EdgeRouter( ) { }
+
+	private:
+
+		Q_DISABLE_COPY( EdgeRouter );
+
+	protected:
+
+		qreal			_margin;
+
+		qreal			_bendPenalty;
+		//@}
+		//---------------------------------------------------------------------
+
+
+
+		/*! \name Obstacle Management *///-------------------------------------
+		//@{
+	public:
+
+		//! Register a node as an obstacle (or update its rectangle).
+		void			insertNode( Node& node );
+
+		//! Remove a node from obstacles, its edges routes are removed.
+		void			removeNode( Node& node );
+
+		//! Update a moved node obstacle rect and invalidate affected routes.
+		/*! \param	rerouted	Edges (not incident to node) whose routes have been invalidated, their graphics items must be updated. */
+		void			nodeMoved( Node& node, Edge::Set& rerouted );
+
+		//! Remove every obstacle and route, and end any pending bulk update (see beginUpdate()).
+		void			clear( );
+
+	protected:
+
+		QRectF			getNodeRect( Node& node ) const;
+
+		RectIndex				_obstacles;
+
+		QHash< Node*, int >		_nodeIds;
+
+		QHash< int, Node* >		_idNodes;
+
+		int						_nextNodeId;
+		//@}
+		//---------------------------------------------------------------------
+
+
+
+		/*! \name Route Management *///----------------------------------------
+		//@{
+	public:
+
+		//! Get an edge route polyline in scene CS, route is computed if it does not exist or has been invalidated (except during an update).
+		const QPolygonF&	getRoute( Edge& edge );
+
+		//! Remove an edge cached route.
+		void				removeEdge( Edge& edge );
+
+		//! Start a bulk update: moved nodes only invalidate routes until endUpdate() is called.
+		void				beginUpdate( ) { _updating = true; }
+
+		//! Recompute all invalidated routes, edges whose route has been recomputed are added to rerouted.
+		void				endUpdate( Edge::Set& rerouted );
+
+		//! Compute an orthogonal route between two rectangles, avoiding a list of obstacles.
+		QPolygonF			route( const QRectF& srcRect, const QRectF& dstRect, const QVector< QRectF >& obstacles ) const;
+
+		//! Compute a simple elbow route between two rectangles (horizontal, then vertical segment).
+		static QPolygonF	routeElbow( const QRectF& srcRect, const QRectF& dstRect );
+
+	protected:
+
+		struct Route
+		{
+			QPolygonF	polyline;
+			int			id;
+			bool		dirty;
+		};
+
+		//! Compute an edge route, and update its corridor in the corridor index.
+		void				computeRoute( Edge& edge, Route& route );
+
+		//! Clip a polyline so that it starts on srcRect border and ends on dstRect border.
+		static void			clipRoute( QPolygonF& polyline, const QRectF& srcRect, const QRectF& dstRect );
+
+		QHash< Edge*, Route >	_routes;
+
+		QHash< int, Edge* >		_idEdges;
+
+		RectIndex				_corridors;
+
+		int						_nextRouteId;
+
+		bool					_updating;
+
+		QPolygonF				_emptyRoute;
+		//@}
+		//---------------------------------------------------------------------
+	};
+} // ::qan
+//-----------------------------------------------------------------------------
+
+
+#endif // qanEdgeRouter_h
+
@@ -71,21 +71,21 @@ Graph::~Graph( )
 /*! This method clear the nodes, the fast node search cache, the node object mapping
     system and the edge list. Registered nodes and edges are not only dereferenced, but
 	destroyed with a call to delete.
+
+	Scene and model are cleared in bulk first, then nodes and edges are destroyed in one pass without being
+	disconnected from each other nor notified to listeners (use removeNode() to notify listeners).
  */
 void		Graph::clear( )
 {
 	_m.clear( );
 	_o.clear( );
+	_styleManager.clearMappings( );
 
-	foreach ( Edge* edge, _edges )
-		delete edge;
+	qDeleteAll( _edges );
 	_edges.clear( );
-
 	_nodesSet.clear( );
-	foreach ( Node* node, _nodes )
-		delete node;
+	qDeleteAll( _nodes );
 	_nodes.clear( );
-	_styleManager.clearMappings( );
 
     _rootNodes.clear( );
     _rootNodesSet.clear( );
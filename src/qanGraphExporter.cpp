@@ -0,0 +1,261 @@
+/*
+	Copyright (C) 2008-2015 Benoit AUTHEMAN
+
+    This file is part of Qanava.
+
+    Qanava is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Qanava is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with Qanava.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//-----------------------------------------------------------------------------
+// This file is a part of the Qanava software.
+//
+// \file	qanGraphExporter.cpp
+// \author	benoit@qanava.org
+// \date	2015 October 23
+//-----------------------------------------------------------------------------
+
+// Qt headers
+#include <QDir>
+#include <QFile>
+#include <QImage>
+#include <QPainter>
+#include <QPicture>
+#include <QThread>
+#include <QThreadStorage>
+#include <QXmlStreamWriter>
+#include <QtMath>
+#include <QtConcurrent/QtConcurrentRun>
+
+// Qanava headers
+#include "./qanGraphExporter.h"
+#include "./qanGraphScene.h"
+#include "./qanEdgeItem.h"
+
+
+namespace qan { // ::qan
+
+
+/* GraphExporter Constructor/Destructor *///-----------------------------------
+GraphExporter::GraphExporter( Graph& graph ) :
+	_graph( graph ),
+	_maxPendingTiles( qMax( 2, 2 * QThread::idealThreadCount( ) ) ),
+	_background( Qt::white )
+{
+
+}
+//-----------------------------------------------------------------------------
+
+
+
+/* Tile Pyramid Export Management *///-----------------------------------------
+//! Tile image of each worker thread, reused for every tile rasterized by this thread.
+static QThreadStorage< QImage* >	tileImages;
+
+static bool	rasterizeTile( QPicture picture, int tileSize, QColor background, QString fileName )
+{
+	if ( !tileImages.hasLocalData( ) || tileImages.localData( )->width( ) != tileSize )
+		tileImages.setLocalData( new QImage( tileSize, tileSize, QImage::Format_ARGB32_Premultiplied ) );
+	QImage& image = *tileImages.localData( );
+	image.fill( background );
+	QPainter painter( &image );
+	picture.play( &painter );
+	painter.end( );
+	return image.save( fileName, "PNG" );
+}
+
+int		GraphExporter::getPyramidLevelCount( QRectF sceneRect, int tileSize )
+{
+	qreal extent = qMax( sceneRect.width( ), sceneRect.height( ) );
+	if ( extent <= tileSize )
+		return 1;
+	return qCeil( qLn( extent / tileSize ) / qLn( 2. ) ) + 1;
+}
+
+/*!	Tiles are recorded level by level, the calling thread waits for the oldest pending tile when getMaxPendingTiles()
+	tiles are already in flight.
+ */
+bool	GraphExporter::exportPyramid( QString directory, int tileSize, QRectF sceneRect )
+{
+	GraphScene& scene = _graph.getM( );
+	if ( sceneRect.isEmpty( ) )
+		sceneRect = scene.itemsBoundingRect( );
+	if ( sceneRect.isEmpty( ) || tileSize <= 0 )
+		return false;
+
+	bool success = true;
+	QList< QFuture< bool > > pendingTiles;
+	int levelCount = getPyramidLevelCount( sceneRect, tileSize );
+	for ( int level = 0; level < levelCount && success; level++ )
+	{
+		QString levelDirectory = QString( "%1/%2" ).arg( directory ).arg( level );
+		if ( !QDir( ).mkpath( levelDirectory ) )
+			return false;
+
+		qreal scale = qPow( 2., level - ( levelCount - 1 ) );
+		qreal extent = tileSize / scale;	// Tile size in scene CS
+		int columns = qCeil( sceneRect.width( ) / extent );
+		int rows = qCeil( sceneRect.height( ) / extent );
+		for ( int y = 0; y < rows && success; y++ )
+			for ( int x = 0; x < columns && success; x++ )
+			{
+				QRectF tileRect( sceneRect.left( ) + x * extent, sceneRect.top( ) + y * extent, extent, extent );
+				if ( scene.items( tileRect, Qt::IntersectsItemBoundingRect ).isEmpty( ) )
+					continue;
+
+				QPicture picture;
+				QPainter painter( &picture );
+				painter.setRenderHints( QPainter::Antialiasing | QPainter::TextAntialiasing | QPainter::SmoothPixmapTransform );
+				painter.scale( scale, scale );
+				painter.translate( -tileRect.topLeft( ) );
+				scene.render( &painter, tileRect, tileRect, Qt::IgnoreAspectRatio );
+				painter.end( );
+
+				while ( pendingTiles.size( ) >= _maxPendingTiles )
+					success = pendingTiles.takeFirst( ).result( ) && success;
+				QString fileName = QString( "%1/%2_%3.png" ).arg( levelDirectory ).arg( x ).arg( y );
+				pendingTiles << QtConcurrent::run( rasterizeTile, picture, tileSize, _background, fileName );
+			}
+	}
+	while ( !pendingTiles.isEmpty( ) )
+		success = pendingTiles.takeFirst( ).result( ) && success;
+	return success;
+}
+//-----------------------------------------------------------------------------
+
+
+
+/* SVG Export Management *///--------------------------------------------------
+bool	GraphExporter::exportSvg( QString fileName, int chunkSize )
+{
+	QFile file( fileName );
+	if ( !file.open( QIODevice::WriteOnly | QIODevice::Text ) )
+		return false;
+	return exportSvg( file, chunkSize );
+}
+
+QRectF	GraphExporter::getNodeRect( Node& node )
+{
+	if ( node.getGraphItem( ) != 0 )
+		return node.getGraphItem( )->getSceneContentRect( );
+	return QRectF( node.getPosition( ), QSizeF( node.getDimension( ).x( ), node.getDimension( ).y( ) ) );
+}
+
+/*!	Edges are written first, so that nodes are drawn over them. Document size is the nodes bounding rect.
+ */
+bool	GraphExporter::exportSvg( QIODevice& device, int chunkSize )
+{
+	chunkSize = qMax( 1, chunkSize );
+	StyleManager& styleManager = _graph.getM( ).getStyleManager( );
+	QRectF br;
+	foreach ( Node* node, _graph.getNodes( ) )
+		br |= getNodeRect( *node );
+
+	QXmlStreamWriter xml( &device );
+	xml.setAutoFormatting( true );
+	xml.writeStartDocument( );
+	xml.writeStartElement( "svg" );
+	xml.writeDefaultNamespace( "http://www.w3.org/2000/svg" );
+	xml.writeAttribute( "version", "1.1" );
+	xml.writeAttribute( "viewBox", QString( "%1 %2 %3 %4" ).arg( br.left( ) ).arg( br.top( ) ).arg( br.width( ) ).arg( br.height( ) ) );
+	xml.writeAttribute( "width", QString::number( br.width( ) ) );
+	xml.writeAttribute( "height", QString::number( br.height( ) ) );
+
+	// Edges
+	int element = 0;
+	xml.writeStartElement( "g" );
+	foreach ( Edge* edge, _graph.getEdges( ) )
+	{
+		if ( element > 0 && element % chunkSize == 0 )
+		{
+			xml.writeEndElement( );		// Close current chunk group
+			xml.writeStartElement( "g" );
+		}
+		element++;
+
+		QColor lineColor( Qt::black );
+		qreal lineWidth = 2.;
+		qan::Style* style = styleManager.getStyle( *edge );
+		if ( style == 0 )
+			style = styleManager.getTargetStyle( "qan::Edge" );
+		if ( style != 0 && style->has( "Line Color" ) )
+			lineColor = style->getColor( "Line Color" );
+		if ( style != 0 && style->has( "Line Width" ) )
+			lineWidth = style->get( "Line Width" ).toDouble( );
+
+		QRectF srcBr = getNodeRect( edge->getSrc( ) );
+		QRectF dstBr = getNodeRect( edge->getDst( ) );
+		QLineF line = EdgeItem::getLineIntersection( QLineF( srcBr.center( ), dstBr.center( ) ), srcBr, dstBr );
+		xml.writeEmptyElement( "line" );
+		xml.writeAttribute( "x1", QString::number( line.x1( ) ) );
+		xml.writeAttribute( "y1", QString::number( line.y1( ) ) );
+		xml.writeAttribute( "x2", QString::number( line.x2( ) ) );
+		xml.writeAttribute( "y2", QString::number( line.y2( ) ) );
+		xml.writeAttribute( "stroke", lineColor.name( ) );
+		xml.writeAttribute( "stroke-width", QString::number( lineWidth ) );
+	}
+	xml.writeEndElement( );
+
+	// Nodes
+	element = 0;
+	xml.writeStartElement( "g" );
+	xml.writeAttribute( "font-family", "sans-serif" );
+	foreach ( Node* node, _graph.getNodes( ) )
+	{
+		if ( element > 0 && element % chunkSize == 0 )
+		{
+			xml.writeEndElement( );
+			xml.writeStartElement( "g" );
+			xml.writeAttribute( "font-family", "sans-serif" );
+		}
+		element++;
+
+		QColor backColor( Qt::white );
+		QColor borderColor( Qt::black );
+		qan::Style* style = styleManager.getStyle( *node );
+		if ( style == 0 )
+			style = styleManager.getTargetStyle( "qan::Node" );
+		if ( style != 0 && style->has( "Back Color" ) )
+			backColor = style->getColor( "Back Color" );
+		if ( style != 0 && style->has( "Border Color" ) )
+			borderColor = style->getColor( "Border Color" );
+
+		QRectF nodeBr = getNodeRect( *node );
+		xml.writeEmptyElement( "rect" );
+		xml.writeAttribute( "x", QString::number( nodeBr.x( ) ) );
+		xml.writeAttribute( "y", QString::number( nodeBr.y( ) ) );
+		xml.writeAttribute( "width", QString::number( nodeBr.width( ) ) );
+		xml.writeAttribute( "height", QString::number( nodeBr.height( ) ) );
+		xml.writeAttribute( "rx", "4" );
+		xml.writeAttribute( "fill", backColor.name( ) );
+		xml.writeAttribute( "stroke", borderColor.name( ) );
+
+		xml.writeStartElement( "text" );
+		xml.writeAttribute( "x", QString::number( nodeBr.center( ).x( ) ) );
+		xml.writeAttribute( "y", QString::number( nodeBr.center( ).y( ) ) );
+		xml.writeAttribute( "text-anchor", "middle" );
+		xml.writeAttribute( "dominant-baseline", "central" );
+		xml.writeCharacters( node->getLabel( ) );
+		xml.writeEndElement( );
+	}
+	xml.writeEndElement( );
+
+	xml.writeEndElement( );		// svg
+	xml.writeEndDocument( );
+	return !xml.hasError( );
+}
+//-----------------------------------------------------------------------------
+
+
+} // ::qan
+
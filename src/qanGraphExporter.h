@@ -0,0 +1,138 @@
+/*
+	Copyright (C) 2008-2015 Benoit AUTHEMAN
+
+    This file is part of Qanava.
+
+    Qanava is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Qanava is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with Qanava.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//-----------------------------------------------------------------------------
+// This file is a part of the Qanava software.
+//
+// \file	qanGraphExporter.h
+// \author	benoit@qanava.org
+// \date	2015 October 23
+//-----------------------------------------------------------------------------
+
+
+#ifndef qanGraphExporter_h
+#define qanGraphExporter_h
+
+
+// Qanava headers
+#include "./qanGraph.h"
+
+
+// QT headers
+#include <QString>
+#include <QColor>
+#include <QRectF>
+#include <QIODevice>
+
+
+//-----------------------------------------------------------------------------
+namespace qan { // ::qan
+
+	//! Export a graph scene without a graphics view, to a PNG tile pyramid or to a SVG file.
+	/*!
+		Exporter does not need a display, it can be used from a command line tool running with the offscreen
+		QPA platform (-platform offscreen).
+
+		Pyramid tiles are recorded in a QPicture on the calling thread (QGraphicsScene is not thread safe), then
+		rasterized and encoded in PNG on worker threads, each worker thread reusing a single QImage. At most
+		getMaxPendingTiles() tiles are in flight, so memory does not depend on the scene size.
+
+		SVG is written with a QXmlStreamWriter directly to the output device, nodes and edges are emitted by groups
+		of a given chunk size and the document is never built in memory. SVG content is generated from nodes and
+		edges geometry and style (node rectangles and labels, straight edges), not from graph items drawing.
+
+		\nosubgrouping
+	*/
+	class GraphExporter
+	{
+		/*! \name GraphExporter Constructor/Destructor *///---------------------
+		//@{
+	public:
+
+		//! GraphExporter constructor, graph scene is graph.getM().
+		GraphExporter( Graph& graph );
+
+		virtual ~GraphExporter( ) { }
+
+	private:
+
+		Q_DISABLE_COPY( GraphExporter );
+
+	protected:
+
+		Graph&			_graph;
+		//@}
+		//---------------------------------------------------------------------
+
+
+
+		/*! \name Tile Pyramid Export Management *///--------------------------
+		//@{
+	public:
+
+		//! Export scene content to a pyramid of PNG tiles in a directory, return false if a tile can't be written.
+		/*!	Tiles are written in directory/level/x_y.png. Level 0 contains the whole scene in one tile, scale is doubled
+			from one level to the next, the last level is rendered at scale 1. Tiles without items are not written.
+			\param	sceneRect	Exported area, default to scene items bounding rect. */
+		bool			exportPyramid( QString directory, int tileSize = 256, QRectF sceneRect = QRectF( ) );
+
+		//! Return the number of levels of a pyramid for a scene area.
+		static int		getPyramidLevelCount( QRectF sceneRect, int tileSize );
+
+		//! Set the maximum number of tiles being rasterized or written at the same time (default to twice the ideal thread count).
+		void			setMaxPendingTiles( int maxPendingTiles ) { _maxPendingTiles = qMax( 1, maxPendingTiles ); }
+
+		int				getMaxPendingTiles( ) const { return _maxPendingTiles; }
+
+		//! Set the color used to fill tiles before their content is drawn (default to white).
+		void			setBackground( QColor background ) { _background = background; }
+
+	protected:
+
+		int				_maxPendingTiles;
+
+		QColor			_background;
+		//@}
+		//---------------------------------------------------------------------
+
+
+
+		/*! \name SVG Export Management *///-----------------------------------
+		//@{
+	public:
+
+		//! Write graph nodes and edges to a SVG file, return false if the file can't be written.
+		bool			exportSvg( QString fileName, int chunkSize = 4096 );
+
+		//! Stream graph nodes and edges as SVG to an open device, nodes and edges are written in groups of chunkSize elements.
+		bool			exportSvg( QIODevice& device, int chunkSize = 4096 );
+
+	protected:
+
+		//! Return a node rect in scene CS, from its graph item or from its position and dimension when it has no item.
+		static QRectF	getNodeRect( Node& node );
+		//@}
+		//---------------------------------------------------------------------
+	};
+} // ::qan
+//-----------------------------------------------------------------------------
+
+
+#endif // qanGraphExporter_h
+
@@ -0,0 +1,156 @@
+/*
+	Copyright (C) 2008-2015 Benoit AUTHEMAN
+
+    This file is part of Qanava.
+
+    Qanava is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Qanava is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with Qanava.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//-----------------------------------------------------------------------------
+// This file is a part of the Qanava software.
+//
+// \file	qanGraphIndex.cpp
+// \author	benoit@qanava.org
+// \date	2015 October 10
+//-----------------------------------------------------------------------------
+
+// Qt headers
+#include <QMap>
+#include <QtAlgorithms>
+
+// Qanava headers
+#include "./qanGraphIndex.h"
+
+
+namespace qan { // ::qan
+
+
+/* GraphIndex Constructor/Destructor *///--------------------------------------
+static bool	nodeIndexLessThan( const Node* a, const Node* b )
+{
+	int labelOrder = QString::compare( a->getLabel( ), b->getLabel( ) );
+	if ( labelOrder != 0 )
+		return labelOrder < 0;
+	if ( a->getInDegree( ) != b->getInDegree( ) )
+		return a->getInDegree( ) < b->getInDegree( );
+	if ( a->getOutDegree( ) != b->getOutDegree( ) )
+		return a->getOutDegree( ) < b->getOutDegree( );
+	return a->getSerial( ) < b->getSerial( );
+}
+
+GraphIndex::GraphIndex( const Node::Set& nodes )
+{
+	_nodes.reserve( nodes.size( ) );
+	foreach ( Node* node, nodes )
+		_nodes << node;
+	qSort( _nodes.begin( ), _nodes.end( ), nodeIndexLessThan );
+
+	_indexes.reserve( _nodes.size( ) );
+	for ( int n = 0; n < _nodes.size( ); n++ )
+		_indexes.insert( _nodes[ n ], n );
+
+	// Merge in and out edges to indexed nodes, QMap keeps adjacent nodes sorted by index
+	_offsets.resize( _nodes.size( ) + 1 );
+	_offsets[ 0 ] = 0;
+	for ( int n = 0; n < _nodes.size( ); n++ )
+	{
+		Node* node = _nodes[ n ];
+		QMap< int, float > adjacents;
+		foreach ( Edge* outEdge, node->getOutEdges( ) )
+		{
+			int dst = getIndex( &outEdge->getDst( ) );
+			if ( dst >= 0 && dst != n )
+				adjacents[ dst ] += outEdge->getWeight( );
+		}
+		foreach ( Edge* inEdge, node->getInEdges( ) )
+		{
+			int src = getIndex( &inEdge->getSrc( ) );
+			if ( src >= 0 && src != n )
+				adjacents[ src ] += inEdge->getWeight( );
+		}
+		QMap< int, float >::const_iterator adjacent = adjacents.constBegin( );
+		for ( ; adjacent != adjacents.constEnd( ); ++adjacent )
+		{
+			_adjacents << adjacent.key( );
+			_weights << adjacent.value( );
+		}
+		_offsets[ n + 1 ] = _adjacents.size( );
+	}
+}
+//-----------------------------------------------------------------------------
+
+
+
+/* Index Access Management *///------------------------------------------------
+void	GraphIndex::bfs( int source, QVector< int >& distances ) const
+{
+	distances.fill( -1, _nodes.size( ) );
+	if ( source < 0 || source >= _nodes.size( ) )
+		return;
+
+	QVector< int > queue;
+	queue.reserve( _nodes.size( ) );
+	queue << source;
+	distances[ source ] = 0;
+	for ( int head = 0; head < queue.size( ); head++ )
+	{
+		int u = queue.at( head );
+		int du = distances.at( u ) + 1;
+		for ( int a = _offsets.at( u ); a < _offsets.at( u + 1 ); a++ )
+		{
+			int v = _adjacents.at( a );
+			if ( distances.at( v ) < 0 )
+			{
+				distances[ v ] = du;
+				queue << v;
+			}
+		}
+	}
+}
+
+/*!	\return	the number of connected components.	*/
+int	GraphIndex::collectComponents( QVector< int >& components ) const
+{
+	components.fill( -1, _nodes.size( ) );
+	int componentCount = 0;
+	QVector< int > stack;
+	for ( int n = 0; n < _nodes.size( ); n++ )
+	{
+		if ( components.at( n ) >= 0 )
+			continue;
+		stack << n;
+		components[ n ] = componentCount;
+		while ( !stack.isEmpty( ) )
+		{
+			int u = stack.last( );
+			stack.pop_back( );
+			for ( int a = _offsets.at( u ); a < _offsets.at( u + 1 ); a++ )
+			{
+				int v = _adjacents.at( a );
+				if ( components.at( v ) < 0 )
+				{
+					components[ v ] = componentCount;
+					stack << v;
+				}
+			}
+		}
+		componentCount++;
+	}
+	return componentCount;
+}
+//-----------------------------------------------------------------------------
+
+
+} // ::qan
+
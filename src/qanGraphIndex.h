@@ -0,0 +1,126 @@
+/*
+	Copyright (C) 2008-2015 Benoit AUTHEMAN
+
+    This file is part of Qanava.
+
+    Qanava is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Qanava is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with Qanava.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//-----------------------------------------------------------------------------
+// This file is a part of the Qanava software.
+//
+// \file	qanGraphIndex.h
+// \author	benoit@qanava.org
+// \date	2015 October 10
+//-----------------------------------------------------------------------------
+
+
+#ifndef qanGraphIndex_h
+#define qanGraphIndex_h
+
+
+// Qanava headers
+#include "./qanNode.h"
+
+
+// QT headers
+#include <QVector>
+#include <QHash>
+
+
+//-----------------------------------------------------------------------------
+namespace qan { // ::qan
+
+	//! Compact (CSR) undirected adjacency index for a set of nodes, used by layout algorithms working on integer node indexes.
+	/*!
+		Nodes are sorted by label, then degree, then creation order, so that indexes (and layouts using them)
+		do not depend on the set iteration order or on node addresses. Only edges between indexed nodes are kept, parallel edges are merged
+		and their weights summed, edge orientation is ignored.
+
+		\nosubgrouping
+	*/
+	class GraphIndex
+	{
+		/*! \name GraphIndex Constructor/Destructor *///------------------------
+		//@{
+	public:
+
+		//! GraphIndex constructor, build an index for a given set of nodes.
+		GraphIndex( const Node::Set& nodes );
+
+		//! GraphIndex destructor.
+		virtual ~GraphIndex( ) { }
+
+	private:
+
+		Q_DISABLE_COPY( GraphIndex );
+		//@}
+		//---------------------------------------------------------------------
+
+
+
+		/*! \name Index Access Management *///---------------------------------
+		//@{
+	public:
+
+		//! Get the number of indexed nodes.
+		int				getNodeCount( ) const { return _nodes.size( ); }
+
+		//! Get the number of indexed undirected edges.
+		int				getEdgeCount( ) const { return _adjacents.size( ) / 2; }
+
+		//! Get the node registered at a given index.
+		Node*			getNode( int index ) const { return _nodes.at( index ); }
+
+		//! Get a given node index, or -1 if the node is not indexed.
+		int				getIndex( Node* node ) const { return _indexes.value( node, -1 ); }
+
+		//! Get the degree of a given node (counting only indexed adjacent nodes).
+		int				getDegree( int index ) const { return _offsets.at( index + 1 ) - _offsets.at( index ); }
+
+		//! Get the position of a node first adjacent node in getAdjacents() and getWeights().
+		int				getOffset( int index ) const { return _offsets.at( index ); }
+
+		//! Get a flat array of adjacent node indexes, adjacent nodes of node i are in [getOffset(i), getOffset(i+1)[.
+		const QVector< int >&	getAdjacents( ) const { return _adjacents; }
+
+		//! Get a flat array of adjacency weights (sum of parallel edges weights), aligned with getAdjacents().
+		const QVector< float >&	getWeights( ) const { return _weights; }
+
+		//! Compute unweighted shortest path distances from a source node (-1 for unreachable nodes), O(n+m).
+		void			bfs( int source, QVector< int >& distances ) const;
+
+		//! Collect connected components, components[i] is node i component id, components are numbered in order of their first node, O(n+m).
+		int				collectComponents( QVector< int >& components ) const;
+
+	protected:
+
+		QVector< Node* >		_nodes;
+
+		QHash< Node*, int >		_indexes;
+
+		QVector< int >			_offsets;
+
+		QVector< int >			_adjacents;
+
+		QVector< float >		_weights;
+		//@}
+		//---------------------------------------------------------------------
+	};
+} // ::qan
+//-----------------------------------------------------------------------------
+
+
+#endif // qanGraphIndex_h
+
@@ -28,6 +28,8 @@
 
 // QT headers
 #include <QGraphicsLinearLayout>
+#include <QStyleOptionGraphicsItem>
+#include <QPainter>
 #include <QTimer>
 
 // Qanava headers
@@ -38,10 +40,11 @@
 namespace qan { // ::qan
 
 /* GraphItem Properties Management *///----------------------------------------
-PropertiesWidget::PropertiesWidget( GraphScene& scene, qan::Properties& properties, QGraphicsItem * parent ) :
+PropertiesWidget::PropertiesWidget( GraphScene& scene, QGraphicsItem * parent ) :
     QGraphicsWidget( parent ),
     _propertiesEditorWidget( 0 ),
-	_properties( properties ),
+	_properties( 0 ),
+	_owner( 0 ),
 	_hasHover( false )
 {
     // Initialize edge properties editor
@@ -60,16 +63,25 @@ PropertiesWidget::PropertiesWidget( GraphScene& scene, qan::Properties& properti
 	setFlag( QGraphicsItem::ItemIgnoresTransformations, true );
 }
 		
+void	PropertiesWidget::bind( QGraphicsObject* owner, qan::Properties& properties )
+{
+	_owner = owner;
+	_properties = &properties;
+	updateProperties( );
+}
+
 void	PropertiesWidget::updateProperties( )
 {
+	if ( _properties == 0 )
+		return;
     QSizeF propertiesEditorSize( _propertiesEditorWidget->preferredSize( ) );
-    propertiesEditorSize.setHeight( qMax( 50., 30. + _properties.getProperties( ).size( ) * 25. ) );
+    propertiesEditorSize.setHeight( qMax( 50., 30. + _properties->getProperties( ).size( ) * 25. ) );
 	_propertiesEditorWidget->setGeometry( QRectF( _propertiesEditorWidget->pos( ), propertiesEditorSize ) ); 
 	if ( _propertiesEditorWidget != 0 )
 	{
 		_propertyEditor->clear( );
-		_propertyEditor->setFactoryForManager( ( QtVariantPropertyManager* )&_properties, _variantFactory );
-		QList< QtVariantProperty* >& props = _properties.getProperties( );
+		_propertyEditor->setFactoryForManager( ( QtVariantPropertyManager* )_properties, _variantFactory );
+		QList< QtVariantProperty* >& props = _properties->getProperties( );
 		foreach( QtVariantProperty* p, props )
             _propertyEditor->addProperty( p );
     }
@@ -104,7 +116,10 @@ GraphItem::GraphItem( GraphScene& scene ) :
     QGraphicsObject( 0 ),
 	_scene( scene ), 
 	_styleManager( scene.getStyleManager( ) ),
-	_propertiesWidget( 0 ),
+	_lodFullDetail( 0.6 ),
+	_lodReducedDetail( 0.3 ),
+	_lodMinimalDetail( 0.1 ),
+	_properties( 0 ),
 	_hovering( false ),
 	_hoveringPos( 0., 0. ),
 	_showBottom( false )
@@ -128,32 +143,74 @@ QPointF	GraphItem::getAnchor( qan::Edge& edge )
     Q_UNUSED( edge );
 	return ( getGraphicsItem( ) != 0 ? getGraphicsItem( )->boundingRect( ).center( ) : QPointF( 0., 0. ) );
 }
+
+QPolygonF	GraphItem::getSceneShapePolygon( )
+{
+	QGraphicsItem* item = getGraphicsItem( );
+	if ( item == 0 )
+		return QPolygonF( );
+	return item->shape( ).toFillPolygon( QTransform( ).translate( item->scenePos( ).x( ), item->scenePos( ).y( ) ) );
+}
+//-----------------------------------------------------------------------------
+
+
+/* GraphItem Level of Detail Management *///----------------------------------
+GraphItem::LodTier	GraphItem::getLodTier( qreal lod ) const
+{
+	if ( lod >= _lodFullDetail )
+		return LodFull;
+	if ( lod >= _lodReducedDetail )
+		return LodReduced;
+	if ( lod >= _lodMinimalDetail )
+		return LodMinimal;
+	return LodDot;
+}
+
+qreal	GraphItem::getLod( const QPainter* painter )
+{
+	return QStyleOptionGraphicsItem::levelOfDetailFromTransform( painter->worldTransform( ) );
+}
+
+/*! Missing thresholds keep their current value. */
+void	GraphItem::updateLodThresholds( qan::Style* style )
+{
+	if ( style == 0 )
+		return;
+	if ( style->has( "Lod Full Detail" ) )
+		_lodFullDetail = style->get( "Lod Full Detail" ).toDouble( );
+	if ( style->has( "Lod Reduced Detail" ) )
+		_lodReducedDetail = style->get( "Lod Reduced Detail" ).toDouble( );
+	if ( style->has( "Lod Minimal Detail" ) )
+		_lodMinimalDetail = style->get( "Lod Minimal Detail" ).toDouble( );
+}
 //-----------------------------------------------------------------------------
 
 
 /* EdgeItem Properties Widget Management *///----------------------------------
 void	GraphItem::activatePropertiesPopup( qan::Properties& properties, int popupDelay, bool showBottom )
 {
-	if ( _propertiesWidget == 0 )
-	{
-		setAcceptHoverEvents( true );
-
-		// Initialize edge properties editor
-		_propertiesWidget = new PropertiesWidget( _scene, properties );
-		_scene.addItem( _propertiesWidget );
-		_propertiesWidget->setVisible( false );
+	setAcceptHoverEvents( true );
+	_properties = &properties;
+	_showBottom = showBottom;
+	_popupDelay = popupDelay;
+}
 
-		_showBottom = showBottom;
-		_popupDelay = popupDelay;
-	}
+PropertiesWidget*	GraphItem::getBoundPropertiesWidget( )
+{
+	if ( _properties == 0 || !_scene.hasPropertiesWidget( ) )
+		return 0;
+	PropertiesWidget& propertiesWidget = _scene.getPropertiesWidget( );
+	return ( propertiesWidget.getOwner( ) == this ? &propertiesWidget : 0 );
 }
 
 void	GraphItem::hidePropertiesPopup( )
 {
-	if ( _propertiesWidget != 0 )
+	if ( propertyPopupActivated( ) )
 	{
 		_hovering = false;
-		_propertiesWidget->setVisible( false );
+		PropertiesWidget* propertiesWidget = getBoundPropertiesWidget( );
+		if ( propertiesWidget != 0 )
+			propertiesWidget->setVisible( false );
 	}
 }
 
@@ -175,17 +232,18 @@ void	GraphItem::hoverMoveEvent( QGraphicsSceneHoverEvent* e )
 
 	// Showing the properties widget after a few milliseconds if the user is still 'hovering'
 	_hoveringPos = e->scenePos( );
-    if ( showPopup && _propertiesWidget != 0 )
+	PropertiesWidget* propertiesWidget = getBoundPropertiesWidget( );
+    if ( showPopup )
 	{
 		_hovering = true;
-		if ( _propertiesWidget->isVisible( ) && _propertiesWidget->hasHover( ) )
+		if ( propertiesWidget != 0 && propertiesWidget->isVisible( ) && propertiesWidget->hasHover( ) )
 			showPropertiesWidget( ); //_propertiesWidget->setPos( _hoveringPos );
 		else
 			QTimer::singleShot( _popupDelay, this, SLOT( showPropertiesWidget( ) ) ); 
 	}
 	else
 	{		
-        if ( _propertiesWidget != 0 && _propertiesWidget->isVisible( ) && !_propertiesWidget->hasHover( ) )
+        if ( propertiesWidget != 0 && propertiesWidget->isVisible( ) && !propertiesWidget->hasHover( ) )
 			hidePropertiesPopup( );
 		_hovering = false;
 	}
@@ -219,41 +277,48 @@ void	GraphItem::hoverLeaveEvent( QGraphicsSceneHoverEvent* e )
         // Hide the property editor widget (it will stay visible if mouse is currently hovering over it, see sceneEventFilter)
         _hovering = false;
         _hoveringPos = QPointF( 0., 0. );
-        if ( _propertiesWidget->isVisible( ) )
+        PropertiesWidget* propertiesWidget = getBoundPropertiesWidget( );
+        if ( propertiesWidget != 0 && propertiesWidget->isVisible( ) )
             QTimer::singleShot( 100, this, SLOT( delayedHoverLeaveEvent( ) ) );	// hoverLeave is called before properties widget hoverEnter automatically, delay it...
     }
 
 	QGraphicsItem::hoverLeaveEvent( e );
 }
 
+/*! The scene properties widget is created on first call, and rebound to this item properties if it was
+	showing another item properties.
+ */
 void	GraphItem::showPropertiesWidget( )
 {
-    if ( !propertyPopupActivated( ) )
+    if ( !propertyPopupActivated( ) || !_hovering )	// Do not show the widget if hovering is over
         return;
 
-	if ( _hovering && !_propertiesWidget->isVisible( ) )	// Do not show the widget if hovering is over
+	PropertiesWidget& propertiesWidget = _scene.getPropertiesWidget( );
+	if ( propertiesWidget.getOwner( ) != this || !propertiesWidget.isVisible( ) )
 	{
-		// Show the property editor with actual edge properties
-		_propertiesWidget->setVisible( true );
+		// Show the property editor with actual item properties
+		propertiesWidget.bind( this, *_properties );
+		propertiesWidget.setVisible( true );
 		if ( _showBottom )
-			_propertiesWidget->setPos( mapToScene( boundingRect( ).bottomLeft( ) ) );
+			propertiesWidget.setPos( mapToScene( boundingRect( ).bottomLeft( ) ) );
 		else
-			_propertiesWidget->setPos( _hoveringPos );
-		_propertiesWidget->updateProperties( );
-		_propertiesWidget->setFocus( Qt::MouseFocusReason );
-	} else if ( _hovering && _propertiesWidget->isVisible( ) )
+			propertiesWidget.setPos( _hoveringPos );
+		propertiesWidget.setFocus( Qt::MouseFocusReason );
+	}
+	else
 	{
 		if ( _showBottom )
-			_propertiesWidget->setPos( mapToScene( boundingRect( ).bottomLeft( ) ) );
+			propertiesWidget.setPos( mapToScene( boundingRect( ).bottomLeft( ) ) );
 		else
-			_propertiesWidget->setPos( _hoveringPos );
+			propertiesWidget.setPos( _hoveringPos );
 	}
 }
 
 void	GraphItem::delayedHoverLeaveEvent( )
 {
-    if ( propertyPopupActivated( ) && !_propertiesWidget->hasHover( ) )
-		_propertiesWidget->setVisible( false );
+	PropertiesWidget* propertiesWidget = getBoundPropertiesWidget( );
+    if ( propertiesWidget != 0 && !propertiesWidget->hasHover( ) )
+		propertiesWidget->setVisible( false );
 }
 //-----------------------------------------------------------------------------
 
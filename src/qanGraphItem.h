@@ -33,6 +33,7 @@
 #include <QGraphicsItem>
 #include <QGraphicsWidget>
 #include <QGraphicsObject>
+#include <QPointer>
 
 // QT Solutions (qtpropertybrowser) headers
 #include "QtVariantProperty"
@@ -48,6 +49,8 @@ namespace qan { // ::qan
 	class GraphScene;
 
 	//! Display a qt property browser in a graphics widget.
+	/*! A single widget is shared by all items of a scene (see GraphScene::getPropertiesWidget()), it is bound to the
+		properties of the item currently hovered. */
 	class PropertiesWidget : public QGraphicsWidget
 	{
 		Q_OBJECT
@@ -56,7 +59,13 @@ namespace qan { // ::qan
 		//@{
 	public:
 
-		PropertiesWidget( GraphScene& scene, qan::Properties& properties, QGraphicsItem * parent = 0 );
+		PropertiesWidget( GraphScene& scene, QGraphicsItem * parent = 0 );
+
+		//! Bind this widget to the properties of a given item, and update the property browser content.
+		void				bind( QGraphicsObject* owner, qan::Properties& properties );
+
+		//! Get the item this widget is currently bound to (0 if there is none, or if it has been destroyed).
+		QGraphicsObject*	getOwner( ) const { return _owner.data( ); }
 
         QtVariantEditorFactory*		_variantFactory;
 
@@ -76,7 +85,9 @@ namespace qan { // ::qan
 
 		virtual void		hoverLeaveEvent( QGraphicsSceneHoverEvent* e );
 
-		qan::Properties&	_properties;
+		qan::Properties*	_properties;
+
+		QPointer< QGraphicsObject >	_owner;
 
 		bool				_hasHover;
 		//@}
@@ -122,6 +133,12 @@ namespace qan { // ::qan
 		//! return an anchor point for a specific edge on this item.
 		virtual QPointF			getAnchor( qan::Edge& edge );
 
+		//! Get this item content rect in scene CS, without decorations painted around it (default to graphics item scene bounding rect).
+		virtual QRectF			getSceneContentRect( ) { return ( getGraphicsItem( ) != 0 ? getGraphicsItem( )->sceneBoundingRect( ) : QRectF( ) ); }
+
+		//! Get this item graphics item shape as a polygon in scene CS (used to clip edges on item border).
+		virtual QPolygonF		getSceneShapePolygon( );
+
 	public slots:
 
 		//! Force updating this graph item with its actual geometry.
@@ -157,14 +174,55 @@ namespace qan { // ::qan
 		//---------------------------------------------------------------------
 
 
+		/*! \name GraphItem Level of Detail Management *///------------------
+		//@{
+	public:
+
+		//! Level of detail tiers, from full detail to a simple dot (or nothing).
+		enum LodTier
+		{
+			//! Full detail, with shadows, labels and antialiased arrows.
+			LodFull			= 0,
+			//! No shadows and no labels.
+			LodReduced		= 1,
+			//! Plain rectangles and thin lines.
+			LodMinimal		= 2,
+			//! A dot, or nothing.
+			LodDot			= 3
+		};
+
+		//! Get the level of detail tier of this item for a given level of detail (as returned by getLod()).
+		LodTier			getLodTier( qreal lod ) const;
+
+		//! Get the level of detail of a painter (ie the scale of its world transform).
+		static qreal	getLod( const QPainter* painter );
+
+	protected:
+
+		//! Read level of detail thresholds from a style ("Lod Full Detail", "Lod Reduced Detail" and "Lod Minimal Detail" properties).
+		void			updateLodThresholds( qan::Style* style );
+
+		qreal			_lodFullDetail;
+
+		qreal			_lodReducedDetail;
+
+		qreal			_lodMinimalDetail;
+		//@}
+		//---------------------------------------------------------------------
+
+
 		/*! \name EdgeItem Properties Widget Management *///-------------------
 		//@{
 	protected:
 
 		//! Call from a sub classe with properties object to activate automatic properties edition, widget could be shown always at item bottom.
+		/*! The scene properties widget is created and bound to this item properties only when the item is hovered. */
 		void			activatePropertiesPopup( qan::Properties& properties, int popupDelay = 150, bool showBottom = false );
 
-        bool            propertyPopupActivated( ) const { return _propertiesWidget != 0; }
+        bool            propertyPopupActivated( ) const { return _properties != 0; }
+
+		//! Get the scene properties widget if it is currently bound to this item (0 otherwise).
+		PropertiesWidget*	getBoundPropertiesWidget( );
 
         void			hidePropertiesPopup( );
 
@@ -182,7 +240,7 @@ namespace qan { // ::qan
 
 	public:
 		
-		PropertiesWidget*			_propertiesWidget;
+		qan::Properties*			_properties;
 
 		bool						_hovering;
 
@@ -203,6 +203,15 @@ void	GraphModel::setGraph( qan::Graph& graph )
 		visit( *rootNode, invisibleRootItem( ) );
 }
 
+/*!	Item tree is destroyed by QStandardItemModel::clear() in one pass, without removing rows one by one.
+ */
+void	GraphModel::clear( )
+{
+	_nodeItemMap.clear( );
+	_itemNodeMap.clear( );
+	QStandardItemModel::clear( );
+}
+
 void	GraphModel::visit( qan::Node& node, QStandardItem* parent )
 {
 	QStandardItem* nodeItem = addItem( node, parent );
@@ -112,6 +112,9 @@ namespace qan { // ::qan
 
 		void			setGraph( qan::Graph& graph );
 
+		//! Clear the model items and node mappings with a single model reset.
+		void			clear( );
+
 	protected:
 
 		void			visit( qan::Node& node, QStandardItem* parent );
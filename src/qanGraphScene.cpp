@@ -33,6 +33,9 @@
 #include "./qanGrid.h"
 #include "./qanLayout.h"
 #include "./qanNodeRectItem.h"
+#include "./qanEdgeRouter.h"
+#include "./qanEdgeLayer.h"
+#include "./qanEdgeBundle.h"
 
 
 // QT headers
@@ -50,12 +53,32 @@ namespace qan { // ::qan
  */
 GraphScene::GraphScene( StyleManager& styleManager, QWidget* parent, QColor backgroundColor, QSize size ) :
 	QGraphicsScene( parent ),
-	_styleManager( styleManager )
+	_styleManager( styleManager ),
+	_edgeRouter( 0 ),
+	_propertiesWidget( 0 ),
+	_fastLabels( false ),
+	_paintStatistics( 0 ),
+	_edgeLayer( 0 ),
+	_batchDepth( 0 ),
+	_edgeFlushPending( false ),
+	_dirtyFlushPending( false ),
+	_virtualized( false ),
+	_virtualMargin( 200. ),
+	_parkCapacity( 500 ),
+	_virtualArea( ),
+	_virtualIndex( ),
+	_virtualNextId( 0 ),
+	_indexPolicy( IndexAutomatic ),
+	_indexSuspendCount( 0 ),
+	_edgeBundlesEnabled( false ),
+	_edgeBundleThreshold( 0.35 )
 { 
     Q_UNUSED( backgroundColor ); Q_UNUSED( size );
 	addGraphItemFactory( new NodeRectItem::Factory( ) );
 	addGraphItemFactory( new EdgeItem::Factory( ) );
 	addGraphItemFactory( new HEdgeItem::Factory( ) );
+
+	connect( this, SIGNAL( selectionChanged( ) ), this, SLOT( demoteDeselectedEdges( ) ) );
 }
 
 GraphScene::~GraphScene( )
@@ -64,6 +87,7 @@ GraphScene::~GraphScene( )
 
 	foreach ( qan::NodeGroup* nodeGroup, _nodeGroups )
 		delete nodeGroup;
+	delete _edgeRouter;
 }
 //-----------------------------------------------------------------------------
 
@@ -72,38 +96,735 @@ GraphScene::~GraphScene( )
 /* Scene Management *///-------------------------------------------------------
 /*! Styles registered in the style manager are not cleared, and can be reused when this
     model will receive new edges and noeds.
+
+	Graph items are destroyed in bulk: views are detached and the scene index is disabled during the teardown,
+	then top level graph items are deleted by QGraphicsScene::clear(), which removes items in their insertion order
+	in linear time (removing items one by one in an arbitrary order is quadratic in the number of items). Node
+	groups, the edge layer and other items that are not graph items are kept in the scene.
  */
 void	GraphScene::clear( )
 {
-    // Clear all graphics items in the graphic view
-	foreach ( GraphItem* item, _edgeGraphItemMap.values( ) )
+	// Views are attached again once items are destroyed, so that they do not track each item removal
+	QList< QGraphicsView* > graphViews = views( );
+	foreach ( QGraphicsView* view, graphViews )
+		view->setScene( 0 );
+	suspendIndex( );
+	bool blocked = blockSignals( true );
+	QRectF clearedRect = itemsBoundingRect( );	// Cached views content must be discarded
+
+	// Nodes and edges are detached from their items, items with a parent (node group content) are destroyed with their parent or here
+	clearEdgeBundles( );
+	NodeGraphItemMap::const_iterator nodeGraphItem = _nodeGraphItemMap.constBegin( );
+	for ( ; nodeGraphItem != _nodeGraphItemMap.constEnd( ); ++nodeGraphItem )
 	{
-		removeItem( item->getGraphicsItem( ) );
-		delete item;
+		nodeGraphItem.key( )->setGraphicsItem( 0 );
+		nodeGraphItem.key( )->setGraphItem( 0 );
+		if ( nodeGraphItem.value( )->parentItem( ) != 0 )
+			delete nodeGraphItem.value( );
 	}
-	foreach ( GraphItem* item, _nodeGraphItemMap.values( ) )
+	EdgeGraphItemMap::const_iterator edgeGraphItem = _edgeGraphItemMap.constBegin( );
+	for ( ; edgeGraphItem != _edgeGraphItemMap.constEnd( ); ++edgeGraphItem )
 	{
-		removeItem( item->getGraphicsItem( ) );
-		delete item;
+		edgeGraphItem.key( )->setGraphicsItem( 0 );
+		edgeGraphItem.key( )->setGraphItem( 0 );
+		if ( edgeGraphItem.value( )->parentItem( ) != 0 )
+			delete edgeGraphItem.value( );
 	}
+	foreach ( NodeGroup* nodeGroup, _nodeGroups )
+		if ( nodeGroup->isCollapsed( ) )
+			nodeGroup->getProxyItem( )->clearEdges( );
+
+	// Top level items that are not graph items are removed while the scene is cleared, then inserted back: items
+	// are not sorted, kept items z value is preserved
+	QList< QGraphicsItem* > keptItems;
+	foreach ( QGraphicsItem* item, items( ) )
+		if ( item->parentItem( ) == 0 && qobject_cast< GraphItem* >( item->toGraphicsObject( ) ) == 0 )
+			keptItems.append( item );
+	foreach ( QGraphicsItem* item, keptItems )
+		removeItem( item );
+	QGraphicsScene::clear( );
+	foreach ( QGraphicsItem* item, keptItems )
+		addItem( item );
 
 	// Clear all mappings
 	_nodeGraphItemMap.clear( );
 	_edgeGraphItemMap.clear( );
+	_hyperEdgeItems.clear( );
+	_batchNodes.clear( );
+	_dirtyEdges.clear( );
+	_dirtyRects.clear( );
+	_virtualIndex.clear( );
+	_virtualIds.clear( );
+	_virtualNodes.clear( );
+	_visibleNodes.clear( );
+	_parkedNodes.clear( );
+	_farNodes.clear( );
+	_promotedEdges.clear( );
+	_collapsedNodes.clear( );
+	if ( _edgeLayer != 0 )
+		_edgeLayer->clear( );
+	if ( _edgeRouter != 0 )
+		_edgeRouter->clear( );
+
+	blockSignals( blocked );
+	resumeIndex( );
+	foreach ( QGraphicsView* view, graphViews )
+		view->setScene( this );
+	addDirtyRect( clearedRect );
 }
 
-// FIXME v0.4.0 hack from previous versions of Qanava, the layout and position system should be redesigned in v0.5.0
+/*!	Positions are applied in O(n) in a single batch: each edge of a moved node is updated once, whatever
+	the number of its moved nodes.
+ */
 void	GraphScene::updatePositions( Node* except )
 {
-    Q_UNUSED( except );
-	// Update all nodes positions	// FIXME v0.4.0: Would be more efficient to iterate over graph.getNodes( )
-	foreach ( GraphItem* nodeGraphItem, _nodeGraphItemMap.values( ) )
+	beginBatch( );
+	NodeGraphItemMap::const_iterator nodeGraphItem = _nodeGraphItemMap.constBegin( );
+	for ( ; nodeGraphItem != _nodeGraphItemMap.constEnd( ); ++nodeGraphItem )
+		if ( nodeGraphItem.key( ) != except )
+			moveNodeItem( *nodeGraphItem.key( ), nodeGraphItem.value( ), nodeGraphItem.key( )->getPosition( ) );
+	endBatch( );
+
+	// Nodes without items have been moved too, visible nodes may have changed
+	if ( _virtualized )
+	{
+		foreach ( Node* node, _virtualIds.keys( ) )
+			updateVirtualNodeRect( *node );
+		updateVirtualization( _virtualArea );
+	}
+}
+
+void	GraphScene::updatePositions( const Node::List& nodes, const QVector< QPointF >& positions )
+{
+	beginBatch( );
+	int count = qMin( nodes.size( ), positions.size( ) );
+	for ( int n = 0; n < count; n++ )
+		moveNodeItem( *nodes[ n ], getGraphItem( *nodes[ n ] ), positions[ n ] );
+	endBatch( );
+	if ( _virtualized )
+		updateVirtualization( _virtualArea );
+}
+
+void	GraphScene::updatePositions( const QHash< Node*, QPointF >& positions )
+{
+	beginBatch( );
+	QHash< Node*, QPointF >::const_iterator position = positions.constBegin( );
+	for ( ; position != positions.constEnd( ); ++position )
+		moveNodeItem( *position.key( ), getGraphItem( *position.key( ) ), position.value( ) );
+	endBatch( );
+	if ( _virtualized )
+		updateVirtualization( _virtualArea );
+}
+
+void	GraphScene::moveNodeItem( Node& node, GraphItem* nodeGraphItem, QPointF position )
+{
+	node.setPosition( position );
+	if ( _virtualized )
+		updateVirtualNodeRect( node );
+	if ( nodeGraphItem == 0 || nodeGraphItem->getGraphicsItem( ) == 0 )
+		return;
+	QGraphicsItem* item = nodeGraphItem->getGraphicsItem( );
+	if ( item->pos( ) != position )	// Items that do not move do not dirty their edges
+		item->setPos( position );
+}
+//-----------------------------------------------------------------------------
+
+
+/* Edge Routing Management *///------------------------------------------------
+EdgeRouter&	GraphScene::getEdgeRouter( )
+{
+	if ( _edgeRouter == 0 )
+	{
+		_edgeRouter = new EdgeRouter( );
+		foreach ( Node* node, _nodeGraphItemMap.keys( ) )
+			_edgeRouter->insertNode( *node );
+	}
+	return *_edgeRouter;
+}
+
+void	GraphScene::updateReroutedEdges( const Edge::Set& rerouted )
+{
+	foreach ( Edge* edge, rerouted )
+		scheduleEdgeUpdate( *edge );
+}
+//-----------------------------------------------------------------------------
+
+
+/* Properties Widget Management *///-------------------------------------------
+PropertiesWidget&	GraphScene::getPropertiesWidget( )
+{
+	if ( _propertiesWidget == 0 )
+	{
+		_propertiesWidget = new PropertiesWidget( *this );
+		addItem( _propertiesWidget );
+		_propertiesWidget->setVisible( false );
+	}
+	return *_propertiesWidget;
+}
+//-----------------------------------------------------------------------------
+
+
+/* Edge Layer Management *///--------------------------------------------------
+void	GraphScene::setEdgeLayerEnabled( bool enabled )
+{
+	if ( enabled == isEdgeLayerEnabled( ) )
+		return;
+
+	suspendIndex( );
+	if ( enabled )
+	{
+		_edgeLayer = new EdgeLayer( *this );
+		addItem( _edgeLayer );
+		foreach ( Edge* edge, _edgeGraphItemMap.keys( ) )
+			if ( isLayerEdge( *edge ) )
+			{
+				destroyGraphItem( *edge );
+				_edgeLayer->insertEdge( *edge );
+			}
+	}
+	else
+	{
+		// Promoted edges already have an edge item
+		Edge::List edges = _edgeLayer->getEdges( );
+		removeItem( _edgeLayer );
+		delete _edgeLayer;
+		_edgeLayer = 0;
+		_promotedEdges.clear( );
+		foreach ( Edge* edge, edges )
+			createGraphItem( *edge );
+	}
+	resumeIndex( );
+}
+
+void	GraphScene::updateEdgeItem( Edge& edge )
+{
+	_dirtyEdges.remove( &edge );	// Edge is up to date, no need to update it again on next flush
+	GraphItem* edgeItem = getGraphItem( edge );
+	if ( edgeItem != 0 )
+	{
+		addDirtyRect( edgeItem->getGraphicsItem( )->sceneBoundingRect( ) );
+		edgeItem->updateItem( );
+		addDirtyRect( edgeItem->getGraphicsItem( )->sceneBoundingRect( ) );
+	}
+	else if ( _edgeLayer != 0 )
+		_edgeLayer->updateEdge( edge );	// Layer reports its own dirty rects
+}
+
+void	GraphScene::updateEdgeItemStyle( Edge& edge )
+{
+	GraphItem* edgeItem = getGraphItem( edge );
+	if ( edgeItem != 0 )
+		edgeItem->updateItemStyle( );
+	else if ( _edgeLayer != 0 && _edgeLayer->hasEdge( edge ) )
+		_edgeLayer->insertEdge( edge );		// Move edge to its new style bucket
+}
+
+void	GraphScene::promoteEdge( Edge& edge )
+{
+	if ( _edgeLayer == 0 || !_edgeLayer->hasEdge( edge ) )
+		return;
+	_promotedEdges.insert( &edge );
+	_edgeLayer->removeEdge( edge );
+	createGraphItem( edge );
+}
+
+/*!	Demotion usually occurs in an edge layer hover event handler, while the scene is still dispatching the event:
+	promoted item is hidden and deleted once control returns to the event loop.
+ */
+void	GraphScene::demoteEdge( Edge& edge )
+{
+	if ( !_promotedEdges.remove( &edge ) )
+		return;
+	GraphItem* edgeItem = _edgeGraphItemMap.value( &edge, 0 );
+	if ( edgeItem != 0 )
+	{
+		_edgeGraphItemMap.remove( &edge );
+		edge.setGraphicsItem( 0 );
+		edge.setGraphItem( 0 );
+		edgeItem->setVisible( false );
+		edgeItem->deleteLater( );
+	}
+	if ( _edgeLayer != 0 )
+		_edgeLayer->insertEdge( edge );
+}
+
+/*!	Edges whose item is being destroyed (their mapping has already been removed) are ignored, selection changes
+	when a selected item is removed from the scene.
+ */
+void	GraphScene::demoteDeselectedEdges( )
+{
+	if ( _edgeLayer == 0 || _promotedEdges.isEmpty( ) )
+		return;
+	foreach ( Edge* edge, _promotedEdges )
+	{
+		GraphItem* edgeItem = _edgeGraphItemMap.value( edge, 0 );
+		if ( edgeItem != 0 && !edgeItem->isSelected( ) && edge != _edgeLayer->getHoveredEdge( ) )
+			demoteEdge( *edge );
+	}
+}
+
+bool	GraphScene::isLayerEdge( Edge& edge )
+{
+	return edge.type( ) != Edge::HYPER && QString( edge.metaObject( )->className( ) ) == "qan::Edge";
+}
+
+void	GraphScene::destroyGraphItem( Edge& edge )
+{
+	GraphItem* edgeItem = _edgeGraphItemMap.value( &edge, 0 );
+	if ( edgeItem == 0 )
+		return;
+	_edgeGraphItemMap.remove( &edge );
+	_hyperEdgeItems.remove( &edge );
+	edge.setGraphicsItem( 0 );
+	edge.setGraphItem( 0 );
+	addDirtyRect( edgeItem->getGraphicsItem( )->sceneBoundingRect( ) );
+	removeItem( edgeItem->getGraphicsItem( ) );
+	delete edgeItem;
+}
+//-----------------------------------------------------------------------------
+
+
+/* Position Batch Management *///----------------------------------------------
+void	GraphScene::beginBatch( )
+{
+	if ( _batchDepth++ == 0 && _edgeRouter != 0 )
+		_edgeRouter->beginUpdate( );
+}
+
+void	GraphScene::endBatch( )
+{
+	if ( _batchDepth <= 0 || --_batchDepth > 0 )
+		return;
+
+	// Collect moved nodes edges, and routes invalidated by the moves
+	Edge::Set edges;
+	foreach ( Node* node, _batchNodes )
+	{
+		if ( _edgeRouter != 0 )
+			_edgeRouter->nodeMoved( *node, edges );
+		edges.unite( node->getInEdges( ).toSet( ) );
+		edges.unite( node->getOutEdges( ).toSet( ) );
+	}
+	_batchNodes.clear( );
+	if ( _edgeRouter != 0 )
+		_edgeRouter->endUpdate( edges );
+
+	foreach ( Edge* edge, edges )
+		updateEdgeItem( *edge );
+}
+//-----------------------------------------------------------------------------
+
+
+/* Deferred Edge Update Management *///----------------------------------------
+/*!	Flush is queued in the event loop, so that edges are updated once per frame whatever the number of their
+	endpoints moves (for example while dragging a node with many edges, or a group).
+ */
+void	GraphScene::scheduleEdgeUpdate( Edge& edge )
+{
+	_dirtyEdges.insert( &edge );
+	if ( !_edgeFlushPending )
+	{
+		_edgeFlushPending = true;
+		QMetaObject::invokeMethod( this, "flushEdgeUpdates", Qt::QueuedConnection );
+	}
+}
+
+void	GraphScene::scheduleNodeEdgesUpdate( Node& node )
+{
+	foreach ( Edge* edge, node.getOutEdges( ) )
+		scheduleEdgeUpdate( *edge );
+	foreach ( Edge* edge, node.getInEdges( ) )
+		scheduleEdgeUpdate( *edge );
+}
+
+void	GraphScene::flushEdgeUpdates( )
+{
+	_edgeFlushPending = false;
+	Edge::Set dirtyEdges = _dirtyEdges;
+	_dirtyEdges.clear( );
+	foreach ( Edge* edge, dirtyEdges )
+		updateEdgeItem( *edge );
+}
+//-----------------------------------------------------------------------------
+
+
+/* Dirty Rect Management *///--------------------------------------------------
+/*!	Dirty areas are merged in a single bounding rect once they get too numerous, for example while a large
+	selection is dragged: invalidating a larger area is cheaper than testing thousands of small rects.
+ */
+void	GraphScene::addDirtyRect( const QRectF& rect )
+{
+	if ( rect.isEmpty( ) )
+		return;
+	if ( _dirtyRects.size( ) >= 256 )
+	{
+		QRectF br = rect;
+		foreach ( QRectF dirtyRect, _dirtyRects )
+			br |= dirtyRect;
+		_dirtyRects.clear( );
+		_dirtyRects << br;
+	}
+	else
+		_dirtyRects << rect;
+	if ( !_dirtyFlushPending )
 	{
-		const Node* node = _nodeGraphItemMap.key( nodeGraphItem, 0 );
-		if ( nodeGraphItem != 0 && node != 0 )
-			nodeGraphItem->getGraphicsItem( )->setPos( node->getPosition( ).x( ), node->getPosition( ).y( ) );
+		_dirtyFlushPending = true;
+		QMetaObject::invokeMethod( this, "flushDirtyRects", Qt::QueuedConnection );
 	}
 }
+
+void	GraphScene::flushDirtyRects( )
+{
+	_dirtyFlushPending = false;
+	if ( _dirtyRects.isEmpty( ) )
+		return;
+	QList< QRectF > dirtyRects = _dirtyRects;
+	_dirtyRects.clear( );
+	emit contentChanged( dirtyRects );
+}
+//-----------------------------------------------------------------------------
+
+
+/* Virtualization Management *///----------------------------------------------
+void	GraphScene::setVirtualized( bool virtualized )
+{
+	if ( virtualized == _virtualized )
+		return;
+
+	suspendIndex( );
+	if ( virtualized )
+	{
+		// Records are initialized from existing items, items are then materialized again for the visible area only
+		_virtualized = true;
+		Node::List nodes = _nodeGraphItemMap.keys( );
+		foreach ( Node* node, nodes )
+			registerVirtualNode( *node );
+		Edge::Set edges;
+		destroyGraphItems( Node::Set::fromList( nodes ), edges );
+		_visibleNodes.clear( );
+		_parkedNodes.clear( );
+		_farNodes.clear( );
+		updateVirtualization( _virtualArea );
+	}
+	else
+	{
+		Node::List nodes = _virtualIds.keys( );
+		foreach ( Node* node, nodes )
+			materializeNode( *node );
+		_virtualized = false;
+		_virtualIndex.clear( );
+		_virtualIds.clear( );
+		_virtualNodes.clear( );
+		_visibleNodes.clear( );
+		_parkedNodes.clear( );
+		_farNodes.clear( );
+	}
+	resumeIndex( );
+}
+
+/*!	Nothing is done when the area nodes have not changed. Items are materialized or parked with the scene index
+	suspended only when many items change (see isBulkChange()).
+ */
+void	GraphScene::updateVirtualization( QRectF visibleRect )
+{
+	_virtualArea = visibleRect;
+	if ( !_virtualized || visibleRect.isEmpty( ) )
+		return;
+
+	// Materialized nodes may have been moved with the mouse since last update
+	foreach ( Node* node, _visibleNodes )
+		updateVirtualNodeRect( *node );
+
+	QVector< int > ids;
+	_virtualIndex.query( visibleRect.adjusted( -_virtualMargin, -_virtualMargin, _virtualMargin, _virtualMargin ), ids );
+	Node::Set areaNodes;
+	foreach ( int id, ids )
+		areaNodes.insert( _virtualNodes.value( id ) );
+
+	// Nodes adjacent to area nodes get a hidden item, so that edges leaving the area are drawn
+	Node::Set farNodes;
+	foreach ( Node* node, areaNodes )
+	{
+		foreach ( Edge* edge, node->getOutEdges( ) )
+			farNodes.insert( &edge->getDst( ) );
+		foreach ( Edge* edge, node->getInEdges( ) )
+			farNodes.insert( &edge->getSrc( ) );
+	}
+	farNodes.subtract( areaNodes );
+	if ( areaNodes == _visibleNodes && farNodes == _farNodes )
+		return;
+
+	Node::Set leavingNodes = _visibleNodes;
+	leavingNodes.subtract( areaNodes );
+	Node::Set leavingFarNodes = _farNodes;
+	leavingFarNodes.subtract( farNodes );
+	leavingFarNodes.subtract( areaNodes );
+	int enteringCount = areaNodes.size( ) - _visibleNodes.size( ) + leavingNodes.size( );
+	int enteringFarCount = qMax( 0, farNodes.size( ) - _farNodes.size( ) + leavingFarNodes.size( ) );
+	int changeCount = leavingNodes.size( ) + enteringCount + leavingFarNodes.size( ) + enteringFarCount;
+	bool bulkChange = isBulkChange( changeCount );
+	if ( bulkChange )
+		suspendIndex( );
+
+	foreach ( Node* node, leavingNodes )
+		parkNode( *node );
+	foreach ( Node* node, leavingFarNodes )
+	{
+		_farNodes.remove( node );
+		if ( getGraphItem( *node ) != 0 )
+			_parkedNodes.append( node );	// Item is already hidden
+	}
+	foreach ( Node* node, farNodes )
+		materializeFarNode( *node );
+	foreach ( Node* node, areaNodes )
+		materializeNode( *node );
+	Node::Set evictedNodes;
+	while ( _parkedNodes.size( ) > qMax( 0, _parkCapacity ) )
+		evictedNodes.insert( _parkedNodes.takeFirst( ) );
+	if ( !evictedNodes.isEmpty( ) )
+	{
+		Edge::Set edges;
+		destroyGraphItems( evictedNodes, edges );
+	}
+	if ( bulkChange )
+		resumeIndex( );
+}
+
+void	GraphScene::registerVirtualNode( Node& node )
+{
+	if ( _virtualIds.contains( &node ) )
+		return;
+	int id = _virtualNextId++;
+	_virtualIds.insert( &node, id );
+	_virtualNodes.insert( id, &node );
+
+	// Nodes that have never been materialized use a default size until their item is created
+	QSizeF size( node.getDimension( ).x( ), node.getDimension( ).y( ) );
+	GraphItem* nodeItem = getGraphItem( node );
+	if ( nodeItem != 0 )
+		size = nodeItem->getSceneContentRect( ).size( );
+	if ( size.isEmpty( ) )
+		size = QSizeF( 100., 25. );
+	node.setDimension( QPointF( size.width( ), size.height( ) ) );
+	_virtualIndex.insert( id, QRectF( node.getPosition( ), size ) );
+}
+
+void	GraphScene::unregisterVirtualNode( Node& node )
+{
+	int id = _virtualIds.value( &node, -1 );
+	if ( id < 0 )
+		return;
+	_virtualIndex.remove( id );
+	_virtualIds.remove( &node );
+	_virtualNodes.remove( id );
+	_visibleNodes.remove( &node );
+	_parkedNodes.removeAll( &node );
+	_farNodes.remove( &node );
+}
+
+void	GraphScene::updateVirtualNodeRect( Node& node )
+{
+	int id = _virtualIds.value( &node, -1 );
+	if ( id < 0 )
+		return;
+	QSizeF size = _virtualIndex.getRect( id ).size( );
+	GraphItem* nodeItem = getGraphItem( node );
+	if ( nodeItem != 0 )
+	{
+		size = nodeItem->getSceneContentRect( ).size( );
+		node.setDimension( QPointF( size.width( ), size.height( ) ) );	// Layouts use dimension for nodes without items
+	}
+	_virtualIndex.insert( id, QRectF( node.getPosition( ), size ) );
+}
+
+void	GraphScene::materializeNode( Node& node )
+{
+	if ( _visibleNodes.contains( &node ) )
+		return;
+	GraphItem* nodeItem = getGraphItem( node );
+	if ( nodeItem != 0 )
+	{
+		if ( !_farNodes.remove( &node ) )
+			_parkedNodes.removeOne( &node );
+		nodeItem->getGraphicsItem( )->setVisible( true );
+	}
+	else
+	{
+		createGraphItem( node );
+		nodeItem = getGraphItem( node );
+		if ( nodeItem == 0 )
+			return;
+		nodeItem->getGraphicsItem( )->setPos( node.getPosition( ) );
+	}
+	_visibleNodes.insert( &node );
+	updateVirtualEdges( node );
+}
+
+void	GraphScene::parkNode( Node& node )
+{
+	if ( !_visibleNodes.remove( &node ) )
+		return;
+	GraphItem* nodeItem = getGraphItem( node );
+	if ( nodeItem == 0 )
+		return;
+	updateVirtualNodeRect( node );
+	nodeItem->getGraphicsItem( )->setVisible( false );
+	_parkedNodes.append( &node );
+	updateVirtualEdges( node );
+}
+
+/*!	Far nodes items are hidden: they are only used as endpoints of edges between visible nodes and nodes outside
+	the visible area.
+ */
+void	GraphScene::materializeFarNode( Node& node )
+{
+	if ( _visibleNodes.contains( &node ) || _farNodes.contains( &node ) || !_virtualIds.contains( &node ) )
+		return;
+	_farNodes.insert( &node );
+	GraphItem* nodeItem = getGraphItem( node );
+	if ( nodeItem != 0 )
+	{
+		_parkedNodes.removeOne( &node );
+		return;
+	}
+	createGraphItem( node );
+	nodeItem = getGraphItem( node );
+	if ( nodeItem == 0 )
+		return;
+	nodeItem->getGraphicsItem( )->setVisible( false );
+	nodeItem->getGraphicsItem( )->setPos( node.getPosition( ) );
+	updateVirtualEdges( node );
+}
+
+/*!	An edge item is visible when its source or its destination is visible (its other node has at least a hidden
+	item, see materializeFarNode()), edges drawn by the edge layer are removed from the layer when they are not visible.
+ */
+void	GraphScene::updateVirtualEdges( Node& node )
+{
+	Edge::Set edges = Edge::Set::fromList( node.getInEdges( ) );
+	edges.unite( Edge::Set::fromList( node.getOutEdges( ) ) );
+	foreach ( Edge* edge, edges )
+	{
+		if ( !canMaterialize( *edge ) )
+			continue;
+		bool visible = _visibleNodes.contains( &edge->getSrc( ) ) || _visibleNodes.contains( &edge->getDst( ) );
+		GraphItem* edgeItem = getGraphItem( *edge );
+		if ( edgeItem != 0 )
+			edgeItem->getGraphicsItem( )->setVisible( visible );
+		else if ( visible )
+			createGraphItem( *edge );		// Either an edge item or an edge layer entry
+		else if ( _edgeLayer != 0 )
+			_edgeLayer->removeEdge( *edge );
+		if ( visible )
+			scheduleEdgeUpdate( *edge );
+	}
+}
+
+bool	GraphScene::canMaterialize( Edge& edge ) const
+{
+	if ( getGraphItem( edge.getSrc( ) ) == 0 || getGraphItem( edge.getDst( ) ) == 0 )
+		return false;
+	if ( edge.type( ) == Edge::HYPER )
+	{
+		Node::Set members = static_cast< HEdge& >( edge ).getHDst( );
+		members.unite( static_cast< HEdge& >( edge ).getHSrc( ) );
+		foreach ( Node* member, members )
+			if ( getGraphItem( *member ) == 0 )
+				return false;
+	}
+	return true;
+}
+
+void	GraphScene::destroyGraphItem( Node& node )
+{
+	Node::Set nodes; nodes.insert( &node );
+	Edge::Set edges;
+	destroyGraphItems( nodes, edges );
+}
+
+/*!	Hyper edge items are scanned once for hyper edges members, whatever the number of nodes: destroy node items
+	in batches rather than calling destroyGraphItem(Node&) in a loop.
+ */
+void	GraphScene::destroyGraphItems( const Node::Set& nodes, Edge::Set& edges )
+{
+	// Edges can't be drawn without their nodes items, hyper edges members are not referenced by their nodes
+	Edge::Set nodesEdges;
+	foreach ( Node* node, nodes )
+	{
+		if ( _nodeGraphItemMap.contains( node ) )
+		{
+			nodesEdges.unite( Edge::Set::fromList( node->getInEdges( ) ) );
+			nodesEdges.unite( Edge::Set::fromList( node->getOutEdges( ) ) );
+		}
+	}
+	foreach ( Edge* edge, _hyperEdgeItems )		// Usually empty, only hyper edges are scanned
+	{
+		HEdge* hedge = static_cast< HEdge* >( edge );
+		foreach ( Node* member, hedge->getHDst( ) + hedge->getHSrc( ) )
+			if ( nodes.contains( member ) )
+			{
+				nodesEdges.insert( hedge );
+				break;
+			}
+	}
+	foreach ( Edge* edge, nodesEdges )
+	{
+		destroyGraphItem( *edge );
+		if ( _edgeLayer != 0 )
+			_edgeLayer->removeEdge( *edge );
+		_dirtyEdges.remove( edge );
+	}
+	edges.unite( nodesEdges );
+
+	foreach ( Node* node, nodes )
+	{
+		GraphItem* nodeItem = _nodeGraphItemMap.value( node, 0 );
+		if ( nodeItem == 0 )
+			continue;
+		_batchNodes.remove( node );
+		_nodeGraphItemMap.remove( node );
+		node->setGraphicsItem( 0 );
+		node->setGraphItem( 0 );
+		addDirtyRect( nodeItem->getGraphicsItem( )->sceneBoundingRect( ) );
+		removeItem( nodeItem->getGraphicsItem( ) );
+		delete nodeItem;
+	}
+}
+//-----------------------------------------------------------------------------
+
+
+/* Spatial Index Management *///-----------------------------------------------
+void	GraphScene::setIndexPolicy( IndexPolicy indexPolicy )
+{
+	_indexPolicy = indexPolicy;
+	updateIndexMethod( );
+}
+
+void	GraphScene::suspendIndex( )
+{
+	if ( _indexSuspendCount++ == 0 )
+		updateIndexMethod( );
+}
+
+void	GraphScene::resumeIndex( )
+{
+	if ( _indexSuspendCount > 0 && --_indexSuspendCount == 0 )
+		updateIndexMethod( );
+}
+
+void	GraphScene::updateIndexMethod( )
+{
+	bool useIndex = ( _indexPolicy == IndexAlways ) ||
+					( _indexPolicy == IndexAutomatic && _indexSuspendCount == 0 );
+	ItemIndexMethod indexMethod = ( useIndex ? BspTreeIndex : NoIndex );
+	if ( itemIndexMethod( ) != indexMethod )
+		setItemIndexMethod( indexMethod );
+}
+
+bool	GraphScene::isBulkChange( int itemCount ) const
+{
+	return itemCount >= 64 && itemCount * 8 >= _nodeGraphItemMap.size( ) + _edgeGraphItemMap.size( );
+}
 //-----------------------------------------------------------------------------
 
 
@@ -111,37 +832,69 @@ void	GraphScene::updatePositions( Node* except )
 void	GraphScene::edgeInserted( qan::Edge& edge )
 {
 	insertEdgeGraphItem( edge );
+	if ( _virtualized )
+	{
+		// Edges leaving the visible area are drawn with a hidden item for their node outside the area
+		if ( _visibleNodes.contains( &edge.getSrc( ) ) )
+			materializeFarNode( edge.getDst( ) );
+		if ( _visibleNodes.contains( &edge.getDst( ) ) )
+			materializeFarNode( edge.getSrc( ) );
+		updateVirtualEdges( edge.getSrc( ) );	// Hide edge if none of its nodes is visible
+	}
 
 	foreach ( qan::NodeGroup* nodeGroup, _nodeGroups )
 		if ( nodeGroup->hasNode( edge.getSrc( ) ) || nodeGroup->hasNode( edge.getDst( ) ) )
 			nodeGroup->addEdge( edge );
+	if ( _edgeBundlesEnabled )
+		bundleEdge( edge );
 }
 
 void	GraphScene::edgeModified( qan::Edge& edge )
 {
-	GraphItem* edgeItem = getGraphItem( edge );
-	if ( edgeItem != 0 )
-		edgeItem->updateItem( );
+	updateEdgeItem( edge );
 }
 
 void	GraphScene::edgeRemoved( qan::Edge& edge )
 {
-	GraphItem* edgeItem = getGraphItem( edge );
-	if (  edgeItem != 0 )
-		delete edgeItem;
+	if ( _edgeRouter != 0 )
+		_edgeRouter->removeEdge( edge );
+	if ( _edgeLayer != 0 )
+		_edgeLayer->removeEdge( edge );
+	_promotedEdges.remove( &edge );
+	_dirtyEdges.remove( &edge );
+	unbundleEdge( edge );
+	if ( !_collapsedNodes.isEmpty( ) )
+	{
+		if ( _collapsedNodes.contains( &edge.getSrc( ) ) )
+			_collapsedNodes.value( &edge.getSrc( ) )->removeEdge( edge );
+		if ( _collapsedNodes.contains( &edge.getDst( ) ) )
+			_collapsedNodes.value( &edge.getDst( ) )->removeEdge( edge );
+	}
+	destroyGraphItem( edge );	// Edge item and its mapping
 }
 
 void	GraphScene::nodeInserted( qan::Node& node )
 {
 	insertNodeGraphItem( node );
+	if ( _edgeRouter != 0 )
+		_edgeRouter->insertNode( node );
+	if ( _virtualized && !_virtualArea.isEmpty( ) && _virtualArea.adjusted( -_virtualMargin, -_virtualMargin, _virtualMargin, _virtualMargin ).contains( node.getPosition( ) ) )
+		materializeNode( node );
 }
 
 void	GraphScene::nodeRemoved( qan::Node& node )
 {
+	if ( _edgeRouter != 0 )
+		_edgeRouter->removeNode( node );
+	_batchNodes.remove( &node );
+	_collapsedNodes.remove( &node );
+	unregisterVirtualNode( node );
+
 	GraphItem* nodeItem = getGraphItem( node );
 	if (  nodeItem != 0 )
 	{
 		_nodeGraphItemMap.remove( &node );
+		addDirtyRect( nodeItem->getGraphicsItem( )->sceneBoundingRect( ) );
 		delete nodeItem;
 	}
 
@@ -154,21 +907,33 @@ void	GraphScene::nodeChanged( qan::Node& node )
 {
 	GraphItem* graphItem = getGraphItem( node );
 	if (  graphItem != 0 )
+	{
+		addDirtyRect( graphItem->getGraphicsItem( )->sceneBoundingRect( ) );
 		graphItem->updateItem( );
+		addDirtyRect( graphItem->getGraphicsItem( )->sceneBoundingRect( ) );
+	}
 }
 
 void	GraphScene::insertNodesGraphItems( Node::List& rootNodes )
 {
+	// Index is rebuilt once all items have been inserted
+	suspendIndex( );
 	foreach ( Node* node, rootNodes )
 		insertNodeGraphItem( *node );
+	if ( _virtualized )
+		updateVirtualization( _virtualArea );
+	resumeIndex( );
 }
 
 void	GraphScene::insertNodeGraphItem( qan::Node& node )
 {
-	// Don't insert a node that is already existing
-	if ( getGraphItem( node ) )
+	// Don't insert a node that is already existing, collapsed groups nodes items are created when group is expanded
+	if ( getGraphItem( node ) || _virtualIds.contains( &node ) || _collapsedNodes.contains( &node ) )
 		return;
-	createGraphItem( node );
+	if ( _virtualized )
+		registerVirtualNode( node );	// Item is created when node is in the visible area
+	else
+		createGraphItem( node );
 
 	// Insert node edges
 	Edge::Set edges = Edge::Set::fromList( node.getInEdges( ) );
@@ -194,6 +959,19 @@ void	GraphScene::insertEdgeGraphItem( qan::Edge& edge )
 {
 	if ( getGraphItem( edge ) ) // Do not insert an already existing edge
 		return;
+	if ( _virtualized && !canMaterialize( edge ) )	// Edge is created when its nodes are materialized
+		return;
+	if ( !_collapsedNodes.isEmpty( ) )
+	{
+		NodeGroupProxyItem* srcProxy = _collapsedNodes.value( &edge.getSrc( ), 0 );
+		NodeGroupProxyItem* dstProxy = _collapsedNodes.value( &edge.getDst( ), 0 );
+		if ( srcProxy != 0 && srcProxy == dstProxy )
+			return;		// Edges inside a collapsed group are not drawn
+		if ( srcProxy != 0 )
+			srcProxy->addEdge( edge );
+		if ( dstProxy != 0 )
+			dstProxy->addEdge( edge );
+	}
 	createGraphItem( edge );
 }
 //-----------------------------------------------------------------------------
@@ -211,11 +989,202 @@ void	GraphScene::addNodeGroup( qan::NodeGroup& nodeGroup )
 
 void	GraphScene::removeNodeGroup( qan::NodeGroup& nodeGroup )
 {
+	nodeGroup.setCollapsed( false );	// Restore group nodes items
 	_nodeGroups.removeAll( &nodeGroup );
+	clearEdgeBundles( &nodeGroup );
 	removeItem( &nodeGroup );
     _dropTargets.removeAll( &nodeGroup );   // Eventually, remove the given nodegroup from drop targets list
 	emit nodeGroupRemoved( &nodeGroup );
 }
+
+/*!	Edges between two nodes of the collapsed group have no item, other edges are created again and drawn to the
+	group proxy. Index is rebuilt once, so that collapsing a large group stays linear in its nodes and edges count.
+ */
+void	GraphScene::collapseNodes( qan::NodeGroup& nodeGroup, const Node::Set& nodes )
+{
+	// Index is rebuilt only when the group is large compared to the scene, small groups update the index incrementally
+	NodeGroupProxyItem* proxyItem = nodeGroup.getProxyItem( );
+	bool bulkChange = isBulkChange( nodes.size( ) );
+	if ( bulkChange )
+		suspendIndex( );
+	Edge::Set edges;
+	destroyGraphItems( nodes, edges );
+	foreach ( Node* node, nodes )
+	{
+		_collapsedNodes.insert( node, proxyItem );
+		edges.unite( Edge::Set::fromList( node->getInEdges( ) ) );
+		edges.unite( Edge::Set::fromList( node->getOutEdges( ) ) );
+	}
+	foreach ( Edge* edge, edges )
+		insertEdgeGraphItem( *edge );
+	if ( bulkChange )
+		resumeIndex( );
+}
+
+void	GraphScene::expandNodes( qan::NodeGroup& nodeGroup, const Node::Set& nodes )
+{
+	NodeGroupProxyItem* proxyItem = nodeGroup.getProxyItem( );
+	bool bulkChange = isBulkChange( nodes.size( ) );
+	if ( bulkChange )
+		suspendIndex( );
+	Edge::Set edges;
+	foreach ( Node* node, nodes )
+	{
+		if ( _collapsedNodes.remove( node ) == 0 )
+			continue;	// Node has been removed from graph
+		edges.unite( Edge::Set::fromList( node->getInEdges( ) ) );
+		edges.unite( Edge::Set::fromList( node->getOutEdges( ) ) );
+		createGraphItem( *node );
+		GraphItem* nodeItem = getGraphItem( *node );
+		if ( nodeItem != 0 )
+			nodeItem->getGraphicsItem( )->setPos( node->getPosition( ) );
+	}
+
+	// Edges drawn to the proxy are created again with their new endpoints
+	foreach ( Edge* edge, edges )
+	{
+		proxyItem->removeEdge( *edge );
+		destroyGraphItem( *edge );
+		if ( _edgeLayer != 0 )
+			_edgeLayer->removeEdge( *edge );
+		insertEdgeGraphItem( *edge );
+	}
+	if ( bulkChange )
+		resumeIndex( );
+}
+
+GraphItem*	GraphScene::getEndpointItem( qan::Node& node ) const
+{
+	GraphItem* nodeItem = node.getGraphItem( );
+	if ( nodeItem != 0 || _collapsedNodes.isEmpty( ) )
+		return nodeItem;
+	return _collapsedNodes.value( &node, 0 );
+}
+//-----------------------------------------------------------------------------
+
+
+/* Edge Bundle Management *///-------------------------------------------------
+void	GraphScene::setEdgeBundlesEnabled( bool enabled )
+{
+	if ( enabled == _edgeBundlesEnabled )
+		return;
+	_edgeBundlesEnabled = enabled;
+	if ( !enabled )
+	{
+		clearEdgeBundles( );
+		update( );	// Draw previously bundled edges
+		return;
+	}
+
+	// Bundle existing edges leaving a group (edges between two groups are found from their source group)
+	foreach ( NodeGroup* nodeGroup, _nodeGroups )
+		foreach ( Node* node, nodeGroup->getNodes( ) )
+			foreach ( Edge* edge, node->getOutEdges( ) )
+				bundleEdge( *edge );
+}
+
+void	GraphScene::setEdgeBundleThreshold( qreal threshold )
+{
+	_edgeBundleThreshold = threshold;
+	foreach ( EdgeBundleItem* bundle, _edgeBundles )
+		bundle->update( );
+	update( );	// Bundled edges visibility depends on the threshold too
+}
+
+EdgeBundleItem*	GraphScene::getEdgeBundle( NodeGroup& src, NodeGroup& dst ) const
+{
+	return _edgeBundles.value( getNodeGroupPair( &src, &dst ), 0 );
+}
+
+bool	GraphScene::isEdgeBundled( Edge& edge, qreal lod ) const
+{
+	if ( _bundledEdges.isEmpty( ) )
+		return false;
+	EdgeBundleItem* bundle = _bundledEdges.value( &edge, 0 );
+	return ( bundle != 0 && bundle->isAggregated( lod ) );
+}
+
+void	GraphScene::updateEdgeBundles( NodeGroup& nodeGroup )
+{
+	foreach ( EdgeBundleItem* bundle, _edgeBundles )
+		if ( &bundle->getSrc( ) == &nodeGroup || &bundle->getDst( ) == &nodeGroup )
+			bundle->updateItem( );
+}
+
+void	GraphScene::updateNodeEdgeBundles( Node& node )
+{
+	if ( !_edgeBundlesEnabled )
+		return;
+	Edge::Set edges = Edge::Set::fromList( node.getInEdges( ) );
+	edges.unite( Edge::Set::fromList( node.getOutEdges( ) ) );
+	foreach ( Edge* edge, edges )
+	{
+		unbundleEdge( *edge );
+		bundleEdge( *edge );
+		updateEdgeItem( *edge );
+	}
+}
+
+NodeGroup*	GraphScene::getNodeGroup( Node& node ) const
+{
+	foreach ( NodeGroup* nodeGroup, _nodeGroups )
+		if ( nodeGroup->hasNode( node ) )
+			return nodeGroup;
+	return 0;
+}
+
+GraphScene::NodeGroupPair	GraphScene::getNodeGroupPair( NodeGroup* src, NodeGroup* dst )
+{
+	return ( src < dst ? NodeGroupPair( src, dst ) : NodeGroupPair( dst, src ) );
+}
+
+void	GraphScene::bundleEdge( Edge& edge )
+{
+	if ( _bundledEdges.contains( &edge ) )
+		return;
+	NodeGroup* src = getNodeGroup( edge.getSrc( ) );
+	NodeGroup* dst = getNodeGroup( edge.getDst( ) );
+	if ( src == 0 || dst == 0 || src == dst )
+		return;	// Edges inside a group or outside groups are never bundled
+
+	NodeGroupPair groups = getNodeGroupPair( src, dst );
+	EdgeBundleItem* bundle = _edgeBundles.value( groups, 0 );
+	if ( bundle == 0 )
+	{
+		bundle = new EdgeBundleItem( *this, *src, *dst );
+		_edgeBundles.insert( groups, bundle );
+		addItem( bundle );
+		bundle->updateItem( );
+	}
+	bundle->addEdge( edge );
+	_bundledEdges.insert( &edge, bundle );
+}
+
+void	GraphScene::unbundleEdge( Edge& edge )
+{
+	EdgeBundleItem* bundle = _bundledEdges.take( &edge );
+	if ( bundle == 0 )
+		return;
+	bundle->removeEdge( edge );
+	if ( bundle->getEdgeCount( ) == 0 )
+	{
+		_edgeBundles.remove( getNodeGroupPair( &bundle->getSrc( ), &bundle->getDst( ) ) );
+		delete bundle;
+	}
+}
+
+void	GraphScene::clearEdgeBundles( NodeGroup* nodeGroup )
+{
+	foreach ( EdgeBundleItem* bundle, _edgeBundles.values( ) )
+	{
+		if ( nodeGroup != 0 && &bundle->getSrc( ) != nodeGroup && &bundle->getDst( ) != nodeGroup )
+			continue;
+		foreach ( Edge* edge, bundle->getEdges( ) )
+			_bundledEdges.remove( edge );
+		_edgeBundles.remove( getNodeGroupPair( &bundle->getSrc( ), &bundle->getDst( ) ) );
+		delete bundle;
+	}
+}
 //-----------------------------------------------------------------------------
 
 
@@ -234,19 +1203,18 @@ GraphItem*	GraphScene::getGraphItem( qan::Edge& edge ) const
 	return _edgeGraphItemMap.value( &edge, 0 );
 }
 
-/*!	\return	0 if there is no node at the given position, or a pointer to the most top node.
+/*!	Query use the scene index (see setIndexPolicy()), node sub items (labels for example) resolve to their node.
+	\return	0 if there is no node at the given position, or a pointer to the most top node.
  */
 Node*	GraphScene::getNodeAt( QPointF scenePos )
 {
-    Q_UNUSED( scenePos );
-//	QList< QGraphicsItem* > qItems = items( scenePos );
-//	foreach ( QGraphicsItem* qItem, qItems )
-//	{
-		// FIXME v0.4.0
-//		qan::Node* node = getGraphicItemNode( qItem );
-//		if ( node != 0 )
-//			return node;
-//	}
+	foreach ( QGraphicsItem* item, items( scenePos, Qt::IntersectsItemShape, Qt::DescendingOrder ) )
+		for ( QGraphicsItem* parent = item; parent != 0; parent = parent->parentItem( ) )
+		{
+			NodeItem* nodeItem = qgraphicsitem_cast< NodeItem* >( parent );
+			if ( nodeItem != 0 )
+				return &nodeItem->getNode( );
+		}
 	return 0;
 }
 
@@ -263,6 +1231,7 @@ void	GraphScene::createGraphItem( Node& node )
 			_nodeGraphItemMap.insert( &node, graphItem );
 			node.setGraphicsItem( graphItem->getGraphicsItem( ) );
 			node.setGraphItem( graphItem  );
+			addDirtyRect( graphItem->getGraphicsItem( )->sceneBoundingRect( ) );
 			break;
 		}
 	}
@@ -270,6 +1239,13 @@ void	GraphScene::createGraphItem( Node& node )
 
 void	GraphScene::createGraphItem( Edge& edge )
 {
+	// In edge layer mode, plain edges are only registered in the edge layer
+	if ( _edgeLayer != 0 && isLayerEdge( edge ) && !_promotedEdges.contains( &edge ) )
+	{
+		_edgeLayer->insertEdge( edge );
+		return;
+	}
+
 	// Get a graph item factory for the node
 	GraphItem::Factory::List factories = getGraphItemFactories( edge.metaObject( )->className( ) );
 	foreach ( GraphItem::Factory* factory, factories )
@@ -279,8 +1255,11 @@ void	GraphScene::createGraphItem( Edge& edge )
 		{
 			addItem( graphItem->getGraphicsItem( ) );	// Hack for QT 5.3
 			_edgeGraphItemMap.insert( &edge, graphItem );
+			if ( edge.type( ) == Edge::HYPER )
+				_hyperEdgeItems.insert( &edge );
 			edge.setGraphicsItem( graphItem->getGraphicsItem( ) );
 			edge.setGraphItem( graphItem );
+			addDirtyRect( graphItem->getGraphicsItem( )->sceneBoundingRect( ) );
 			break;
 		}
 	}
@@ -297,7 +1276,14 @@ void	GraphScene::mouseDoubleClickEvent( QGraphicsSceneMouseEvent* mouseEvent )
 
 	// Activate label edition when a qan::LabelEditorItem is double clicked in scene
 	QGraphicsItem* item = itemAt( mouseEvent->scenePos( ), QTransform( ) );
-	if ( item != 0 && item->type( ) == qan::LabelEditorItem::Type )
+	if ( item != 0 && item->type( ) != qan::LabelEditorItem::Type && node != 0 && getGraphItem( *node ) != 0 )
+	{
+		// In fast label mode, a label editor is created on demand over the node static label
+		NodeItem* nodeItem = qgraphicsitem_cast< NodeItem* >( getGraphItem( *node )->getGraphicsItem( ) );
+		if ( nodeItem != 0 && nodeItem->hasStaticLabel( ) )
+			nodeItem->editLabel( );
+	}
+	else if ( item != 0 && item->type( ) == qan::LabelEditorItem::Type )
 	{
 		QGraphicsTextItem* ti = (QGraphicsTextItem* )item;
 		if ( ti->textInteractionFlags( ) == Qt::TextEditorInteraction )
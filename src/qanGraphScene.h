@@ -36,6 +36,8 @@
 #include "./qanGraphModel.h"
 #include "./qanStyleManager.h"
 #include "./qanNodeGroup.h"
+#include "./qanEdgeRouter.h"
+#include "./qanPaintStatistics.h"
 
 // QT headers
 #include <QAbstractItemModel>
@@ -44,6 +46,9 @@
 #include <QGraphicsView>
 #include <QGraphicsItem>
 #include <QMap>
+#include <QHash>
+#include <QPair>
+#include <QVector>
 #include <QStandardItemModel>
 #include <QGraphicsSceneMouseEvent>
 #include <QGraphicsItemGroup>
@@ -54,6 +59,9 @@ namespace qan { // ::qan
 
 	class Grid;
 	class Layout;
+	class EdgeRouter;
+	class EdgeLayer;
+	class EdgeBundleItem;
 
         //! Show a standard qan::Graph as a scene that could be displayed in a QGraphicsView.
         /*!
@@ -93,8 +101,358 @@ namespace qan { // ::qan
             //! Clear the scene from all its graphics elements (styles are not destroyed).
             void			clear( );
 
-            //! FIXME v0.4.0
+            //! Move node items to their node position (as set by a layout), except for an optional node.
             void			updatePositions( Node* except = 0 );
+
+            //! Set nodes positions and move their items, positions[i] is the position of nodes[i].
+            void			updatePositions( const Node::List& nodes, const QVector< QPointF >& positions );
+
+            //! Set nodes positions and move their items from a node to position mapping.
+            void			updatePositions( const QHash< Node*, QPointF >& positions );
+
+        protected:
+
+            //! Move a node item to a given position, node edges are updated when the current batch ends.
+            void			moveNodeItem( Node& node, GraphItem* nodeGraphItem, QPointF position );
+            //@}
+            //---------------------------------------------------------------------
+
+
+
+            /*! \name Edge Routing Management *///--------------------------------
+            //@{
+        public:
+
+            //! Get this scene orthogonal edge router (router is created and populated with existing nodes on first call).
+            EdgeRouter&		getEdgeRouter( );
+
+            //! Return true if an edge router has already been created for this scene.
+            bool			hasEdgeRouter( ) const { return _edgeRouter != 0; }
+
+            //! Update the graphics items of edges whose route has been invalidated.
+            void			updateReroutedEdges( const Edge::Set& rerouted );
+
+        protected:
+
+            EdgeRouter*		_edgeRouter;
+            //@}
+            //---------------------------------------------------------------------
+
+
+
+            /*! \name Properties Widget Management *///-------------------------
+            //@{
+        public:
+
+            //! Get the properties popup widget shared by every item of this scene (widget is created on first call).
+            PropertiesWidget&	getPropertiesWidget( );
+
+            bool				hasPropertiesWidget( ) const { return _propertiesWidget != 0; }
+
+        protected:
+
+            PropertiesWidget*	_propertiesWidget;
+            //@}
+            //---------------------------------------------------------------------
+
+
+
+            /*! \name Node Label Management *///-------------------------------
+            //@{
+        public:
+
+            //! Draw node labels with a cached static text, a rich text editor is created only when a label is double clicked.
+            /*! Fast labels mode must be set before node items are created (it has no effect on existing items). */
+            void				setFastLabels( bool fastLabels ) { _fastLabels = fastLabels; }
+
+            bool				hasFastLabels( ) const { return _fastLabels; }
+
+        protected:
+
+            bool				_fastLabels;
+            //@}
+            //---------------------------------------------------------------------
+
+
+
+            /*! \name Paint Statistics Management *///-------------------------
+            //@{
+        public:
+
+            //! Set the statistics where scene items report their updates (set by GraphView::setPaintStatisticsEnabled()), 0 to disable.
+            void				setPaintStatistics( PaintStatistics* paintStatistics ) { _paintStatistics = paintStatistics; }
+
+            //! Return current paint statistics, or 0 if statistics are not collected.
+            PaintStatistics*	getPaintStatistics( ) { return _paintStatistics; }
+
+        protected:
+
+            PaintStatistics*	_paintStatistics;
+            //@}
+            //---------------------------------------------------------------------
+
+
+
+            /*! \name Edge Layer Management *///--------------------------------
+            //@{
+        public:
+
+            //! Enable the edge layer rendering mode: plain edges are drawn by a single scene item instead of an edge item per edge.
+            /*! In edge layer mode, plain qan::Edge edges have no graph item, except when they are promoted (hovered edges are
+                promoted automatically, and stay promoted while they are selected). Edges are then drawn as straight lines, whatever the registered edge item factory. */
+            void			setEdgeLayerEnabled( bool enabled );
+
+            bool			isEdgeLayerEnabled( ) const { return _edgeLayer != 0; }
+
+            //! Get this scene edge layer (0 if edge layer mode is disabled).
+            EdgeLayer*		getEdgeLayer( ) { return _edgeLayer; }
+
+            //! Update the graphics of an edge, either its edge item or its edge layer geometry.
+            void			updateEdgeItem( Edge& edge );
+
+            //! Update the style of an edge, either its edge item style or its edge layer bucket.
+            void			updateEdgeItemStyle( Edge& edge );
+
+            //! Create a real edge item for an edge drawn by the edge layer (for example when the edge is selected).
+            void			promoteEdge( Edge& edge );
+
+            //! Destroy the edge item of a promoted edge, edge is drawn by the edge layer again.
+            void			demoteEdge( Edge& edge );
+
+        protected slots:
+
+            //! Demote promoted edges that are neither selected nor hovered, called when the scene selection changes.
+            void			demoteDeselectedEdges( );
+
+        protected:
+
+            //! Return true if an edge should be drawn by the edge layer in edge layer mode.
+            static bool		isLayerEdge( Edge& edge );
+
+            //! Destroy an edge graphics item and its mapping.
+            void			destroyGraphItem( Edge& edge );
+
+            EdgeLayer*		_edgeLayer;
+
+            Edge::Set		_promotedEdges;
+            //@}
+            //---------------------------------------------------------------------
+
+
+
+            /*! \name Position Batch Management *///-----------------------------
+            //@{
+        public:
+
+            //! Start a batch of node moves: edges of moved nodes are no longer updated on each move (batches can be nested).
+            void			beginBatch( );
+
+            //! End a batch, edges of every node moved since the outermost beginBatch() are updated exactly once.
+            void			endBatch( );
+
+            //! Return true while a batch of node moves is in progress.
+            bool			isBatching( ) const { return _batchDepth > 0; }
+
+            //! Record a node moved while batching (called by node items).
+            void			addBatchNode( Node& node ) { _batchNodes.insert( &node ); }
+
+        protected:
+
+            int				_batchDepth;
+
+            Node::Set		_batchNodes;
+            //@}
+            //---------------------------------------------------------------------
+
+
+
+            /*! \name Deferred Edge Update Management *///------------------------
+            //@{
+        public:
+
+            //! Schedule an edge geometry update on next event loop iteration, an edge scheduled several times is updated once.
+            void			scheduleEdgeUpdate( Edge& edge );
+
+            //! Schedule a geometry update for every in and out edges of a node.
+            void			scheduleNodeEdgesUpdate( Node& node );
+
+        public slots:
+
+            //! Update every scheduled edge immediately.
+            void			flushEdgeUpdates( );
+
+        protected:
+
+            //! Edges whose geometry must be updated on next flush.
+            Edge::Set		_dirtyEdges;
+
+            bool			_edgeFlushPending;
+            //@}
+            //---------------------------------------------------------------------
+
+
+
+            /*! \name Dirty Rect Management *///---------------------------------
+            //@{
+        public:
+
+            //! Record a scene area where graph items content changed, dirty areas are published once per event loop iteration with contentChanged().
+            void			addDirtyRect( const QRectF& rect );
+
+        signals:
+
+            //! Emitted with the scene areas where graph items have been moved, updated, created or destroyed since last emission.
+            /*! Unlike QGraphicsScene::changed(), connecting to this signal does not disable views direct updates: it
+                is intended for caches of scene areas that are not currently on screen (see qan::TileCache).
+             */
+            void			contentChanged( const QList< QRectF >& rects );
+
+        protected slots:
+
+            void			flushDirtyRects( );
+
+        protected:
+
+            QList< QRectF >	_dirtyRects;
+
+            bool			_dirtyFlushPending;
+            //@}
+            //---------------------------------------------------------------------
+
+
+
+            /*! \name Virtualization Management *///------------------------------
+            //@{
+        public:
+
+            //! Enable the virtualized mode: graph items are created only for nodes close to the visible area.
+            /*! In virtualized mode, the scene keeps a lightweight rect record (position and last known size) for every
+                node in a spatial index. Node items are materialized for nodes inside the visible area expanded by the
+                virtualization margin, edge items are created once all their nodes are materialized. Nodes adjacent
+                to materialized nodes get a hidden item, so that edges leaving the area are drawn. Items leaving the
+                area are parked (hidden) and destroyed when more than getParkCapacity() items are parked, least
+                recently parked first.
+
+                Visible area is set by graph views with updateVirtualization(). Nodes without a graph item have no
+                graphics item (Node::getGraphicsItem() return 0), node groups are not supported in virtualized mode. */
+            void			setVirtualized( bool virtualized );
+
+            bool			isVirtualized( ) const { return _virtualized; }
+
+            //! Set the distance around the visible area where node items are materialized (default to 200.).
+            void			setVirtualizationMargin( qreal margin ) { _virtualMargin = margin; }
+
+            qreal			getVirtualizationMargin( ) const { return _virtualMargin; }
+
+            //! Set the maximum number of hidden node items kept for reuse when they leave the visible area (default to 500).
+            void			setParkCapacity( int parkCapacity ) { _parkCapacity = parkCapacity; }
+
+            int				getParkCapacity( ) const { return _parkCapacity; }
+
+            //! Materialize items for nodes in a visible area (in scene CS), and park items that are no longer in it.
+            void			updateVirtualization( QRectF visibleRect );
+
+        protected:
+
+            //! Register a node rect record in the virtualization index.
+            void			registerVirtualNode( Node& node );
+
+            //! Remove a node rect record from the virtualization index.
+            void			unregisterVirtualNode( Node& node );
+
+            //! Update a node rect record from its position and its item size.
+            void			updateVirtualNodeRect( Node& node );
+
+            //! Create or show a node item, and create its edges items whose nodes are all materialized.
+            void			materializeNode( Node& node );
+
+            //! Hide a node item and its edges items, node item is kept for reuse until it is evicted.
+            void			parkNode( Node& node );
+
+            //! Create or keep a hidden item for a node outside the visible area adjacent to a visible node.
+            void			materializeFarNode( Node& node );
+
+            //! Update visibility of node edges items, creating them when all their nodes are materialized.
+            void			updateVirtualEdges( Node& node );
+
+            //! Return true if every node of an edge has a graph item.
+            bool			canMaterialize( Edge& edge ) const;
+
+            //! Destroy a node graphics item, its edges items and its mapping.
+            void			destroyGraphItem( Node& node );
+
+            //! Destroy graphics items of a set of nodes, with their edges items (destroyed edges are added to edges).
+            void			destroyGraphItems( const Node::Set& nodes, Edge::Set& edges );
+
+            bool			_virtualized;
+
+            qreal			_virtualMargin;
+
+            int				_parkCapacity;
+
+            //! Last visible area set with updateVirtualization().
+            QRectF			_virtualArea;
+
+            //! Spatial index of nodes rect records.
+            RectIndex		_virtualIndex;
+
+            QHash< Node*, int >	_virtualIds;
+
+            QHash< int, Node* >	_virtualNodes;
+
+            int				_virtualNextId;
+
+            //! Nodes whose item is materialized and visible.
+            Node::Set		_visibleNodes;
+
+            //! Nodes whose item is hidden, least recently parked first.
+            Node::List		_parkedNodes;
+
+            //! Nodes outside the visible area whose hidden item is used to draw edges with visible nodes, never evicted.
+            Node::Set		_farNodes;
+            //@}
+            //---------------------------------------------------------------------
+
+
+
+            /*! \name Spatial Index Management *///------------------------------
+            //@{
+        public:
+
+            //! Scene item index policy (the index speeds up item queries, but has to be updated when items move).
+            enum IndexPolicy
+            {
+                //! Use a BSP tree index during interactive use, disable it while index is suspended (default).
+                IndexAutomatic,
+                //! Always use a BSP tree index.
+                IndexAlways,
+                //! Never use an index, item queries are linear.
+                IndexNever
+            };
+
+            //! Set the scene index policy and update the scene item index method accordingly.
+            void			setIndexPolicy( IndexPolicy indexPolicy );
+
+            IndexPolicy		getIndexPolicy( ) const { return _indexPolicy; }
+
+            //! Suspend the scene index during bulk modifications (item insertions, animations), calls can be nested.
+            void			suspendIndex( );
+
+            //! Resume the scene index suspended with suspendIndex(), the index is rebuilt when the outermost call resumes.
+            void			resumeIndex( );
+
+        protected:
+
+            //! Update the scene item index method according to the current policy and suspend state.
+            void			updateIndexMethod( );
+
+            //! Return true if modifying itemCount items is worth suspending the index: resuming the index rebuilds it over
+            //! every scene item, while small modifications update it incrementally.
+            bool			isBulkChange( int itemCount ) const;
+
+            IndexPolicy		_indexPolicy;
+
+            int				_indexSuspendCount;
             //@}
             //---------------------------------------------------------------------
 
@@ -149,6 +507,15 @@ namespace qan { // ::qan
 
             QList< qan::NodeGroup* >&	getNodeGroups( ) { return _nodeGroups; }
 
+            //! Release graph items of collapsed group nodes, their edges leaving the group are drawn to the group proxy (see NodeGroup::setCollapsed()).
+            void						collapseNodes( qan::NodeGroup& nodeGroup, const Node::Set& nodes );
+
+            //! Create graph items again for nodes of an expanded group, with their edges.
+            void						expandNodes( qan::NodeGroup& nodeGroup, const Node::Set& nodes );
+
+            //! Return the item edges of a node are drawn to: node graph item, or its group proxy item when the group is collapsed.
+            GraphItem*					getEndpointItem( qan::Node& node ) const;
+
         signals:
 
             void						nodeGroupAdded( qan::NodeGroup* nodeGroup );
@@ -158,6 +525,68 @@ namespace qan { // ::qan
         protected:
 
             QList< qan::NodeGroup* >	_nodeGroups;
+
+            //! Proxy items of collapsed groups nodes.
+            QHash< Node*, NodeGroupProxyItem* >	_collapsedNodes;
+            //@}
+            //---------------------------------------------------------------------
+
+
+
+            /*! \name Edge Bundle Management *///---------------------------------
+            //@{
+        public:
+
+            //! Enable edge bundles: edges between two distinct node groups are drawn as a single weighted bundle at low zoom.
+            /*! A bundle item is created for each pair of groups connected by at least one edge, and drawn instead of its
+                edges when the view level of detail is lower than getEdgeBundleThreshold() (see EdgeBundleItem). Bundles
+                are maintained incrementally when edges are inserted or removed and when group content changes. */
+            void			setEdgeBundlesEnabled( bool enabled );
+
+            bool			hasEdgeBundles( ) const { return _edgeBundlesEnabled; }
+
+            //! Set the level of detail under which bundles are drawn instead of their edges (default to 0.35).
+            void			setEdgeBundleThreshold( qreal threshold );
+
+            qreal			getEdgeBundleThreshold( ) const { return _edgeBundleThreshold; }
+
+            //! Return the bundle of edges between two groups (in any order), or 0 if the groups are not connected.
+            EdgeBundleItem*	getEdgeBundle( NodeGroup& src, NodeGroup& dst ) const;
+
+            //! Return true if an edge should not be drawn at a given level of detail since its bundle is drawn instead.
+            bool			isEdgeBundled( Edge& edge, qreal lod ) const;
+
+            //! Update geometry of every bundle connected to a group (called when the group is moved or resized).
+            void			updateEdgeBundles( NodeGroup& nodeGroup );
+
+            //! Update the bundles of a node edges after the node has been inserted in or removed from a group.
+            void			updateNodeEdgeBundles( Node& node );
+
+        protected:
+
+            //! Return the first group containing a given node, or 0.
+            NodeGroup*		getNodeGroup( Node& node ) const;
+
+            typedef QPair< NodeGroup*, NodeGroup* >	NodeGroupPair;
+
+            static NodeGroupPair	getNodeGroupPair( NodeGroup* src, NodeGroup* dst );
+
+            //! Insert an edge in the bundle of its nodes groups (bundle is created if necessary).
+            void			bundleEdge( Edge& edge );
+
+            //! Remove an edge from its bundle (bundle is destroyed when empty).
+            void			unbundleEdge( Edge& edge );
+
+            //! Destroy every bundle connected to a group, or every bundles when nodeGroup is 0.
+            void			clearEdgeBundles( NodeGroup* nodeGroup = 0 );
+
+            bool			_edgeBundlesEnabled;
+
+            qreal			_edgeBundleThreshold;
+
+            QHash< NodeGroupPair, EdgeBundleItem* >	_edgeBundles;
+
+            QHash< Edge*, EdgeBundleItem* >	_bundledEdges;
             //@}
             //---------------------------------------------------------------------
 
@@ -221,6 +650,9 @@ namespace qan { // ::qan
             NodeGraphItemMap	_nodeGraphItemMap;
 
             EdgeGraphItemMap	_edgeGraphItemMap;
+
+            //! Hyper edges having a graph item, hyper edges members are not referenced by their nodes (see destroyGraphItems()).
+            Edge::Set			_hyperEdgeItems;
             //---------------------------------------------------------------------
 
 
@@ -29,12 +29,22 @@
 // Qanava headers
 #include "./qanGraphView.h"
 #include "./qanGridItem.h"
+#include "./qanNodeItem.h"
+#include "./qanEdgeItem.h"
+#include "./qanEdgeLayer.h"
 
 
 // QT headers
 #include <QPen>
 #include <QMouseEvent>
 #include <QMimeData>
+#include <QTimer>
+#include <QPainterPath>
+#include <QStyleOptionGraphicsItem>
+#include <QElapsedTimer>
+#include <QPaintEvent>
+#include <QFontMetrics>
+#include <QStringList>
 
 
 //-----------------------------------------------------------------------------
@@ -46,7 +56,11 @@ GraphView::GraphView( QWidget* parent, QColor backColor, QSize size ) :
 	QGraphicsView( parent ),
 	_graph( 0 ),
 	_grid( 0 ),
-	_controllerManager( this )
+	_controllerManager( this ),
+	_virtualizationUpdatePending( false ),
+	_tileCache( 0 ),
+	_paintStatistics( 0 ),
+	_statisticsOverlayVisible( false )
 {
 	configureView( backColor, size );
 	setAcceptDrops( true );	// Accept file drop, and cast the dataDropped signal
@@ -74,9 +88,6 @@ void	GraphView::setGraph( Graph& graph )
 	_graph = &graph;
 	GraphScene& graphScene = graph.getM( );
 	
-	// FIXME v0.4.0
-	graphScene.setItemIndexMethod( QGraphicsScene::NoIndex );
-	
 	setCacheMode( CacheBackground );
     setViewportUpdateMode( BoundingRectViewportUpdate );
     setRenderHint( QPainter::Antialiasing );
@@ -84,6 +95,11 @@ void	GraphView::setGraph( Graph& graph )
 
 	graphScene.init( graph.getRootNodes( ) );
 	setScene( &graphScene );
+	if ( _tileCache != 0 )
+		_tileCache->setScene( &graphScene );
+	if ( _paintStatistics != 0 )
+		graphScene.setPaintStatistics( _paintStatistics );
+	scheduleVirtualizationUpdate( );
 }
 //-----------------------------------------------------------------------------
 
@@ -92,8 +108,17 @@ void	GraphView::setGraph( Graph& graph )
 /* Grid Management *///--------------------------------------------------------
 void	GraphView::drawBackground( QPainter* painter, const QRectF& rect )
 {
+	QElapsedTimer timer;
+	if ( _paintStatistics != 0 )
+		timer.start( );
 	if ( _grid != 0 )
 		_grid->drawBackground( *painter, rect );
+	if ( _paintStatistics != 0 )
+		_paintStatistics->addBackgroundTime( timer.nsecsElapsed( ) / 1000000. );
+
+	// QGraphicsView::scale() and setTransform() are not virtual: a zoom is detected when the background is redrawn
+	if ( _graph != 0 && getGraphScene( )->isVirtualized( ) && mapToScene( viewport( )->rect( ) ).boundingRect( ) != _virtualizationRect )
+		scheduleVirtualizationUpdate( );
 }
 //-----------------------------------------------------------------------------
 
@@ -175,6 +200,7 @@ void	GraphView::wheelEvent( QWheelEvent* e )
 void	GraphView::resizeEvent ( QResizeEvent* e )
 {
 	QGraphicsView::resizeEvent( e );
+	scheduleVirtualizationUpdate( );
 
 	emit viewResized( e->size( ) );
 }
@@ -264,6 +290,269 @@ void	GraphView::dropEvent( QDropEvent* e )
 //---------------------------------------------------------------------
 
 
+/* Virtualization Management *///---------------------------------------------
+void	GraphView::updateVirtualization( )
+{
+	_virtualizationUpdatePending = false;
+	if ( _graph == 0 || !getGraphScene( )->isVirtualized( ) )
+		return;
+	_virtualizationRect = mapToScene( viewport( )->rect( ) ).boundingRect( );
+	getGraphScene( )->updateVirtualization( _virtualizationRect );
+}
+
+void	GraphView::scheduleVirtualizationUpdate( )
+{
+	if ( _virtualizationUpdatePending || _graph == 0 || !getGraphScene( )->isVirtualized( ) )
+		return;
+	_virtualizationUpdatePending = true;
+	QTimer::singleShot( 0, this, SLOT( updateVirtualization( ) ) );
+}
+
+void	GraphView::scrollContentsBy( int dx, int dy )
+{
+	if ( _tileCache != 0 )
+	{
+		QRegion viewportRegion( viewport( )->rect( ) );
+		_tileExposedRegion.translate( dx, dy );
+		_tileExposedRegion += viewportRegion.subtracted( viewportRegion.translated( dx, dy ) );
+	}
+	QGraphicsView::scrollContentsBy( dx, dy );
+	scheduleVirtualizationUpdate( );
+}
+//-----------------------------------------------------------------------------
+
+
+/* Tile Cache Management *///-------------------------------------------------
+void	GraphView::setTileCacheEnabled( bool enabled )
+{
+	if ( enabled == isTileCacheEnabled( ) )
+		return;
+	if ( enabled )
+		_tileCache = new TileCache( *this );
+	else
+	{
+		delete _tileCache;
+		_tileCache = 0;
+	}
+	setOptimizationFlag( IndirectPainting, enabled || _paintStatistics != 0 );	// Items are drawn with drawItems()
+	viewport( )->update( );
+}
+
+void	GraphView::drawItems( QPainter* painter, int numItems, QGraphicsItem* items[], const QStyleOptionGraphicsItem options[] )
+{
+	if ( _tileCache == 0 || transform( ).type( ) > QTransform::TxScale )
+	{
+		countPaintedItems( numItems, items );
+		QGraphicsView::drawItems( painter, numItems, items, options );
+		return;
+	}
+
+	QVector< QRectF > liveRects;
+	_tileCache->draw( *painter, mapToScene( viewport( )->rect( ) ).boundingRect( ), transform( ).m11( ), liveRects );
+	if ( liveRects.isEmpty( ) )
+		return;
+
+	// Draw items intersecting live tiles, clipped to live tiles so that cached content is not painted twice
+	QRectF liveBr;
+	QPainterPath liveClip;
+	foreach ( const QRectF& liveRect, liveRects )
+	{
+		liveBr |= liveRect;
+		liveClip.addRect( liveRect );
+	}
+	QVector< QGraphicsItem* > liveItems;
+	QVector< QStyleOptionGraphicsItem > liveOptions;
+	for ( int i = 0; i < numItems; i++ )
+	{
+		QRectF itemBr = items[ i ]->sceneBoundingRect( );
+		if ( !itemBr.intersects( liveBr ) )
+			continue;
+		foreach ( const QRectF& liveRect, liveRects )
+			if ( itemBr.intersects( liveRect ) )
+			{
+				liveItems.append( items[ i ] );
+				liveOptions.append( options[ i ] );
+				break;
+			}
+	}
+	if ( liveItems.isEmpty( ) )
+		return;
+	countPaintedItems( liveItems.size( ), liveItems.data( ) );
+	painter->save( );
+	painter->setClipPath( liveClip, Qt::IntersectClip );
+	QGraphicsView::drawItems( painter, liveItems.size( ), liveItems.data( ), liveOptions.constData( ) );
+	painter->restore( );
+}
+
+/*!	Scene items send their updates directly to the views, repainted regions are the only dirty rects available
+	without connecting QGraphicsScene::changed() (that would disable direct updates for every view of the scene).
+ */
+void	GraphView::invalidateTiles( const QRegion& region )
+{
+	QRegion dirtyRegion = region;
+	if ( transform( ) != _tileTransform || viewport( )->size( ) != _tileViewportSize )
+		dirtyRegion = QRegion( );	// Whole viewport exposed by a zoom or a resize
+	else
+		dirtyRegion -= _tileExposedRegion;
+	if ( _statisticsOverlayVisible )
+		dirtyRegion -= getStatisticsOverlayRect( );
+	_tileTransform = transform( );
+	_tileViewportSize = viewport( )->size( );
+	_tileExposedRegion = QRegion( );
+	if ( dirtyRegion.isEmpty( ) )
+		return;
+
+	QList< QRectF > rects;
+	foreach ( const QRect& rect, dirtyRegion.rects( ) )
+		rects << mapToScene( rect.adjusted( -1, -1, 1, 1 ) ).boundingRect( );	// Antialiasing margin
+	_tileCache->invalidate( rects );
+}
+//-----------------------------------------------------------------------------
+
+
+/* Paint Statistics Management *///-------------------------------------------
+void	GraphView::setPaintStatisticsEnabled( bool enabled )
+{
+	if ( enabled == isPaintStatisticsEnabled( ) )
+		return;
+	if ( enabled )
+		_paintStatistics = new PaintStatistics( );
+	else
+	{
+		setStatisticsOverlayVisible( false );
+		if ( _graph != 0 && getGraphScene( )->getPaintStatistics( ) == _paintStatistics )
+			getGraphScene( )->setPaintStatistics( 0 );
+		delete _paintStatistics;
+		_paintStatistics = 0;
+	}
+	if ( _graph != 0 && _paintStatistics != 0 )
+		getGraphScene( )->setPaintStatistics( _paintStatistics );
+	setOptimizationFlag( IndirectPainting, _tileCache != 0 || _paintStatistics != 0 );
+}
+
+void	GraphView::setStatisticsOverlayVisible( bool visible )
+{
+	_statisticsOverlayVisible = visible && _paintStatistics != 0;
+	if ( _statisticsOverlayVisible )
+	{
+		connect( &_statisticsOverlayTimer, SIGNAL( timeout( ) ), this, SLOT( updateStatisticsOverlay( ) ), Qt::UniqueConnection );
+		_statisticsOverlayTimer.start( 250 );
+	}
+	else
+		_statisticsOverlayTimer.stop( );
+	viewport( )->update( );
+}
+
+void	GraphView::updateStatisticsOverlay( )
+{
+	viewport( )->update( getStatisticsOverlayRect( ) );
+}
+
+/*!	Tiles under repainted regions are invalidated before items are drawn. Repaints of the overlay only are not
+	counted as frames.
+ */
+void	GraphView::paintEvent( QPaintEvent* e )
+{
+	if ( _tileCache != 0 )
+		invalidateTiles( e->region( ) );
+	if ( _paintStatistics == 0 )
+	{
+		QGraphicsView::paintEvent( e );
+		return;
+	}
+
+	bool overlayOnly = _statisticsOverlayVisible && getStatisticsOverlayRect( ).contains( e->rect( ) );
+	QElapsedTimer timer;
+	timer.start( );
+	if ( !overlayOnly )
+	{
+		qint64 exposedArea = 0;
+		foreach ( const QRect& rect, e->region( ).rects( ) )
+			exposedArea += ( qint64 )rect.width( ) * rect.height( );
+		_paintStatistics->beginFrame( exposedArea );
+	}
+	QGraphicsView::paintEvent( e );
+	if ( !overlayOnly )
+		_paintStatistics->endFrame( timer.nsecsElapsed( ) / 1000000. );
+
+	if ( _statisticsOverlayVisible )
+	{
+		QPainter painter( viewport( ) );
+		drawStatisticsOverlay( painter );
+	}
+}
+
+void	GraphView::countPaintedItems( int numItems, QGraphicsItem* items[] )
+{
+	if ( _paintStatistics == 0 )
+		return;
+	for ( int i = 0; i < numItems; i++ )
+		_paintStatistics->addPaintedItems( items[ i ]->type( ), 1 );
+}
+
+static QString	getItemTypeName( int type )
+{
+	switch ( type )
+	{
+	case NodeItem::Type:		return "Nodes";
+	case EdgeItem::Type:		return "Edges";
+	case LabelEditorItem::Type:	return "Labels";
+	case EdgeLayer::Type:		return "Edge layer";
+	default:					break;
+	}
+	return QString( "Type %1" ).arg( type );
+}
+
+void	GraphView::drawStatisticsOverlay( QPainter& painter )
+{
+	const PaintStatistics& statistics = *_paintStatistics;
+	QRect overlayRect = getStatisticsOverlayRect( );
+	painter.setRenderHint( QPainter::Antialiasing, false );
+	painter.fillRect( overlayRect, QColor( 255, 255, 255, 210 ) );
+	painter.setPen( QColor( 40, 40, 40 ) );
+	painter.drawRect( overlayRect.adjusted( 0, 0, -1, -1 ) );
+
+	QStringList lines;
+	lines << QString( "Frame: %1 ms (mean %2, max %3)" ).arg( statistics.getLastFrameTime( ), 0, 'f', 1 )
+										.arg( statistics.getMeanFrameTime( ), 0, 'f', 1 ).arg( statistics.getMaxFrameTime( ), 0, 'f', 1 );
+	lines << QString( "Background: %1 ms" ).arg( statistics.getLastBackgroundTime( ), 0, 'f', 2 );
+	qint64 viewportArea = qMax( ( qint64 )1, ( qint64 )viewport( )->width( ) * viewport( )->height( ) );
+	lines << QString( "Exposed: %1 px (%2%)" ).arg( statistics.getLastExposedArea( ) )
+										.arg( 100. * statistics.getLastExposedArea( ) / viewportArea, 0, 'f', 0 );
+	lines << QString( "Edge updates: %1" ).arg( statistics.getLastEdgeUpdateCount( ) );
+	lines << QString( "Painted items: %1" ).arg( statistics.getLastPaintedItemCount( ) );
+	QMap< int, int >::const_iterator paintedItems = statistics.getLastPaintedItems( ).constBegin( );
+	for ( ; paintedItems != statistics.getLastPaintedItems( ).constEnd( ) && lines.size( ) < 10; ++paintedItems )
+		lines << QString( "    %1: %2" ).arg( getItemTypeName( paintedItems.key( ) ) ).arg( paintedItems.value( ) );
+
+	QFontMetrics metrics( painter.font( ) );
+	int y = overlayRect.top( ) + 4;
+	foreach ( const QString& line, lines )
+	{
+		painter.drawText( QPoint( overlayRect.left( ) + 6, y + metrics.ascent( ) ), line );
+		y += metrics.height( );
+	}
+
+	// Frame time histogram, bars are normalized by the most populated bucket
+	const QVector< int >& histogram = statistics.getFrameTimeHistogram( );
+	QVector< qreal > bounds = PaintStatistics::getHistogramBounds( );
+	int maxCount = 1;
+	foreach ( int count, histogram )
+		maxCount = qMax( maxCount, count );
+	QRect histogramRect( overlayRect.left( ) + 6, overlayRect.bottom( ) - 60, overlayRect.width( ) - 12, 40 );
+	int barWidth = histogramRect.width( ) / histogram.size( );
+	for ( int b = 0; b < histogram.size( ); b++ )
+	{
+		int barHeight = histogramRect.height( ) * histogram[ b ] / maxCount;
+		QRect bar( histogramRect.left( ) + b * barWidth, histogramRect.bottom( ) - barHeight, barWidth - 2, barHeight );
+		painter.fillRect( bar, b < 3 ? QColor( 80, 160, 80 ) : QColor( 200, 80, 60 ) );	// Frames slower than 60 fps are red
+		QString label = ( b < bounds.size( ) ? QString( "<%1" ).arg( bounds[ b ], 0, 'f', 0 ) : QString( ">%1" ).arg( bounds.last( ), 0, 'f', 0 ) );
+		painter.drawText( QRect( bar.left( ), histogramRect.bottom( ) + 2, barWidth, metrics.height( ) ), Qt::AlignHCenter, label );
+	}
+}
+//-----------------------------------------------------------------------------
+
+
 } // ::qan
 
 
@@ -36,6 +36,8 @@
 #include "./qanGraph.h"
 #include "./qanGrid.h"
 #include "./qanGridItem.h"
+#include "./qanTileCache.h"
+#include "./qanPaintStatistics.h"
 
 // QT headers
 #include <QGraphicsScene>
@@ -45,6 +47,7 @@
 #include <QDragLeaveEvent>
 #include <QDropEvent>
 #include <QDragEnterEvent>
+#include <QTimer>
 
 
 //-----------------------------------------------------------------------------
@@ -64,6 +67,8 @@ namespace qan { // ::qan
 
 		GraphView( QWidget* parent = 0, QColor backColor = QColor( 170, 171, 205 ), QSize size = QSize( 300, 150 ) );
 
+		virtual ~GraphView( ) { setPaintStatisticsEnabled( false ); }
+
 		virtual QSize	sizeHint( ) const { return QSize( 300, 250 ); }
 
 		void			setGraph( Graph& graph );
@@ -161,6 +166,120 @@ namespace qan { // ::qan
 		void			dataDropped( QString data );
 		//@}
 		//---------------------------------------------------------------------
+
+
+
+		/*! \name Virtualization Management *///------------------------------
+		//@{
+	public slots:
+
+		//! Set the graph scene visible area to this view viewport when the scene is virtualized (see GraphScene::setVirtualized()).
+		void			updateVirtualization( );
+
+	protected:
+
+		//! Update the scene visible area once control returns to the event loop, multiple calls are coalesced.
+		void			scheduleVirtualizationUpdate( );
+
+		virtual void	scrollContentsBy( int dx, int dy );
+
+	private:
+
+		bool			_virtualizationUpdatePending;
+
+		//! Visible scene rect of the last virtualization update.
+		QRectF			_virtualizationRect;
+		//@}
+		//---------------------------------------------------------------------
+
+
+
+		/*! \name Tile Cache Management *///----------------------------------
+		//@{
+	public:
+
+		//! Draw static scene content from a cache of tiles rasterized on worker threads (see qan::TileCache).
+		/*! Only items under tiles that are not cached yet (or that have been invalidated recently, usually by an
+			item being edited or animated) are painted live. Tile cache is not used when view is rotated or sheared.
+
+			Tiles are invalidated with the areas of graph items changes published by the graph scene, on screen or not,
+			and with the viewport regions repainted by the view, except regions exposed by a scroll, a zoom or a
+			resize: with FullViewportUpdate mode (or a viewport that can't scroll its content), every visible tile
+			is invalidated at each repaint. */
+		void			setTileCacheEnabled( bool enabled );
+
+		bool			isTileCacheEnabled( ) const { return _tileCache != 0; }
+
+		//! Return this view tile cache, or 0 if tile cache is disabled.
+		TileCache*		getTileCache( ) { return _tileCache; }
+
+	protected:
+
+		virtual void	drawItems( QPainter* painter, int numItems, QGraphicsItem* items[], const QStyleOptionGraphicsItem options[] );
+
+		//! Invalidate tiles under a repainted viewport region, ignoring regions exposed since last repaint.
+		void			invalidateTiles( const QRegion& region );
+
+	private:
+
+		TileCache*		_tileCache;
+
+		//! Viewport regions exposed by scrolling since last repaint, their content is already cached.
+		QRegion			_tileExposedRegion;
+
+		//! View transform at last repaint, the whole viewport is exposed when it changes.
+		QTransform		_tileTransform;
+
+		QSize			_tileViewportSize;
+		//@}
+		//---------------------------------------------------------------------
+
+
+
+		/*! \name Paint Statistics Management *///-----------------------------
+		//@{
+	public:
+
+		//! Collect frame time and paint counters for this view and its scene (see qan::PaintStatistics).
+		/*! Statistics are collected with indirect painting enabled (see QGraphicsView::IndirectPainting), so that painted
+			items can be counted. When several views share a scene, edge updates are reported to the last enabled view. */
+		void				setPaintStatisticsEnabled( bool enabled );
+
+		bool				isPaintStatisticsEnabled( ) const { return _paintStatistics != 0; }
+
+		//! Return this view statistics, or 0 if statistics are disabled.
+		PaintStatistics*	getPaintStatistics( ) { return _paintStatistics; }
+
+		//! Show statistics in an overlay drawn over the top left corner of the view (statistics must be enabled).
+		void				setStatisticsOverlayVisible( bool visible );
+
+		bool				isStatisticsOverlayVisible( ) const { return _statisticsOverlayVisible; }
+
+	protected:
+
+		virtual void		paintEvent( QPaintEvent* e );
+
+		//! Draw the statistics overlay in viewport CS.
+		void				drawStatisticsOverlay( QPainter& painter );
+
+		QRect				getStatisticsOverlayRect( ) const { return QRect( 8, 8, 230, 250 ); }
+
+		//! Count items painted in current frame.
+		void				countPaintedItems( int numItems, QGraphicsItem* items[] );
+
+	protected slots:
+
+		void				updateStatisticsOverlay( );
+
+	private:
+
+		PaintStatistics*	_paintStatistics;
+
+		bool				_statisticsOverlayVisible;
+
+		QTimer				_statisticsOverlayTimer;
+		//@}
+		//---------------------------------------------------------------------
 	};
 } // ::qan
 //-----------------------------------------------------------------------------
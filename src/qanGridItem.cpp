@@ -34,6 +34,7 @@
 #include <QPen>
 #include <QPainter>
 #include <QGraphicsLineItem>
+#include <QtMath>
 
 
 namespace qan {  // ::qan
@@ -106,14 +107,72 @@ void	GridItem::addVerticalLine( QLineF l, int w, bool dash, bool dot )
 
 
 /* Regular Grid Management  *///-----------------------------------------------
-GridRegularItem::GridRegularItem( GraphView* GraphView, int spacing ) : 
+GridRegularItem::GridRegularItem( GraphView* GraphView, int spacing, int majorPeriod, QColor minorColor, QColor majorColor ) :
 	GridItem( GraphView ), 
-	_spacing( spacing ),
-	_sizeMax( 0, 0 ), 
-	_gradCount( 0, 0 )
+	_spacing( qMax( 1, spacing ) ),
+	_majorPeriod( qMax( 2, majorPeriod ) ),
+	_minorColor( minorColor ),
+	_majorColor( majorColor ),
+	_minimumLineDistance( 8. )
 {
 
 }
+
+/*!	Background is drawn tile per tile: lines batch of the current level is translated to each tile intersecting
+	the exposed rect, so that no line is computed while the view is panned or zoomed.
+ */
+void	GridRegularItem::drawBackground( QPainter& painter, const QRectF& rect )
+{
+	const QTransform worldTransform = painter.worldTransform( );
+	qreal scale = qSqrt( worldTransform.m11( ) * worldTransform.m11( ) + worldTransform.m12( ) * worldTransform.m12( ) );
+	const LineBatch& lineBatch = getLineBatch( getLevel( scale ) );
+	qreal tileSize = lineBatch.tileSize;
+
+	QPen minorPen( _minorColor, 0. );	// Cosmetic pens, lines width do not depend on zoom
+	QPen majorPen( _majorColor, 0. );
+	painter.save( );
+	painter.setRenderHint( QPainter::Antialiasing, false );
+	for ( int y = qFloor( rect.top( ) / tileSize ); y <= qFloor( rect.bottom( ) / tileSize ); y++ )
+		for ( int x = qFloor( rect.left( ) / tileSize ); x <= qFloor( rect.right( ) / tileSize ); x++ )
+		{
+			painter.setWorldTransform( QTransform::fromTranslate( x * tileSize, y * tileSize ) * worldTransform );
+			painter.setPen( minorPen );
+			painter.drawLines( lineBatch.minorLines );
+			painter.setPen( majorPen );
+			painter.drawLines( lineBatch.majorLines );
+		}
+	painter.restore( );
+}
+
+int		GridRegularItem::getLevel( qreal scale ) const
+{
+	// Smallest level whose minor lines are at least the minimum line distance apart on screen
+	qreal distance = _spacing * qMax( scale, 0.0001 );
+	return qMax( 0, qCeil( qLn( _minimumLineDistance / distance ) / qLn( ( qreal )_majorPeriod ) ) );
+}
+
+const GridRegularItem::LineBatch&	GridRegularItem::getLineBatch( int level )
+{
+	QMap< int, LineBatch >::const_iterator cachedBatch = _lineBatches.constFind( level );
+	if ( cachedBatch != _lineBatches.constEnd( ) )
+		return cachedBatch.value( );
+
+	// A tile contains majorPeriod major cells, lines on the tile right and bottom borders belong to next tiles
+	qreal spacing = _spacing * qPow( ( qreal )_majorPeriod, level );
+	int lineCount = _majorPeriod * _majorPeriod;
+	LineBatch lineBatch;
+	lineBatch.tileSize = spacing * lineCount;
+	lineBatch.minorLines.reserve( 2 * lineCount );
+	lineBatch.majorLines.reserve( 2 * _majorPeriod );
+	for ( int l = 0; l < lineCount; l++ )
+	{
+		qreal p = l * spacing;
+		QVector< QLineF >& lines = ( l % _majorPeriod == 0 ? lineBatch.majorLines : lineBatch.minorLines );
+		lines << QLineF( p, 0., p, lineBatch.tileSize );
+		lines << QLineF( 0., p, lineBatch.tileSize, p );
+	}
+	return _lineBatches.insert( level, lineBatch ).value( );
+}
 //-----------------------------------------------------------------------------
 
 
@@ -139,18 +198,14 @@ void	GridCheckBoardItem::drawBackground( QPainter& painter, const QRectF& rect )
 {
 	GridItem::drawBackground( painter, rect );
 
-	int left	= ( int )rect.left( );
-	int top		= ( int )rect.top( );
-	int x = ( ( left / 100 ) * 100 );
-	int y = ( ( top / 100 ) * 100 );
-
-	if ( left < 0 )
-		x = x - 100;
-	if ( top < 0 )
-		y = y - 100;
+	if ( _squaresPattern.isNull( ) )
+		return;
 
-	if ( !_squaresPattern.isNull( ) )
-		painter.drawTiledPixmap( x, y, rect.width( ) + 100, rect.height( ) + 100, _squaresPattern );
+	// Align tiling on the pattern period, so that squares do not move when an exposed area is drawn
+	qreal period = _squaresPattern.width( );
+	qreal x = qFloor( rect.left( ) / period ) * period;
+	qreal y = qFloor( rect.top( ) / period ) * period;
+	painter.drawTiledPixmap( QRectF( x, y, rect.right( ) - x + period, rect.bottom( ) - y + period ), _squaresPattern );
 }
 //-----------------------------------------------------------------------------
 
@@ -38,6 +38,9 @@
 // QT headers
 #include <QGraphicsScene>
 #include <QGraphicsItem>
+#include <QVector>
+#include <QMap>
+#include <QLineF>
 
 
 //-----------------------------------------------------------------------------
@@ -107,10 +110,15 @@ namespace qan { // ::qan
 
 
 
-	//! Regular grid draws a square pattern of horizontal and vertical dotted lines (ie a standard grid!).
+	//! Regular grid draws a square pattern of horizontal and vertical minor and major lines (ie a standard grid!).
 	/*!
 		<img src="./images/regulargridshot.png" alt="Qanava regular grid">
-		
+
+		Lines spacing adapts to the view zoom: at a given level, minor lines spacing is the grid spacing multiplied by
+		a power of the major lines period, so that minor lines are never closer than getMinimumLineDistance() pixels.
+		Lines of a level are computed once for a square tile and drawn with a single QPainter::drawLines() call
+		per tile and line kind. With the GraphView background cache, panning only draws newly exposed tiles.
+
 		\nosubgrouping
 	*/
 	class GridRegularItem : public GridItem
@@ -120,17 +128,48 @@ namespace qan { // ::qan
 	public:
 
 		//! GridRegularItem constructor with grid line spacing initialization.
-		GridRegularItem( GraphView* GraphView, int spacing = 60 );
+		/*! \param	majorPeriod		Number of minor lines spacing between two major lines. */
+		GridRegularItem( GraphView* GraphView, int spacing = 60, int majorPeriod = 5,
+						 QColor minorColor = QColor( 0, 0, 0, 25 ), QColor majorColor = QColor( 0, 0, 0, 60 ) );
 
 		virtual ~GridRegularItem( ) { }
 
+		virtual	void	drawBackground( QPainter& painter, const QRectF& rect );
+
+		//! Minimum distance between two minor lines on screen (in pixels), default to 8.
+		void			setMinimumLineDistance( qreal minimumLineDistance ) { _minimumLineDistance = qMax( 1., minimumLineDistance ); }
+
+		qreal			getMinimumLineDistance( ) const { return _minimumLineDistance; }
+
+	protected:
+
+		//! Lines of a zoom level for a square tile whose origin is (0, 0).
+		struct LineBatch
+		{
+			qreal				tileSize;
+			QVector< QLineF >	minorLines;
+			QVector< QLineF >	majorLines;
+		};
+
+		//! Return the zoom level for a view scale.
+		int					getLevel( qreal scale ) const;
+
+		//! Return lines for a zoom level, lines are computed on first call.
+		const LineBatch&	getLineBatch( int level );
+
 	private:
 
 		int		_spacing;
 
-		QSize	_sizeMax;
+		int		_majorPeriod;
+
+		QColor	_minorColor;
+
+		QColor	_majorColor;
+
+		qreal	_minimumLineDistance;
 
-		QPoint	_gradCount;
+		QMap< int, LineBatch >	_lineBatches;
 		//@}
 		//---------------------------------------------------------------------
 	};
@@ -27,6 +27,7 @@
 
 // Qt headers
 #include <QtMath>
+#include <QThread>
 
 // Qanava headers
 #include "./qanLayout.h"
@@ -35,6 +36,33 @@
 
 namespace qan { // ::qan
 
+
+/* Layout Generation Management *///-------------------------------------------
+/*!	On worker threads, nodes size is read from their dimension: see snapshotNodeSizes().
+ */
+QSizeF	Layout::getNodeSize( Node& node )
+{
+	if ( hasLocalItem( node ) )
+		return node.getGraphItem( )->getSceneContentRect( ).size( );
+	return QSizeF( node.getDimension( ).x( ), node.getDimension( ).y( ) );
+}
+
+void	Layout::snapshotNodeSizes( const Node::Set& nodes )
+{
+	foreach ( Node* node, nodes )
+		if ( hasLocalItem( *node ) )
+		{
+			QSizeF size = node->getGraphItem( )->getSceneContentRect( ).size( );
+			node->setDimension( QPointF( size.width( ), size.height( ) ) );
+		}
+}
+
+bool	Layout::hasLocalItem( Node& node )
+{
+	return node.getGraphItem( ) != 0 && node.getGraphItem( )->thread( ) == QThread::currentThread( );
+}
+//-----------------------------------------------------------------------------
+
 /* Random Layout Generation Management *///------------------------------------
 void	Random::layout( qan::Node::List& rootNodes, qan::Node::Set& nodes, QRectF br, qan::Node* center, QProgressDialog* progress )
 {
@@ -54,10 +82,14 @@ void	Random::layout( qan::Node::Set& nodes, QRectF br, qan::Node* center, QProgr
 	foreach ( Node* node, nodes )
 	{
 		// Compute a global bounding rect in scene CS for node item and its direct childs (usually the properties widget and a shadow)
-		QRectF nodeBr = node->getGraphicsItem( )->sceneBoundingRect( );
-		QList< QGraphicsItem* > nodeChilds = node->getGraphicsItem( )->childItems( );
-		foreach ( QGraphicsItem* nodeChild, nodeChilds )
-			nodeBr = nodeBr.united( nodeChild->sceneBoundingRect( ) );
+		QRectF nodeBr( node->getPosition( ), getNodeSize( *node ) );	// Node item is not materialized in a virtualized scene, or layout runs on a worker thread
+		if ( hasLocalItem( *node ) )
+		{
+			nodeBr = node->getGraphicsItem( )->sceneBoundingRect( );
+			QList< QGraphicsItem* > nodeChilds = node->getGraphicsItem( )->childItems( );
+			foreach ( QGraphicsItem* nodeChild, nodeChilds )
+				nodeBr = nodeBr.united( nodeChild->sceneBoundingRect( ) );
+		}
 
 		// Generate coordinate inside the scene rect so that node bounding boxe is not outside scene rect after moving
 		qreal rx = qMin( ( ( qrand( ) % 1000 ) / 1000.0 ), 0.999 );
@@ -100,9 +132,11 @@ void	UndirectedGraph::layout( qan::Node::Set& groupRootNodes, qan::Node::Set& no
 
 	// Apply the spring force algorithm
     qreal minimumModification = 5. * nodes.size( );
+	_iterationCount = 0;
 	for ( int iter = 0; iter < runCount; iter++ )
 	{
         qreal modification = 0.;
+		_iterationCount++;
 
 		// Compute new nodes positions using the spring embedder model
 		foreach ( Node* node, nodes )
@@ -56,7 +56,7 @@ namespace qan { // ::qan
 		/*! \name Layout Constructor/Destructor *///---------------------------
 		//@{
 		//! Layout constructor.
-        Layout( ) : QObject( ) { }
+        Layout( ) : QObject( ), _iterationCount( 0 ) { }
 
         //! Layout virtual destructor.
 		virtual ~Layout( ) { }
@@ -74,8 +74,52 @@ namespace qan { // ::qan
 
 		//! Layout nodes from a given group, report progress in an optional progress bar.
 		virtual void	layout( qan::Node::List& rootNodes, qan::Node::Set& nodes, QRectF br, qan::Node* center, QProgressDialog* progress = 0 ) = 0;
+
+		//! Get a textual description of this layout and its parameters (used to key cached layouts, see qan::LayoutCache).
+		virtual QString	getParameters( ) const { return QString( metaObject( )->className( ) ); }
+
+		//! Get a node size in scene CS from its graphics item, or from its dimension if the node has no graphics item or when called from a worker thread.
+		static QSizeF	getNodeSize( Node& node );
+
+		//! Copy nodes graphics items sizes to their dimension, must be called on the GUI thread before running layouts on worker threads.
+		static void		snapshotNodeSizes( const Node::Set& nodes );
+
+		//! Get the number of iterations used by the last layout to converge (0 for non iterative layouts).
+		int				getIterationCount( ) const { return _iterationCount; }
+
+	protected:
+
+		//! Return true if a node has a graphics item that can be accessed from the calling thread (graphics items are not thread safe).
+		static bool		hasLocalItem( Node& node );
+
+		int				_iterationCount;
 		//@}
 		//---------------------------------------------------------------------
+
+	public:
+
+		//! Virtual factory used to create layout instances (when a layout must be run concurrently on several node sets).
+		class Factory
+		{
+		public:
+
+			Factory( ) { }
+
+			virtual ~Factory( ) { }
+
+			//! Create a new layout, ownership goes to the caller.
+			virtual Layout*	create( ) = 0;
+		};
+	};
+
+
+	//! Layout factory for layout classes with a default constructor.
+	template < class L >
+	class LayoutFactory : public Layout::Factory
+	{
+	public:
+
+		virtual Layout*	create( ) { return new L( ); }
 	};
 
 
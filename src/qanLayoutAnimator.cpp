@@ -0,0 +1,154 @@
+/*
+	Copyright (C) 2008-2015 Benoit AUTHEMAN
+
+    This file is part of Qanava.
+
+    Qanava is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Qanava is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with Qanava.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//-----------------------------------------------------------------------------
+// This file is a part of the Qanava software.
+//
+// \file	qanLayoutAnimator.cpp
+// \author	benoit@qanava.org
+// \date	2015 October 21
+//-----------------------------------------------------------------------------
+
+// Qt headers
+#include <QGraphicsItem>
+
+// Qanava headers
+#include "./qanLayoutAnimator.h"
+#include "./qanGraphScene.h"
+#include "./qanNodeGroup.h"
+
+
+namespace qan { // ::qan
+
+
+/* LayoutAnimator Constructor/Destructor *///----------------------------------
+LayoutAnimator::LayoutAnimator( GraphScene& scene, int frameCount, int frameInterval ) :
+	QObject( 0 ),
+	_scene( scene ),
+	_frameCount( qMax( 1, frameCount ) ),
+	_frame( 0 )
+{
+	_timer.setInterval( frameInterval );
+	connect( &_timer, SIGNAL( timeout( ) ), this, SLOT( frame( ) ) );
+}
+//-----------------------------------------------------------------------------
+
+
+
+/* Animation Management *///---------------------------------------------------
+void	LayoutAnimator::animate( const Node::List& nodes )
+{
+	// Restart a running animation from the current item positions
+	if ( isRunning( ) )
+	{
+		for ( int n = 0; n < _nodes.size( ); n++ )
+			if ( _nodes[ n ]->getGraphicsItem( ) != 0 )
+				_from[ n ] = _nodes[ n ]->getGraphicsItem( )->pos( );
+	}
+	else
+	{
+		_nodes.clear( );
+		_nodeIndexes.clear( );
+		_from.clear( );
+		_to.clear( );
+	}
+	addNodes( nodes );
+	_frame = 0;
+	if ( !isRunning( ) && ( !_nodes.isEmpty( ) || !_groups.isEmpty( ) ) )
+	{
+		_scene.suspendIndex( );	// Moving items would update the index at every frame
+		_timer.start( );
+	}
+}
+
+void	LayoutAnimator::animate( NodeGroup& group )
+{
+	if ( !_groups.contains( &group ) )
+		_groups << &group;
+	animate( group.getNodes( ).toList( ) );
+}
+
+void	LayoutAnimator::stop( )
+{
+	if ( !isRunning( ) )
+		return;
+	_timer.stop( );
+	applyFrame( 1. );
+	_scene.resumeIndex( );
+
+	// Node groups are updated once their content is in place
+	foreach ( NodeGroup* group, _groups )
+		group->updateContent( );
+	_groups.clear( );
+	_nodes.clear( );
+	_nodeIndexes.clear( );
+	_from.clear( );
+	_to.clear( );
+	emit finished( );
+}
+
+void	LayoutAnimator::frame( )
+{
+	if ( ++_frame >= _frameCount )
+	{
+		stop( );
+		return;
+	}
+	qreal t = _frame / ( qreal )_frameCount;
+	applyFrame( t * t * ( 3. - 2. * t ) );	// Smoothstep easing
+}
+
+void	LayoutAnimator::addNodes( const Node::List& nodes )
+{
+	_nodes.reserve( _nodes.size( ) + nodes.size( ) );
+	foreach ( Node* node, nodes )
+	{
+		QGraphicsItem* item = node->getGraphicsItem( );
+		if ( item == 0 )
+			continue;
+		int n = _nodeIndexes.value( node, -1 );
+		if ( n >= 0 )
+		{
+			_to[ n ] = node->getPosition( );
+			continue;
+		}
+		_nodeIndexes.insert( node, _nodes.size( ) );
+		_nodes << node;
+		_from << item->pos( );
+		_to << node->getPosition( );
+	}
+}
+
+void	LayoutAnimator::applyFrame( qreal t )
+{
+	// Item position changes also modify nodes position, but targets are kept in _to
+	_scene.beginBatch( );
+	for ( int n = 0; n < _nodes.size( ); n++ )
+	{
+		QGraphicsItem* item = _nodes[ n ]->getGraphicsItem( );
+		if ( item != 0 )
+			item->setPos( _from[ n ] + ( _to[ n ] - _from[ n ] ) * t );
+	}
+	_scene.endBatch( );
+}
+//-----------------------------------------------------------------------------
+
+
+} // ::qan
+
@@ -0,0 +1,144 @@
+/*
+	Copyright (C) 2008-2015 Benoit AUTHEMAN
+
+    This file is part of Qanava.
+
+    Qanava is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Qanava is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with Qanava.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//-----------------------------------------------------------------------------
+// This file is a part of the Qanava software.
+//
+// \file	qanLayoutAnimator.h
+// \author	benoit@qanava.org
+// \date	2015 October 21
+//-----------------------------------------------------------------------------
+
+
+#ifndef qanLayoutAnimator_h
+#define qanLayoutAnimator_h
+
+
+// Qanava headers
+#include "./qanNode.h"
+
+
+// QT headers
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+#include <QList>
+#include <QHash>
+#include <QPointF>
+
+
+//-----------------------------------------------------------------------------
+namespace qan { // ::qan
+
+	class GraphScene;
+	class NodeGroup;
+
+	//! Animate node items from their current position to the position generated by a layout.
+	/*!
+		Call animate() after a layout has modified node positions (instead of GraphScene::updatePositions()
+		or NodeGroup::updateContent()). Nodes are moved over a given number of frames driven by a single timer,
+		each frame is applied in a scene batch (see GraphScene::beginBatch()), so that edges of moved nodes are
+		updated once per frame instead of once per node move.
+
+		Animated nodes must not be removed while an animation is running, call stop() before removing them.
+
+		\nosubgrouping
+	*/
+	class LayoutAnimator : public QObject
+	{
+		Q_OBJECT
+
+		/*! \name LayoutAnimator Constructor/Destructor *///--------------------
+		//@{
+	public:
+
+		//! LayoutAnimator constructor with animation frame count and interval (in ms) initialization.
+		LayoutAnimator( GraphScene& scene, int frameCount = 20, int frameInterval = 16 );
+
+		virtual ~LayoutAnimator( ) { }
+
+	protected:
+
+		GraphScene&		_scene;
+		//@}
+		//---------------------------------------------------------------------
+
+
+
+		/*! \name Animation Management *///------------------------------------
+		//@{
+	public:
+
+		//! Animate node items from their current position to their node position (as set by a layout).
+		/*! If an animation is already running, it is restarted from current item positions. */
+		void			animate( const Node::List& nodes );
+
+		//! Animate a group content laid out with NodeGroup::layoutContent(), group is updated when the animation ends.
+		void			animate( NodeGroup& group );
+
+		//! Stop the current animation and move every animated item to its final position.
+		void			stop( );
+
+		bool			isRunning( ) const { return _timer.isActive( ); }
+
+		int				getFrameCount( ) const { return _frameCount; }
+
+		void			setFrameCount( int frameCount ) { _frameCount = qMax( 1, frameCount ); }
+
+	signals:
+
+		//! Emitted when an animation ends (or is stopped).
+		void			finished( );
+
+	protected slots:
+
+		void			frame( );
+
+	protected:
+
+		//! Add nodes to the current animation (existing animated nodes keep their start position).
+		void			addNodes( const Node::List& nodes );
+
+		//! Apply an animation step, t in [0, 1].
+		void			applyFrame( qreal t );
+
+		QTimer				_timer;
+
+		int					_frameCount;
+
+		int					_frame;
+
+		QVector< Node* >	_nodes;
+
+		QHash< Node*, int >	_nodeIndexes;
+
+		QVector< QPointF >	_from;
+
+		QVector< QPointF >	_to;
+
+		QList< NodeGroup* >	_groups;
+		//@}
+		//---------------------------------------------------------------------
+	};
+} // ::qan
+//-----------------------------------------------------------------------------
+
+
+#endif // qanLayoutAnimator_h
+
@@ -0,0 +1,293 @@
+/*
+	Copyright (C) 2008-2015 Benoit AUTHEMAN
+
+    This file is part of Qanava.
+
+    Qanava is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Qanava is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with Qanava.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//-----------------------------------------------------------------------------
+// This file is a part of the Qanava software.
+//
+// \file	qanLayoutCache.cpp
+// \author	benoit@qanava.org
+// \date	2015 October 03
+//-----------------------------------------------------------------------------
+
+// Qt headers
+#include <QFile>
+#include <QDataStream>
+#include <QCryptographicHash>
+#include <QVector>
+#include <QtAlgorithms>
+
+// Qanava headers
+#include "./qanLayoutCache.h"
+
+
+namespace qan { // ::qan
+
+
+// Sidecar file magic number ("QANL") and format version
+static const quint32	LayoutCacheMagic = 0x51414E4C;
+static const quint32	LayoutCacheVersion = 1;
+
+
+/* Cached Layout Management *///-----------------------------------------------
+LayoutCache::Status	LayoutCache::layout( Graph& graph, Layout& layout, QRectF br, QProgressDialog* progress )
+{
+	Status status = COMPUTED;
+	Node::Set dirtyNodes;
+	if ( restore( graph, layout, dirtyNodes ) )
+	{
+		if ( dirtyNodes.isEmpty( ) )
+			status = RESTORED;
+		else if ( dirtyNodes.size( ) < ( int )graph.getNodeCount( ) )
+			status = INCREMENTAL;
+	}
+
+	if ( status == INCREMENTAL )
+	{
+		// Layout only the delta, with delta nodes that are not referenced by other delta nodes as root nodes
+		Node::List deltaRootNodes;
+		foreach ( Node* node, dirtyNodes )
+		{
+			bool isDeltaRoot = true;
+			Node::Set inNodes; node->collectInNodesSet( inNodes );
+			foreach ( Node* inNode, inNodes )
+				if ( dirtyNodes.contains( inNode ) )
+				{
+					isDeltaRoot = false;
+					break;
+				}
+			if ( isDeltaRoot )
+				deltaRootNodes << node;
+		}
+		layout.layout( deltaRootNodes, dirtyNodes, br, 0, progress );
+	}
+	else if ( status == COMPUTED )
+	{
+		Node::Set nodes;
+		graph.collectNodes( nodes );
+		layout.layout( graph.getRootNodes( ), nodes, br, 0, progress );
+	}
+
+	if ( status != RESTORED )
+		save( graph, layout );
+	graph.getM( ).updatePositions( );
+	return status;
+}
+
+/*!
+	Nodes that are not found in the cache are positioned at the barycenter of their cached adjacent
+	nodes (if any) so that incremental layouts start from a sensible position.
+ */
+bool	LayoutCache::restore( Graph& graph, const Layout& layout, Node::Set& dirtyNodes )
+{
+	QFile file( _fileName );
+	if ( !file.open( QIODevice::ReadOnly ) )
+		return false;
+
+	QDataStream in( &file );
+	in.setVersion( QDataStream::Qt_5_0 );
+	in.setFloatingPointPrecision( QDataStream::SinglePrecision );
+
+	quint32 magic = 0;
+	quint32 version = 0;
+	in >> magic >> version;
+	if ( magic != LayoutCacheMagic || version != LayoutCacheVersion )
+		return false;
+
+	QByteArray topology;
+	quint64 parameters = 0;
+	in >> topology >> parameters;
+	if ( parameters != toKey( QCryptographicHash::hash( layout.getParameters( ).toUtf8( ), QCryptographicHash::Sha1 ) ) )
+		return false;
+
+	quint32 nodeCount = 0;
+	in >> nodeCount;
+	QHash< quint64, quint64 >	cachedNeighbourhoods;
+	QHash< quint64, QPointF >	cachedPositions;
+	cachedNeighbourhoods.reserve( nodeCount );
+	cachedPositions.reserve( nodeCount );
+	for ( quint32 n = 0; n < nodeCount && in.status( ) == QDataStream::Ok; n++ )
+	{
+		quint64 identity, neighbourhood;
+		float x, y;
+		in >> identity >> neighbourhood >> x >> y;
+		cachedNeighbourhoods.insert( identity, neighbourhood );
+		cachedPositions.insert( identity, QPointF( x, y ) );
+	}
+	if ( in.status( ) != QDataStream::Ok )
+		return false;
+
+	// Fast path: topology and labels have not changed, every node keep its cached position
+	QHash< Node*, quint64 > identities;
+	hashIdentities( graph, identities );
+	bool unchanged = ( topology == hashTopology( graph ) );
+
+	Node::List newNodes;
+	foreach ( Node* node, graph.getNodes( ) )
+	{
+		quint64 identity = identities.value( node );
+		if ( !cachedPositions.contains( identity ) )
+		{
+			newNodes << node;
+			dirtyNodes.insert( node );
+			continue;
+		}
+		node->setPosition( cachedPositions.value( identity ) );
+		if ( !unchanged && hashNeighbourhood( *node, identities ) != cachedNeighbourhoods.value( identity ) )
+			dirtyNodes.insert( node );
+	}
+
+	// Seed new nodes at their restored neighbours barycenter
+	foreach ( Node* node, newNodes )
+	{
+		Node::Set adjacentNodes; node->getAdjacentNodesSet( adjacentNodes );
+		QPointF baryCenter( 0., 0. );
+		int restoredCount = 0;
+		foreach ( Node* adjacentNode, adjacentNodes )
+			if ( cachedPositions.contains( identities.value( adjacentNode ) ) )
+			{
+				baryCenter += adjacentNode->getPosition( );
+				restoredCount++;
+			}
+		if ( restoredCount > 0 )
+			node->setPosition( baryCenter / restoredCount );
+	}
+	return true;
+}
+
+bool	LayoutCache::save( Graph& graph, const Layout& layout )
+{
+	QFile file( _fileName );
+	if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+		return false;
+
+	QDataStream out( &file );
+	out.setVersion( QDataStream::Qt_5_0 );
+	out.setFloatingPointPrecision( QDataStream::SinglePrecision );
+
+	out << LayoutCacheMagic << LayoutCacheVersion;
+	out << hashTopology( graph );
+	out << toKey( QCryptographicHash::hash( layout.getParameters( ).toUtf8( ), QCryptographicHash::Sha1 ) );
+
+	QHash< Node*, quint64 > identities;
+	hashIdentities( graph, identities );
+	out << ( quint32 )graph.getNodeCount( );
+	foreach ( Node* node, graph.getNodes( ) )
+	{
+		const QPointF& position = node->getPosition( );
+		out << identities.value( node ) << hashNeighbourhood( *node, identities );
+		out << ( float )position.x( ) << ( float )position.y( );
+	}
+	return ( out.status( ) == QDataStream::Ok );
+}
+
+/*!
+	Hash is independent of node and edge insertion order: node identities and edges are
+	sorted before being hashed.
+ */
+QByteArray	LayoutCache::hashTopology( Graph& graph )
+{
+	QHash< Node*, quint64 > identities;
+	hashIdentities( graph, identities );
+
+	QVector< quint64 > nodeKeys;
+	nodeKeys.reserve( identities.size( ) );
+	foreach ( quint64 identity, identities )
+		nodeKeys << identity;
+	qSort( nodeKeys );
+
+	QVector< QPair< quint64, quint64 > > edgeKeys;
+	edgeKeys.reserve( graph.getEdges( ).size( ) );
+	foreach ( Edge* edge, graph.getEdges( ) )
+	{
+		quint64 src = identities.value( &edge->getSrc( ) );
+		quint64 dst = identities.value( &edge->getDst( ) );
+		edgeKeys << qMakePair( src, dst );
+		if ( edge->type( ) == Edge::HYPER )
+		{
+			HEdge* hEdge = static_cast< HEdge* >( edge );
+			foreach ( Node* hSrc, hEdge->getHSrc( ) )
+				edgeKeys << qMakePair( identities.value( hSrc ), dst );
+			foreach ( Node* hDst, hEdge->getHDst( ) )
+				edgeKeys << qMakePair( src, identities.value( hDst ) );
+		}
+	}
+	qSort( edgeKeys );
+
+	QCryptographicHash hash( QCryptographicHash::Sha1 );
+	hash.addData( reinterpret_cast< const char* >( nodeKeys.constData( ) ), nodeKeys.size( ) * sizeof( quint64 ) );
+	for ( int e = 0; e < edgeKeys.size( ); e++ )
+	{
+		hash.addData( reinterpret_cast< const char* >( &edgeKeys[ e ].first ), sizeof( quint64 ) );
+		hash.addData( reinterpret_cast< const char* >( &edgeKeys[ e ].second ), sizeof( quint64 ) );
+	}
+	return hash.result( );
+}
+
+void	LayoutCache::hashIdentities( Graph& graph, QHash< Node*, quint64 >& identities )
+{
+	QHash< QString, int > labelRanks;
+	identities.reserve( graph.getNodeCount( ) );
+	foreach ( Node* node, graph.getNodes( ) )
+	{
+		int rank = labelRanks.value( node->getLabel( ), 0 );
+		labelRanks.insert( node->getLabel( ), rank + 1 );
+
+		QCryptographicHash hash( QCryptographicHash::Sha1 );
+		hash.addData( node->getLabel( ).toUtf8( ) );
+		hash.addData( reinterpret_cast< const char* >( &rank ), sizeof( int ) );
+		identities.insert( node, toKey( hash.result( ) ) );
+	}
+}
+
+quint64	LayoutCache::hashNeighbourhood( Node& node, const QHash< Node*, quint64 >& identities )
+{
+	Node::Set inNodes; node.collectInNodesSet( inNodes );
+	Node::Set outNodes; node.collectOutNodesSet( outNodes );
+
+	QVector< quint64 > inKeys;
+	foreach ( Node* inNode, inNodes )
+		inKeys << identities.value( inNode );
+	qSort( inKeys );
+
+	QVector< quint64 > outKeys;
+	foreach ( Node* outNode, outNodes )
+		outKeys << identities.value( outNode );
+	qSort( outKeys );
+
+	QCryptographicHash hash( QCryptographicHash::Sha1 );
+	quint64 identity = identities.value( &node );
+	hash.addData( reinterpret_cast< const char* >( &identity ), sizeof( quint64 ) );
+	hash.addData( reinterpret_cast< const char* >( inKeys.constData( ) ), inKeys.size( ) * sizeof( quint64 ) );
+	hash.addData( "|", 1 );
+	hash.addData( reinterpret_cast< const char* >( outKeys.constData( ) ), outKeys.size( ) * sizeof( quint64 ) );
+	return toKey( hash.result( ) );
+}
+
+quint64	LayoutCache::toKey( const QByteArray& hash )
+{
+	quint64 key = 0;
+	for ( int b = 0; b < 8 && b < hash.size( ); b++ )
+		key = ( key << 8 ) | ( quint8 )hash.at( b );
+	return key;
+}
+//-----------------------------------------------------------------------------
+
+
+} // ::qan
+
@@ -0,0 +1,135 @@
+/*
+	Copyright (C) 2008-2015 Benoit AUTHEMAN
+
+    This file is part of Qanava.
+
+    Qanava is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Qanava is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with Qanava.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//-----------------------------------------------------------------------------
+// This file is a part of the Qanava software.
+//
+// \file	qanLayoutCache.h
+// \author	benoit@qanava.org
+// \date	2015 October 03
+//-----------------------------------------------------------------------------
+
+
+#ifndef qanLayoutCache_h
+#define qanLayoutCache_h
+
+
+// Qanava headers
+#include "./qanLayout.h"
+
+
+// QT headers
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include <QPointF>
+#include <QProgressDialog>
+
+
+//-----------------------------------------------------------------------------
+namespace qan { // ::qan
+
+	//! Persist node positions generated by a layout in a binary sidecar file.
+	/*!
+		The cache is keyed by a hash of the graph topology, node labels and layout parameters
+		(see qan::Layout::getParameters()). When the graph has not changed since the cache
+		was saved, positions are restored without running the layout. When only a part of the
+		graph has changed, cached positions are restored for unchanged nodes and the layout is
+		run only on the modified nodes (the delta).
+
+		Nodes are identified by their label and by their rank among nodes sharing the same
+		label, a node is considered modified when its adjacent nodes identities have changed.
+
+		Sidecar file format (QDataStream, big endian): magic, version, topology hash, parameters hash,
+		node count, then for each node its identity hash, neighbourhood hash and position.
+
+		\nosubgrouping
+	*/
+	class LayoutCache
+	{
+		/*! \name LayoutCache Constructor/Destructor *///-----------------------
+		//@{
+	public:
+
+		//! LayoutCache constructor with sidecar file name initialization.
+		LayoutCache( QString fileName ) : _fileName( fileName ) { }
+
+		//! LayoutCache destructor.
+		virtual ~LayoutCache( ) { }
+
+		//! Get the sidecar file name where positions are persisted.
+		const QString&	getFileName( ) const { return _fileName; }
+
+	private:
+
+		QString			_fileName;
+
+		Q_DISABLE_COPY( LayoutCache );
+		//@}
+		//---------------------------------------------------------------------
+
+
+
+		/*! \name Cached Layout Management *///--------------------------------
+		//@{
+	public:
+
+		//! Result of a cached layout application.
+		enum Status
+		{
+			//! Every position has been restored from the sidecar file.
+			RESTORED		= 0,
+			//! Unchanged nodes have been restored, the layout has been run on the delta.
+			INCREMENTAL		= 1,
+			//! No usable cache exists, the layout has been run on the whole graph.
+			COMPUTED		= 2
+		};
+
+		//! Layout a graph using cached positions when possible, then save the resulting positions and update the graph scene.
+		Status			layout( Graph& graph, Layout& layout, QRectF br, QProgressDialog* progress = 0 );
+
+		//! Restore cached positions for nodes whose neighbourhood has not changed, modified or new nodes are collected in dirtyNodes.
+		/*! \return false if the sidecar file does not exist, could not be read or has been generated with other layout parameters. */
+		bool			restore( Graph& graph, const Layout& layout, Node::Set& dirtyNodes );
+
+		//! Save current graph node positions in the sidecar file.
+		bool			save( Graph& graph, const Layout& layout );
+
+		//! Compute a hash of graph topology and node labels.
+		static QByteArray	hashTopology( Graph& graph );
+
+	protected:
+
+		//! Compute a stable identity hash for each node of a graph (label and rank among nodes with the same label).
+		static void		hashIdentities( Graph& graph, QHash< Node*, quint64 >& identities );
+
+		//! Compute a hash of a node adjacent nodes identities.
+		static quint64	hashNeighbourhood( Node& node, const QHash< Node*, quint64 >& identities );
+
+		//! Convert the first 8 bytes of a hash result to an integer.
+		static quint64	toKey( const QByteArray& hash );
+		//@}
+		//---------------------------------------------------------------------
+	};
+} // ::qan
+//-----------------------------------------------------------------------------
+
+
+#endif // qanLayoutCache_h
+
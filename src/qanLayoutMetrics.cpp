@@ -0,0 +1,364 @@
+/*
+	Copyright (C) 2008-2015 Benoit AUTHEMAN
+
+    This file is part of Qanava.
+
+    Qanava is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Qanava is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with Qanava.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//-----------------------------------------------------------------------------
+// This file is a part of the Qanava software.
+//
+// \file	qanLayoutMetrics.cpp
+// \author	benoit@qanava.org
+// \date	2015 October 18
+//-----------------------------------------------------------------------------
+
+// Qt headers
+#include <QtMath>
+#include <QElapsedTimer>
+#include <QPair>
+#include <QtAlgorithms>
+
+// Qanava headers
+#include "./qanLayoutMetrics.h"
+
+
+namespace qan { // ::qan
+
+
+/* LayoutMetrics Constructor/Destructor *///-----------------------------------
+LayoutMetrics::LayoutMetrics( int pivotCount ) :
+	_pivotCount( pivotCount ),
+	_nodeCount( 0 ),
+	_edgeCount( 0 ),
+	_crossingCount( 0 ),
+	_overlapArea( 0. ),
+	_stress( 0. ),
+	_edgeLengthVariance( 0. ),
+	_minimumAngle( 0. ),
+	_angularResolution( 0. ),
+	_wallTime( 0 ),
+	_iterationCount( 0 )
+{
+
+}
+//-----------------------------------------------------------------------------
+
+
+
+/* Metrics Computation Management *///-----------------------------------------
+void	LayoutMetrics::compute( Node::Set& nodes )
+{
+	GraphIndex index( nodes );
+	int n = index.getNodeCount( );
+	_nodeCount = n;
+
+	QVector< QRectF > rects( n );
+	QVector< QPointF > centers( n );
+	for ( int i = 0; i < n; i++ )
+	{
+		Node* node = index.getNode( i );
+		rects[ i ] = QRectF( node->getPosition( ), Layout::getNodeSize( *node ) );
+		centers[ i ] = rects[ i ].center( );
+	}
+
+	// Model edges as segments between nodes centers
+	QVector< QLineF > segments;
+	QVector< int > ends;
+	for ( int i = 0; i < n; i++ )
+		foreach ( Edge* edge, index.getNode( i )->getOutEdges( ) )
+		{
+			int j = index.getIndex( &edge->getDst( ) );
+			if ( j < 0 || j == i )
+				continue;
+			segments << QLineF( centers[ i ], centers[ j ] );
+			ends << i << j;
+		}
+	_edgeCount = segments.size( );
+
+	_crossingCount = countCrossings( segments, ends );
+	_overlapArea = computeOverlapArea( rects );
+	_stress = computeStress( index, centers );
+
+	// Edge length variance, normalized by squared mean length
+	_edgeLengthVariance = 0.;
+	if ( !segments.isEmpty( ) )
+	{
+		qreal sum = 0., sum2 = 0.;
+		foreach ( const QLineF& segment, segments )
+		{
+			qreal length = segment.length( );
+			sum += length;
+			sum2 += length * length;
+		}
+		qreal mean = sum / segments.size( );
+		qreal variance = sum2 / segments.size( ) - mean * mean;
+		_edgeLengthVariance = ( mean > 0. ? qMax( variance, ( qreal )0. ) / ( mean * mean ) : 0. );
+	}
+
+	// Angular resolution, computed on the undirected simple graph
+	qreal minimumAngle = 2. * M_PI;
+	qreal resolutionSum = 0.;
+	int resolutionCount = 0;
+	QVector< qreal > angles;
+	for ( int i = 0; i < n; i++ )
+	{
+		int degree = index.getDegree( i );
+		if ( degree < 2 )
+			continue;
+		angles.resize( 0 );
+		for ( int a = index.getOffset( i ); a < index.getOffset( i ) + degree; a++ )
+		{
+			QPointF d = centers[ index.getAdjacents( ).at( a ) ] - centers[ i ];
+			angles << qAtan2( d.y( ), d.x( ) );
+		}
+		qSort( angles );
+		qreal minimum = angles.first( ) + 2. * M_PI - angles.last( );
+		for ( int a = 1; a < angles.size( ); a++ )
+			minimum = qMin( minimum, angles[ a ] - angles[ a - 1 ] );
+		minimumAngle = qMin( minimumAngle, minimum );
+		resolutionSum += minimum / ( 2. * M_PI / degree );
+		resolutionCount++;
+	}
+	_minimumAngle = ( resolutionCount > 0 ? qRadiansToDegrees( minimumAngle ) : 0. );
+	_angularResolution = ( resolutionCount > 0 ? resolutionSum / resolutionCount : 0. );
+}
+
+void	LayoutMetrics::measure( Graph& graph, Layout& layout, QRectF br )
+{
+	Node::Set nodes;
+	graph.collectNodes( nodes );
+
+	QElapsedTimer timer;
+	timer.start( );
+	layout.layout( graph.getRootNodes( ), nodes, br, 0 );
+	_wallTime = timer.elapsed( );
+	_iterationCount = layout.getIterationCount( );
+
+	compute( nodes );
+}
+
+static inline int	cellIndex( qreal v, qreal origin, qreal cellSize, int cellCount )
+{
+	return qBound( 0, ( int )qFloor( ( v - origin ) / cellSize ), cellCount - 1 );
+}
+
+/*! Append to cells the grid cells crossed by a segment (and every cell closer than epsilon to the segment). */
+static void	collectSegmentCells( const QLineF& segment, const QPointF& origin, qreal cellWidth, qreal cellHeight,
+									 int cellCount, qreal epsilon, QVector< int >& cells )
+{
+	QPointF p1 = segment.p1( );
+	QPointF p2 = segment.p2( );
+	if ( p1.y( ) > p2.y( ) )
+		qSwap( p1, p2 );
+	qreal dy = p2.y( ) - p1.y( );
+
+	int top = cellIndex( p1.y( ) - epsilon, origin.y( ), cellHeight, cellCount );
+	int bottom = cellIndex( p2.y( ) + epsilon, origin.y( ), cellHeight, cellCount );
+	for ( int row = top; row <= bottom; row++ )
+	{
+		// Clip segment to the row band, then collect cells covered on x
+		qreal ya = qMax( p1.y( ), origin.y( ) + row * cellHeight - epsilon );
+		qreal yb = qMin( p2.y( ), origin.y( ) + ( row + 1 ) * cellHeight + epsilon );
+		qreal xa = p1.x( ), xb = p2.x( );
+		if ( dy > 0. )
+		{
+			xa = p1.x( ) + ( p2.x( ) - p1.x( ) ) * ( ya - p1.y( ) ) / dy;
+			xb = p1.x( ) + ( p2.x( ) - p1.x( ) ) * ( yb - p1.y( ) ) / dy;
+		}
+		if ( xa > xb )
+			qSwap( xa, xb );
+		int left = cellIndex( xa - epsilon, origin.x( ), cellWidth, cellCount );
+		int right = cellIndex( xb + epsilon, origin.x( ), cellWidth, cellCount );
+		for ( int column = left; column <= right; column++ )
+			cells << row * cellCount + column;
+	}
+}
+
+static inline qreal	orientation( const QPointF& a, const QPointF& b, const QPointF& c )
+{
+	return ( b.x( ) - a.x( ) ) * ( c.y( ) - a.y( ) ) - ( b.y( ) - a.y( ) ) * ( c.x( ) - a.x( ) );
+}
+
+/*!
+	Segments are registered in every grid cell they cross, and pairs sharing a cell are tested. A crossing
+	is counted only in the cell containing the intersection point, so that pairs sharing several cells are
+	counted once. Grid resolution is sqrt(m).sqrt(m) cells: memory and time are linear in the number of
+	segments for layouts with mostly short edges, a dense bundle of long edges crossing the same cells
+	degrades to a quadratic number of tests in these cells.
+ */
+qint64	LayoutMetrics::countCrossings( const QVector< QLineF >& segments, const QVector< int >& ends )
+{
+	int m = segments.size( );
+	if ( m < 2 )
+		return 0;
+	bool hasEnds = ( ends.size( ) == 2 * m );
+
+	QRectF bounds( segments.first( ).p1( ), segments.first( ).p1( ) );
+	foreach ( const QLineF& segment, segments )
+	{
+		bounds.setLeft( qMin( bounds.left( ), qMin( segment.x1( ), segment.x2( ) ) ) );
+		bounds.setRight( qMax( bounds.right( ), qMax( segment.x1( ), segment.x2( ) ) ) );
+		bounds.setTop( qMin( bounds.top( ), qMin( segment.y1( ), segment.y2( ) ) ) );
+		bounds.setBottom( qMax( bounds.bottom( ), qMax( segment.y1( ), segment.y2( ) ) ) );
+	}
+	int cellCount = qBound( 1, ( int )qCeil( qSqrt( ( qreal )m ) ), 2048 );
+	qreal cellWidth = qMax( bounds.width( ) / cellCount, ( qreal )1e-6 );
+	qreal cellHeight = qMax( bounds.height( ) / cellCount, ( qreal )1e-6 );
+	qreal epsilon = 1e-6 * qMax( cellWidth, cellHeight );
+	QPointF origin = bounds.topLeft( );
+
+	// Build a CSR cell to segments index with two traversals
+	QVector< int > offsets( cellCount * cellCount + 1, 0 );
+	QVector< int > cells;
+	for ( int s = 0; s < m; s++ )
+	{
+		cells.resize( 0 );
+		collectSegmentCells( segments[ s ], origin, cellWidth, cellHeight, cellCount, epsilon, cells );
+		foreach ( int cell, cells )
+			offsets[ cell + 1 ]++;
+	}
+	for ( int c = 0; c < cellCount * cellCount; c++ )
+		offsets[ c + 1 ] += offsets[ c ];
+	QVector< int > cellSegments( offsets.last( ) );
+	QVector< int > fill( offsets );
+	for ( int s = 0; s < m; s++ )
+	{
+		cells.resize( 0 );
+		collectSegmentCells( segments[ s ], origin, cellWidth, cellHeight, cellCount, epsilon, cells );
+		foreach ( int cell, cells )
+			cellSegments[ fill[ cell ]++ ] = s;
+	}
+
+	// Test pairs in each cell
+	qint64 crossings = 0;
+	for ( int c = 0; c < cellCount * cellCount; c++ )
+		for ( int i = offsets[ c ]; i < offsets[ c + 1 ]; i++ )
+		{
+			int si = cellSegments[ i ];
+			const QPointF& a = segments[ si ].p1( );
+			const QPointF& b = segments[ si ].p2( );
+			for ( int j = i + 1; j < offsets[ c + 1 ]; j++ )
+			{
+				int sj = cellSegments[ j ];
+				if ( hasEnds && ( ends[ 2 * si ] == ends[ 2 * sj ] || ends[ 2 * si ] == ends[ 2 * sj + 1 ] ||
+								  ends[ 2 * si + 1 ] == ends[ 2 * sj ] || ends[ 2 * si + 1 ] == ends[ 2 * sj + 1 ] ) )
+					continue;
+				const QPointF& p = segments[ sj ].p1( );
+				const QPointF& q = segments[ sj ].p2( );
+				qreal d1 = orientation( p, q, a );
+				qreal d2 = orientation( p, q, b );
+				qreal d3 = orientation( a, b, p );
+				qreal d4 = orientation( a, b, q );
+				if ( !( ( d1 > 0. && d2 < 0. ) || ( d1 < 0. && d2 > 0. ) ) ||
+					 !( ( d3 > 0. && d4 < 0. ) || ( d3 < 0. && d4 > 0. ) ) )
+					continue;
+
+				QPointF x = a + ( b - a ) * ( d1 / ( d1 - d2 ) );
+				int cell = cellIndex( x.y( ), origin.y( ), cellHeight, cellCount ) * cellCount +
+							cellIndex( x.x( ), origin.x( ), cellWidth, cellCount );
+				if ( cell == c )
+					crossings++;
+			}
+		}
+	return crossings;
+}
+
+qreal	LayoutMetrics::computeOverlapArea( const QVector< QRectF >& rects )
+{
+	QVector< QPair< qreal, int > > order;
+	order.reserve( rects.size( ) );
+	for ( int r = 0; r < rects.size( ); r++ )
+		order << qMakePair( rects[ r ].left( ), r );
+	qSort( order );
+
+	// Sweep on x, keeping rectangles whose x span contains the sweep position
+	qreal area = 0.;
+	QVector< int > active;
+	for ( int o = 0; o < order.size( ); o++ )
+	{
+		const QRectF& rect = rects[ order[ o ].second ];
+		int kept = 0;
+		for ( int a = 0; a < active.size( ); a++ )
+			if ( rects[ active[ a ] ].right( ) > rect.left( ) )
+				active[ kept++ ] = active[ a ];
+		active.resize( kept );
+
+		foreach ( int a, active )
+		{
+			QRectF overlap = rects[ a ].intersected( rect );
+			if ( !overlap.isEmpty( ) )
+				area += overlap.width( ) * overlap.height( );
+		}
+		active << order[ o ].second;
+	}
+	return area;
+}
+
+/*!
+	Pairs are sampled with BFS from pivotCount sources evenly spread in the index, disconnected pairs are
+	ignored. With r = |xi - xj| / dij and the optimal scale factor a = sum(r) / sum(r^2), the normalized
+	stress sum( ( a.r - 1 )^2 ) / N simplifies to 1 - sum(r)^2 / ( N.sum(r^2) ).
+ */
+qreal	LayoutMetrics::computeStress( const GraphIndex& index, const QVector< QPointF >& centers ) const
+{
+	int n = index.getNodeCount( );
+	int pivotCount = qMin( _pivotCount, n );
+	if ( pivotCount <= 0 )
+		return 0.;
+
+	double sum = 0., sum2 = 0.;
+	qint64 pairCount = 0;
+	QVector< int > distances;
+	for ( int p = 0; p < pivotCount; p++ )
+	{
+		int source = ( int )( ( qint64 )p * n / pivotCount );
+		index.bfs( source, distances );
+		for ( int j = 0; j < n; j++ )
+		{
+			if ( distances[ j ] <= 0 )
+				continue;
+			QPointF d = centers[ j ] - centers[ source ];
+			double r = qSqrt( d.x( ) * d.x( ) + d.y( ) * d.y( ) ) / distances[ j ];
+			sum += r;
+			sum2 += r * r;
+			pairCount++;
+		}
+	}
+	if ( pairCount == 0 || sum2 <= 0. )
+		return 0.;
+	return qMax( 0., 1. - ( sum * sum ) / ( pairCount * sum2 ) );
+}
+//-----------------------------------------------------------------------------
+
+
+
+/* Metrics Results Management *///---------------------------------------------
+QString	LayoutMetrics::getCsvHeader( )
+{
+	return QString( "nodes,edges,crossings,overlap_area,stress,edge_length_variance,min_angle,angular_resolution,wall_time_ms,iterations" );
+}
+
+QString	LayoutMetrics::toCsv( ) const
+{
+	return QString( "%1,%2,%3,%4,%5,%6,%7,%8,%9,%10" ).arg( _nodeCount ).arg( _edgeCount ).arg( _crossingCount ).
+			arg( _overlapArea, 0, 'f', 1 ).arg( _stress, 0, 'f', 5 ).arg( _edgeLengthVariance, 0, 'f', 5 ).
+			arg( _minimumAngle, 0, 'f', 2 ).arg( _angularResolution, 0, 'f', 4 ).arg( _wallTime ).arg( _iterationCount );
+}
+//-----------------------------------------------------------------------------
+
+
+} // ::qan
+
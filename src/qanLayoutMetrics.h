@@ -0,0 +1,168 @@
+/*
+	Copyright (C) 2008-2015 Benoit AUTHEMAN
+
+    This file is part of Qanava.
+
+    Qanava is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Qanava is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with Qanava.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//-----------------------------------------------------------------------------
+// This file is a part of the Qanava software.
+//
+// \file	qanLayoutMetrics.h
+// \author	benoit@qanava.org
+// \date	2015 October 18
+//-----------------------------------------------------------------------------
+
+
+#ifndef qanLayoutMetrics_h
+#define qanLayoutMetrics_h
+
+
+// Qanava headers
+#include "./qanLayout.h"
+#include "./qanGraphIndex.h"
+
+
+// QT headers
+#include <QVector>
+#include <QLineF>
+#include <QRectF>
+
+
+//-----------------------------------------------------------------------------
+namespace qan { // ::qan
+
+	//! Compute layout quality metrics (crossings, overlaps, stress, edge length, angles) and layout performances.
+	/*!
+		Metrics are computed from nodes positions and sizes (see Layout::getNodeSize()), edges are
+		modelled as straight segments between nodes centers. Only edges whose source and destination
+		are in the measured node set are considered.
+
+		\nosubgrouping
+	*/
+	class LayoutMetrics
+	{
+		/*! \name LayoutMetrics Constructor/Destructor *///---------------------
+		//@{
+	public:
+
+		//! LayoutMetrics constructor.
+		/*! \param	pivotCount	Number of BFS sources used to sample graph theoretical distances for stress computation. */
+		LayoutMetrics( int pivotCount = 50 );
+
+		virtual ~LayoutMetrics( ) { }
+
+	protected:
+
+		int				_pivotCount;
+		//@}
+		//---------------------------------------------------------------------
+
+
+
+		/*! \name Metrics Computation Management *///--------------------------
+		//@{
+	public:
+
+		//! Compute quality metrics for a set of already laid out nodes.
+		void			compute( Node::Set& nodes );
+
+		//! Run a layout on a graph, measure its wall time and iteration count, then compute quality metrics.
+		void			measure( Graph& graph, Layout& layout, QRectF br );
+
+		//! Count proper crossings between segments using a uniform grid, O(m + k) for m segments with k pairs sharing a cell.
+		/*!	\param	ends	Optional segments end node ids (2 ids per segment), segments sharing an end node are not tested. */
+		static qint64	countCrossings( const QVector< QLineF >& segments, const QVector< int >& ends );
+
+		//! Compute the sum of pairwise intersection area of a set of rectangles with a sweep on x.
+		static qreal	computeOverlapArea( const QVector< QRectF >& rects );
+
+	protected:
+
+		//! Compute stress for BFS sampled pairs, with an optimal scaling of positions.
+		qreal			computeStress( const GraphIndex& index, const QVector< QPointF >& centers ) const;
+		//@}
+		//---------------------------------------------------------------------
+
+
+
+		/*! \name Metrics Results Management *///------------------------------
+		//@{
+	public:
+
+		int				getNodeCount( ) const { return _nodeCount; }
+
+		int				getEdgeCount( ) const { return _edgeCount; }
+
+		//! Number of proper crossings between edges not sharing a node.
+		qint64			getCrossingCount( ) const { return _crossingCount; }
+
+		//! Sum of pairwise nodes rectangles intersection area.
+		qreal			getOverlapArea( ) const { return _overlapArea; }
+
+		//! Mean squared relative error between scaled layout distances and graph theoretical distances (0 is a perfect embedding).
+		qreal			getStress( ) const { return _stress; }
+
+		//! Variance of edge lengths divided by squared mean edge length (scale independent).
+		qreal			getEdgeLengthVariance( ) const { return _edgeLengthVariance; }
+
+		//! Minimum angle in degrees between two edges incident to the same node.
+		qreal			getMinimumAngle( ) const { return _minimumAngle; }
+
+		//! Mean over nodes of their minimum incident edges angle relative to the ideal 2.PI/degree angle (1 is optimal).
+		qreal			getAngularResolution( ) const { return _angularResolution; }
+
+		//! Layout wall time in milliseconds (set by measure()).
+		qint64			getWallTime( ) const { return _wallTime; }
+
+		//! Layout iteration count (set by measure()).
+		int				getIterationCount( ) const { return _iterationCount; }
+
+		//! Get a CSV header line for toCsv() columns.
+		static QString	getCsvHeader( );
+
+		//! Get metrics as a CSV line.
+		QString			toCsv( ) const;
+
+	protected:
+
+		int				_nodeCount;
+
+		int				_edgeCount;
+
+		qint64			_crossingCount;
+
+		qreal			_overlapArea;
+
+		qreal			_stress;
+
+		qreal			_edgeLengthVariance;
+
+		qreal			_minimumAngle;
+
+		qreal			_angularResolution;
+
+		qint64			_wallTime;
+
+		int				_iterationCount;
+		//@}
+		//---------------------------------------------------------------------
+	};
+} // ::qan
+//-----------------------------------------------------------------------------
+
+
+#endif // qanLayoutMetrics_h
+
@@ -35,8 +35,11 @@ namespace qan { // ::qan
 
 
 /* Node Constructor/Destructor *///--------------------------------------------
+quint64	Node::_nextSerial = 0;
+
 Node::Node( QString label ) :
 	QObject( 0 ),
+	_serial( _nextSerial++ ),
 	_graphicsItem( 0 ),
 	_graphItem( 0 ),
 	_label( "" ),
@@ -65,9 +65,16 @@ namespace qan { // ::qan
 			//! Node destructor.
             virtual ~Node( ) { }
 
+			//! Get node serial number, nodes are numbered in creation order (used as a stable ordering key).
+			quint64				getSerial( ) const { return _serial; }
+
 		private:
 
 			Node( const Node& n );
+
+			quint64				_serial;
+
+			static quint64		_nextSerial;
 			//@}
 			//-----------------------------------------------------------------
 
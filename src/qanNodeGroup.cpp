@@ -34,6 +34,8 @@
 
 // QT headers
 #include <QtDebug>
+#include <QPainter>
+#include <QFontMetricsF>
 #include <QVBoxLayout>
 #include <QTimer>
 #include <QScrollBar>
@@ -55,6 +57,9 @@ NodeGroup::NodeGroup( qan::GraphScene& scene, QString name, QGraphicsItem* paren
 	_dragOver( false ),
 	_br( QRectF( ) ),
 	_background( 0 ),
+	_collapsed( false ),
+	_expandedBr( ),
+	_proxyItem( 0 ),
 	_mousePressed( false ),
     _isMovable( true )
 {
@@ -115,12 +120,18 @@ void	NodeGroup::layout( )
     if ( _graphLayout == 0 )
         return;
 
+    updateGroup( ); // Layout nodes, then update node items with their new layout and generate a correct bounding rect
+}
+
+void	NodeGroup::layoutContent( QRectF br )
+{
+    if ( _graphLayout == 0 || _collapsed )
+        return;
+
     // Apply qanava layout
     qan::Node::Set rootNodes; getRootNodes( rootNodes );
     qan::Node::List rootNodesList = rootNodes.toList( );
-    _graphLayout->layout( rootNodesList, _nodes, _scene.sceneRect( ), 0, 0 );
-
-    updateGroup( ); // Update node with their new layout and generate a correct bounding rect
+    _graphLayout->layout( rootNodesList, _nodes, br, 0, 0 );
 }
 //-----------------------------------------------------------------------------
 
@@ -162,12 +173,22 @@ void	NodeGroup::paint( QPainter* painter, const QStyleOptionGraphicsItem* option
 
 void	NodeGroup::updateGroup( )
 {
-    // Update sub items position according to their laid out position
+    layoutContent( _scene.sceneRect( ) );
+    updateContent( );
+}
+
+void	NodeGroup::updateContent( )
+{
+    if ( _collapsed )   // Collapsed group nodes have no graphics items
+    {
+        _scene.updateEdgeBundles( *this );
+        return;
+    }
+
+    // Update sub items position according to their laid out position, edges are updated once when the batch ends
+    _scene.beginBatch( );
     if ( _graphLayout != 0 )
     {
-        qan::Node::Set rootNodes; getRootNodes( rootNodes );
-        qan::Node::List rootNodesList = rootNodes.toList( );
-        _graphLayout->layout( rootNodesList, _nodes, _scene.sceneRect( ), 0, 0 );
         foreach ( qan::Node* node, getNodes( ) )
             node->getGraphicsItem( )->setPos( node->getPosition( ) );
     }
@@ -197,49 +218,53 @@ void	NodeGroup::updateGroup( )
         //setPos( nodesSceneBr.topLeft( ) );
     }
 
-    // Update group nodes edges
-    qan::Edge::Set edges;
-    foreach ( qan::Node* node, getNodes( ) )
-        edges.unite( node->getOutEdges( ).toSet( ) );
+    // Update group nodes edges (even for nodes that have not moved)
     foreach ( qan::Node* node, getNodes( ) )
-        edges.unite( node->getInEdges( ).toSet( ) );
-    foreach ( qan::Edge* edge, edges )
-        edge->getGraphItem( )->updateItem( );
+        _scene.addBatchNode( *node );
+    _scene.endBatch( );
 
     if ( _background != 0 ) // Update group background according to the new bounding rect
         _background->setRect( boundingRect( ).adjusted( -1, -1, 1, 1 ) );
+    _scene.updateEdgeBundles( *this );
 }
 
 void	NodeGroup::setVisible( bool v )
 {
     QGraphicsItem::setVisible( v );
 
-    // Hide group node's graphics items (and their edges graphics items)
+    // Hide group node's graphics items (and their edges graphics items), collapsed group nodes have no items
     foreach ( qan::Node* node, _nodes )
     {
-        Q_ASSERT( node->getGraphicsItem( ) );
-        node->getGraphicsItem( )->setVisible( v );
+        if ( node->getGraphicsItem( ) != 0 )
+            node->getGraphicsItem( )->setVisible( v );
 
         // Hide nodes edges graphics items
         qan::Edge::Set edges( node->getInEdges( ).toSet( ) );
         edges.unite( node->getOutEdges( ).toSet( ) );
         foreach ( qan::Edge* edge, edges )
-            edge->getGraphicsItem( )->setVisible( v );
+            if ( edge->getGraphicsItem( ) != 0 )
+                edge->getGraphicsItem( )->setVisible( v );
     }
 }
 
 void	NodeGroup::groupMoved( QPointF curPos, QPointF oldPos )
 {
-    Q_UNUSED( oldPos );
+    _scene.addDirtyRect( sceneBoundingRect( ).translated( oldPos - curPos ) );
+    _scene.addDirtyRect( sceneBoundingRect( ) );
 
-    // Update group nodes edges
-    qan::Edge::Set edges;
-    foreach ( qan::Node* node, getNodes( ) )
-        edges.unite( node->getOutEdges( ).toSet( ) );
-    foreach ( qan::Node* node, getNodes( ) )
-        edges.unite( node->getInEdges( ).toSet( ) );
-    foreach ( qan::Edge* edge, edges )
-        edge->getGraphItem( )->updateItem( );
+    // Update group nodes edges (edges shared by several group nodes are updated once on next flush), only edges
+    // drawn to the proxy have to be updated when the group is collapsed
+    if ( _collapsed && _proxyItem != 0 )
+    {
+        foreach ( qan::Edge* edge, _proxyItem->getEdges( ) )
+            _scene.scheduleEdgeUpdate( *edge );
+    }
+    else
+    {
+        foreach ( qan::Node* node, getNodes( ) )
+            _scene.scheduleNodeEdgesUpdate( *node );
+    }
+    _scene.updateEdgeBundles( *this );
 
     // Force group update when there is no parent layout to invalidate...
     if ( _layout != 0 && parentLayoutItem( ) == 0 )
@@ -252,6 +277,8 @@ QRectF	NodeGroup::getNodesSceneBoundingRect( ) const
 	foreach ( qan::Node* node, _nodes )
 	{
 		QGraphicsItem* nodeItem = node->getGraphicsItem( );
+		if ( nodeItem == 0 )
+			continue;
 		if ( !sceneBr.isValid( ) )
 			sceneBr = nodeItem->sceneBoundingRect( );
 		else
@@ -289,6 +316,7 @@ void NodeGroup::setGeometry( const QRectF& geom )
         _br = QRectF( QPointF( 0., 0. ), geom.size( ) );
         setPos( geom.topLeft( ) );
     }
+    _scene.updateEdgeBundles( *this );
 }
 
 QSizeF NodeGroup::sizeHint( Qt::SizeHint which, const QSizeF& constraint ) const
@@ -398,7 +426,24 @@ void	NodeGroup::addNode( qan::Node& node )
     qan::NodeItem* nodeItem = ( qan::NodeItem* )node.getGraphItem( );
     Q_ASSERT( nodeItem );
     _nodes.insert( &node );
+    if ( _collapsed )   // Node item is released at once
+    {
+        qan::Node::Set nodes; nodes.insert( &node );
+        _scene.collapseNodes( *this, nodes );
+        _proxyItem->updateItem( );
+    }
+    else
+    {
+        attachNodeItem( *nodeItem );
+        updateGroup( );
+        updateGeometry( );
+    }
+    _scene.updateNodeEdgeBundles( node );
+}
 
+void	NodeGroup::attachNodeItem( qan::NodeItem& item )
+{
+    qan::NodeItem* nodeItem = &item;
     nodeItem->setZValue( zValue( ) + 1.0 );
     nodeItem->setDraggable( false );	// Once added in a group the item is no longer draggable to another group.
 
@@ -433,9 +478,15 @@ void	NodeGroup::addNode( qan::Node& node )
         nodeItem->setFlag( QGraphicsItem::ItemSendsScenePositionChanges, false );
         connect( nodeItem, SIGNAL( itemMoved( QPointF, QPointF ) ), this, SLOT( itemMoved( QPointF, QPointF ) ) );
     }
+}
 
-    updateGroup( );
-    updateGeometry( );
+void	NodeGroup::detachNodeItem( qan::NodeItem& nodeItem )
+{
+    if ( _layout != 0 )
+    {
+        _layout->removeItem( &nodeItem );
+        nodeItem.setParentLayoutItem( 0 );
+    }
 }
 
 void	NodeGroup::addEdge( qan::Edge& edge )
@@ -447,12 +498,19 @@ void	NodeGroup::addEdge( qan::Edge& edge )
 void	NodeGroup::removeNode( qan::Node& node )
 { 
 	_nodes.remove( &node ); 
+    if ( _collapsed )   // Removed node item is created again outside of the group
+    {
+        qan::Node::Set nodes; nodes.insert( &node );
+        _scene.expandNodes( *this, nodes );
+        _proxyItem->updateItem( );
+    }
 
     // FIXME v1.0:
         // Reparent node to scene eventually
         // Remove every decoration items associed to node graphics item.
 
     updateGroup( );
+    _scene.updateNodeEdgeBundles( node );
 }
 
 void	NodeGroup::getRootNodes( qan::Node::Set& rootNodes )
@@ -515,6 +573,134 @@ void	NodeGroup::itemMoved( QPointF curPos, QPointF oldPos )
 //-----------------------------------------------------------------------------
 
 
+/* Group Collapse Management *///----------------------------------------------
+void	NodeGroup::setCollapsed( bool collapsed )
+{
+    if ( collapsed == _collapsed )
+        return;
+    NodeGroupProxyItem* proxyItem = getProxyItem( );
+    if ( collapsed )
+    {
+        foreach ( qan::Node* node, _nodes )
+        {
+            qan::NodeItem* nodeItem = qobject_cast< qan::NodeItem* >( node->getGraphItem( ) );
+            if ( nodeItem != 0 )
+                detachNodeItem( *nodeItem );
+        }
+        _collapsed = true;
+        _scene.collapseNodes( *this, _nodes );
+
+        // Group is reduced to its proxy item
+        proxyItem->updateItem( );
+        prepareGeometryChange( );
+        _expandedBr = _br;
+        _br = proxyItem->boundingRect( );
+        proxyItem->setVisible( true );
+        if ( _background != 0 )
+            _background->setVisible( false );
+    }
+    else
+    {
+        _collapsed = false;
+        proxyItem->setVisible( false );
+        if ( _background != 0 )
+            _background->setVisible( true );
+        prepareGeometryChange( );
+        _br = _expandedBr;
+
+        // Nodes items are created again, then laid out in the group
+        _scene.expandNodes( *this, _nodes );
+        foreach ( qan::Node* node, _nodes )
+        {
+            qan::NodeItem* nodeItem = qobject_cast< qan::NodeItem* >( node->getGraphItem( ) );
+            if ( nodeItem != 0 )
+                attachNodeItem( *nodeItem );
+        }
+        updateGroup( );
+    }
+    _scene.updateEdgeBundles( *this );
+    emit collapsedChanged( this, _collapsed );
+}
+
+NodeGroupProxyItem*	NodeGroup::getProxyItem( )
+{
+    if ( _proxyItem == 0 )
+    {
+        _proxyItem = new NodeGroupProxyItem( _scene, *this );
+        _proxyItem->setParentItem( this );
+        _proxyItem->setVisible( _collapsed );
+    }
+    return _proxyItem;
+}
+//-----------------------------------------------------------------------------
+
+
+/* NodeGroupProxyItem Object Management *///-----------------------------------
+NodeGroupProxyItem::NodeGroupProxyItem( GraphScene& scene, NodeGroup& nodeGroup ) :
+    GraphItem( scene ),
+    _nodeGroup( nodeGroup ),
+    _br( ),
+    _text( )
+{
+    setZValue( 1. );    // Over group background
+    updateItem( );
+}
+//-----------------------------------------------------------------------------
+
+
+/* NodeGroupProxyItem Graphics Item Management *///----------------------------
+void	NodeGroupProxyItem::paint( QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget )
+{
+    Q_UNUSED( option ); Q_UNUSED( widget );
+    QColor backColor( 190, 190, 190 );
+    QColor borderColor( 50, 50, 50 );
+    qan::Style* style = _styleManager.getTargetStyle( "qan::Node" );
+    if ( style != 0 && style->has( "Back Color" ) )
+        backColor = style->getColor( "Back Color" );
+    if ( style != 0 && style->has( "Border Color" ) )
+        borderColor = style->getColor( "Border Color" );
+
+    // Collapsed group is drawn as a node with a double border
+    painter->setPen( QPen( borderColor, 1. ) );
+    painter->setBrush( backColor );
+    painter->drawRoundedRect( _br.adjusted( 0.5, 0.5, -0.5, -0.5 ), 5., 5. );
+    painter->setBrush( Qt::NoBrush );
+    painter->drawRoundedRect( _br.adjusted( 3., 3., -3., -3. ), 3., 3. );
+    painter->setPen( Qt::black );
+    painter->drawText( _br, Qt::AlignCenter, _text );
+}
+
+void	NodeGroupProxyItem::updateItem( )
+{
+    _text = QString( "%1 (%2)" ).arg( _nodeGroup.getName( ) ).arg( _nodeGroup.getNodes( ).size( ) );
+    QFontMetricsF metrics( _scene.font( ) );
+    QRectF br( 0., 0., qMax( 80., metrics.width( _text ) + 20. ), metrics.height( ) + 20. );
+    if ( br != _br )
+    {
+        prepareGeometryChange( );
+        _br = br;
+    }
+    update( );
+}
+
+void	NodeGroupProxyItem::expandItem( bool expand )
+{
+    _nodeGroup.setCollapsed( !expand );
+}
+
+bool	NodeGroupProxyItem::itemExpandState( )
+{
+    return !_nodeGroup.isCollapsed( );
+}
+
+void	NodeGroupProxyItem::mouseDoubleClickEvent( QGraphicsSceneMouseEvent* e )
+{
+    expandItem( true );
+    e->accept( );
+}
+//-----------------------------------------------------------------------------
+
+
 /* Group Mouse Management *///-------------------------------------------------
 void	NodeGroup::mouseMoveEvent( QGraphicsSceneMouseEvent* e )
 {
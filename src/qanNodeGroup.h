@@ -44,6 +44,7 @@ namespace qan { // ::qan
 
 	class Grid;
 	class Layout;
+	class NodeGroupProxyItem;
 
 
     //! Model a group of nodes showing a consistent layout and behaviour.
@@ -107,6 +108,10 @@ namespace qan { // ::qan
 
 		virtual void	layout( );
 
+		//! Run the group graph layout on group nodes in a given rect, only nodes positions are modified (graphics items are left untouched).
+		/*! Since no graphics item is modified, several groups with distinct graph layouts could be laid out concurrently. */
+		virtual void	layoutContent( QRectF br );
+
 		Properties&		getProperties( ) { return _properties; }
 
 	protected:
@@ -184,8 +189,12 @@ namespace qan { // ::qan
 
         void					paint( QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget = 0 );
 
+        //! Layout group content, then update group nodes items, bounding rect and edges.
         virtual void            updateGroup( );
 
+        //! Update group nodes items, bounding rect and edges according to group nodes current positions.
+        virtual void            updateContent( );
+
         virtual void            setVisible( bool v );
 
     protected slots:
@@ -273,6 +282,45 @@ namespace qan { // ::qan
 	protected:
 
 		qan::Node::Set		_nodes;
+
+		//! Configure a group node item for this group layout (node item is reparented or inserted in graphics layout).
+		void				attachNodeItem( qan::NodeItem& nodeItem );
+
+		//! Remove a group node item from this group graphics layout before it is destroyed.
+		void				detachNodeItem( qan::NodeItem& nodeItem );
+		//@}
+		//---------------------------------------------------------------------
+
+
+
+		/*! \name Group Collapse Management *///-------------------------------
+		//@{
+	public:
+
+		//! Collapse or expand this group.
+		/*!	A collapsed group releases its nodes and internal edges graphics items and is shown as a single proxy node
+			(see getProxyItem()), edges connecting group nodes to other nodes are drawn to the proxy. A collapsed group
+			is neither laid out nor updated when edges are added. Node items are created again when the group is
+			expanded, so that only expanded groups content cost memory and updates. */
+		void				setCollapsed( bool collapsed );
+
+		bool				isCollapsed( ) const { return _collapsed; }
+
+		//! Get the item shown instead of this group content when it is collapsed (proxy is created on first collapse).
+		NodeGroupProxyItem*	getProxyItem( );
+
+	signals:
+
+		void				collapsedChanged( qan::NodeGroup* nodeGroup, bool collapsed );
+
+	protected:
+
+		bool				_collapsed;
+
+		//! Group bounding rect before collapse.
+		QRectF				_expandedBr;
+
+		NodeGroupProxyItem*	_proxyItem;
 		//@}
 		//---------------------------------------------------------------------
 
@@ -298,6 +346,92 @@ namespace qan { // ::qan
 		//@}
 		//---------------------------------------------------------------------
 	};
+
+
+	//! Single node item shown instead of a collapsed node group content (see NodeGroup::setCollapsed()).
+	/*!
+		Proxy is a child of its group, edges between collapsed group nodes and the rest of the graph are drawn to the
+		proxy (see GraphScene::getEndpointItem()). Double clicking the proxy expands its group.
+
+		\nosubgrouping
+	*/
+	class NodeGroupProxyItem : public GraphItem
+	{
+		Q_OBJECT
+
+		/*! \name NodeGroupProxyItem Object Management *///--------------------
+		//@{
+	public:
+
+		NodeGroupProxyItem( GraphScene& scene, NodeGroup& nodeGroup );
+
+		enum { Type = UserType + 42 + 6 };
+
+		virtual int				type( ) const { return Type; }
+
+		NodeGroup&				getNodeGroup( ) { return _nodeGroup; }
+
+		virtual QGraphicsItem*	getGraphicsItem( ) { return this; }
+
+	protected:
+
+		NodeGroup&				_nodeGroup;
+		//@}
+		//---------------------------------------------------------------------
+
+
+
+		/*! \name Rerouted Edges Management *///-------------------------------
+		//@{
+	public:
+
+		//! Register an edge drawn to this proxy (managed by graph scene).
+		void					addEdge( Edge& edge ) { _edges.insert( &edge ); }
+
+		void					removeEdge( Edge& edge ) { _edges.remove( &edge ); }
+
+		void					clearEdges( ) { _edges.clear( ); }
+
+		//! Get the edges connecting the collapsed group nodes to the rest of the graph.
+		const Edge::Set&		getEdges( ) const { return _edges; }
+
+	protected:
+
+		Edge::Set				_edges;
+		//@}
+		//---------------------------------------------------------------------
+
+
+
+		/*! \name Graphics Item Management *///--------------------------------
+		//@{
+	public:
+
+		virtual QRectF			boundingRect( ) const { return _br; }
+
+		void					paint( QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget = 0 );
+
+	public slots:
+
+		//! Update proxy size according to its group name and node count.
+		virtual void			updateItem( );
+
+		//! Expand (or collapse) the proxy group.
+		virtual	void			expandItem( bool expand );
+
+		//! Return false while the proxy group is collapsed.
+		virtual	bool			itemExpandState( );
+
+	protected:
+
+		virtual void			mouseDoubleClickEvent( QGraphicsSceneMouseEvent* e );
+
+		QRectF					_br;
+
+		QString					_text;
+		//@}
+		//---------------------------------------------------------------------
+	};
 } // ::qan
 //-----------------------------------------------------------------------------
 
@@ -27,6 +27,7 @@
 
 // QT headers
 #include <QFont>
+#include <QFontMetricsF>
 #include <QPainter>
 #include <QPixmap>
 #include <QGraphicsTextItem>
@@ -37,11 +38,13 @@
 #include <QTransform>
 #include <QMimeData>
 #include <QGraphicsLayout>
+#include <QStyleOptionGraphicsItem>
 
 // Qanava headers
 #include "./qanNodeItem.h"
 #include "./qanStyleManager.h"
 #include "./qanGraphScene.h"
+#include "./qanEdgeRouter.h"
 
 namespace qan {	// ::qan
 
@@ -49,7 +52,8 @@ namespace qan {	// ::qan
 LabelEditorItem::LabelEditorItem( QString text, QString defaultText, QGraphicsItem* parent, QGraphicsLayoutItem* parentLayout ) :
     QGraphicsTextItem( text, parent ),
     QGraphicsLayoutItem( parentLayout ),
-    _defaultText( defaultText )
+    _defaultText( defaultText ),
+    _lodThreshold( 0. )
 {
     setFlag( QGraphicsItem::ItemIsMovable, false );
     setTextInteractionFlags( Qt::NoTextInteraction );	// Text interaction will be activated only in qan::GraphScene when item is double clicked
@@ -64,12 +68,14 @@ LabelEditorItem::LabelEditorItem( QString text, QString defaultText, QGraphicsIt
     setSizePolicy( QSizePolicy::Expanding, QSizePolicy::Expanding );
 }
 
-/*void	LabelEditorItem::paint( QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget )
+void	LabelEditorItem::paint( QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget )
 {
+    // Rich text layout is expensive, and unreadable at low level of detail
+    if ( textInteractionFlags( ) == Qt::NoTextInteraction &&
+         QStyleOptionGraphicsItem::levelOfDetailFromTransform( painter->worldTransform( ) ) < _lodThreshold )
+        return;
     QGraphicsTextItem::paint( painter, option, widget );
-    painter->setPen( Qt::red );
-    painter->drawRect( boundingRect( ) );
-}*/
+}
 
 void	LabelEditorItem::keyPressEvent( QKeyEvent* e )
 {
@@ -159,20 +165,89 @@ QSizeF LabelEditorItem::sizeHint( Qt::SizeHint which, const QSizeF& constraint )
 //-----------------------------------------------------------------------------
 
 
+/* StaticLabelItem Management *///--------------------------------------------
+StaticLabelItem::StaticLabelItem( QGraphicsLayoutItem* parentLayout ) :
+    QGraphicsLayoutItem( parentLayout ),
+    _text( ),
+    _font( ),
+    _size( 10., 10. )
+{
+    _text.setTextFormat( Qt::RichText );    // Same text format than LabelEditorItem::setHtml()
+    _text.setPerformanceHint( QStaticText::AggressiveCaching );
+    setSizePolicy( QSizePolicy::Expanding, QSizePolicy::Expanding );
+}
+
+void    StaticLabelItem::setText( QString text, const QFont& font )
+{
+    if ( text == _text.text( ) && font == _font && !_size.isEmpty( ) )
+        return;
+    _text.setText( text );
+    _font = font;
+    _text.prepare( QTransform( ), _font );
+
+    // Use QTextDocument default margin, so that node size does not change when label is edited
+    const qreal margin = 4.;
+    QSizeF textSize = _text.size( );
+    textSize.setHeight( qMax( textSize.height( ), QFontMetricsF( _font ).height( ) ) );
+    _size = textSize + QSizeF( 2. * margin, 2. * margin );
+    updateGeometry( );
+}
+
+void    StaticLabelItem::paint( QPainter* painter )
+{
+    const qreal margin = 4.;
+    painter->setFont( _font );
+    painter->setPen( QColor( 40, 40, 40, 200 ) );
+    painter->drawStaticText( geometry( ).topLeft( ) + QPointF( margin, margin ), _text );
+}
+//-----------------------------------------------------------------------------
+
+
+/* Graphics layout item implementation *///------------------------------------
+void    StaticLabelItem::updateGeometry( )
+{
+    if ( parentLayoutItem( ) != 0 && parentLayoutItem( )->isLayout( ) )
+        static_cast< QGraphicsLayout* >( parentLayoutItem( ) )->invalidate( );
+    QGraphicsLayoutItem::updateGeometry( );
+}
+
+QSizeF  StaticLabelItem::sizeHint( Qt::SizeHint which, const QSizeF& constraint ) const
+{
+    switch ( which )
+    {
+    case Qt::MinimumSize:
+        return QSizeF( 10., 10. );
+    case Qt::PreferredSize:
+        return _size;
+    case Qt::MaximumSize:
+        return QSizeF( 1000, 1000 );
+    default:
+        break;
+    }
+    return constraint;
+}
+//-----------------------------------------------------------------------------
+
+
 /* NodeItem Object Management *///---------------------------------------------
 NodeItem::NodeItem( GraphScene& scene, Node& node, bool isMovable, bool showPropertiesWidget ) :
     GraphItem( scene ), QGraphicsLayout( 0 ),
 	_node( node ),
 	_scene( scene ),
     _br( QRectF( ) ),
+    _sceneShapeValid( false ),
     _labelItem( 0 ),
+    _staticLabel( 0 ),
     _dragOverItem( 0 ),
     _shadowColor( ),
 	_shadowOffset( QPointF( 4., 4. ) ),
-	_shadowEffect( 0 ),
+	_shadowBlur( 2. ),
+	_shadowMargin( 0. ),
     _itemPen( QPen( Qt::black ) ),
     _itemBrush( Qt::NoBrush ),
     _borderWidth( 1.0 ),
+    _lodTier( LodFull ),
+    _lodBrush( Qt::NoBrush ),
     _mousePos( -1. , -1. ),
     _mousePressed( false ),
 	_isMovable( isMovable ),
@@ -188,9 +263,14 @@ NodeItem::NodeItem( GraphScene& scene, Node& node, bool isMovable, bool showProp
     setAcceptHoverEvents( false );
     setZValue( 2.0 );
 
-    _labelItem = new LabelEditorItem( getNode( ).getLabel( ), "<< label >>", this, _layout );
-    _labelItem->setZValue( zValue( ) + 2. );
-    _labelItem->setPos( QPointF( 0., 0. ) );
+    if ( scene.hasFastLabels( ) )
+        _staticLabel = new StaticLabelItem( _layout );
+    else
+    {
+        _labelItem = new LabelEditorItem( getNode( ).getLabel( ), "<< label >>", this, _layout );
+        _labelItem->setZValue( zValue( ) + 2. );
+        _labelItem->setPos( QPointF( 0., 0. ) );
+    }
 
     setGraphicsItem( this );
     setMinimumSize( QSizeF( 18., 18. ) );
@@ -199,7 +279,10 @@ NodeItem::NodeItem( GraphScene& scene, Node& node, bool isMovable, bool showProp
         activatePropertiesPopup( node.getProperties( ), 500, true );
 }
 
-NodeItem::~NodeItem( ) { }
+NodeItem::~NodeItem( )
+{
+    delete _staticLabel;    // Static label is not a graphics item, it is not destroyed with child items
+}
 //-----------------------------------------------------------------------------
 
 
@@ -207,10 +290,23 @@ NodeItem::~NodeItem( ) { }
 QPainterPath	NodeItem::shape( ) const
 {
 	QPainterPath qpp;
-	qpp.addRect( boundingRect( ) );
+	qpp.addRect( _br );
 	return qpp;
 }
 
+QPolygonF	NodeItem::getSceneShapePolygon( )
+{
+	QPointF sceneShapePos = scenePos( );
+	if ( !_sceneShapeValid || _sceneShapeBr != _br || _sceneShapePos != sceneShapePos )
+	{
+		_sceneShape = GraphItem::getSceneShapePolygon( );
+		_sceneShapeBr = _br;
+		_sceneShapePos = sceneShapePos;
+		_sceneShapeValid = true;
+	}
+	return _sceneShape;
+}
+
 void	NodeItem::updateItem( )
 {
 	qan::Style* style = _styleManager.getStyle( getNode( ) );
@@ -220,13 +316,17 @@ void	NodeItem::updateItem( )
 		if ( style != 0 )
 			_styleManager.styleNode( _node, style->getName( ) );
 	}
+	updateLodThresholds( style );
+	if ( _labelItem != 0 )
+		_labelItem->setLodThreshold( _lodFullDetail );
+
 	QColor backColor = QColor( 255, 255, 255 );
 	if ( style != 0 && style->has( "Back Color" ) )
 	{
 		backColor = style->getColor( "Back Color" );
         if ( backColor == Qt::white )
             backColor = QColor( 225, 225, 225 );
-        QRectF br = boundingRect( );
+        QRectF br = _br;
         QLinearGradient gradient( br.topLeft( ), br.bottomRight( ) );
         gradient.setColorAt( 0., Qt::white );
         gradient.setColorAt( 1., backColor );
@@ -234,8 +334,12 @@ void	NodeItem::updateItem( )
         //_itemBrush.setColor( backColor );
         _itemBrush = QBrush( gradient );
 	}
+    _lodBrush = QBrush( backColor );
 	if ( style != 0 && style->has( "No Background" ) && style->get( "No Background" ).toBool( ) )
+    {
         _itemBrush.setStyle( Qt::NoBrush );
+        _lodBrush.setStyle( Qt::NoBrush );
+    }
 
 	QColor borderColor = QColor( 0, 0, 0 );
 	Qt::PenStyle borderStyle = Qt::SolidLine;
@@ -254,6 +358,7 @@ void	NodeItem::updateItem( )
     if ( style != 0 && style->has( "Border Width" ) )
         _borderWidth = style->get( "Border Width" ).toFloat( );
 
+    // Shadow is painted by sub classes from a style manager cached pixmap, bounding rect is enlarged to contain it
     bool hasShadow = false;
     if ( style != 0 && style->has( "Has Shadow" ) )
         hasShadow = style->get( "Has Shadow" ).toBool( );
@@ -269,23 +374,17 @@ void	NodeItem::updateItem( )
             QSizeF shadowOffset = style->get( "Shadow Offset" ).toSizeF( );
             _shadowOffset = QPointF( shadowOffset.width( ), shadowOffset.height( ) );
         }
-
-        if ( _shadowEffect == 0 )
-            _shadowEffect = new QGraphicsDropShadowEffect( this );
-        if ( _shadowEffect != 0 )
-        {
-            _shadowEffect->setColor( _shadowColor );
-            _shadowEffect->setOffset( _shadowOffset );
-            _shadowEffect->setBlurRadius( 2.0 );
-            _shadowEffect->setEnabled( true );
-            setGraphicsEffect( _shadowEffect );
-        }
+        _shadowBlur = 2.;
+        if ( style->has( "Shadow Blur" ) )
+            _shadowBlur = style->get( "Shadow Blur" ).toReal( );
     }
     else
-    {
-        if ( _shadowEffect != 0 )
-            _shadowEffect->setEnabled( false );
         _shadowColor = QColor( ); // Invalid color since there is no shadow
+    qreal shadowMargin = ( _shadowColor.isValid( ) ? StyleManager::getShadowMargin( _shadowOffset, _shadowBlur ) : 0. );
+    if ( !qFuzzyCompare( 1. + shadowMargin, 1. + _shadowMargin ) )
+    {
+        prepareGeometryChange( );
+        _shadowMargin = shadowMargin;
     }
 
     // Compute the _label size once it is laid out as rich text html
@@ -294,7 +393,13 @@ void	NodeItem::updateItem( )
         if ( style != 0 && style->has( "Font" ) )
             font = style->get( "Font" ).value< QFont >( );
 
-        if ( _labelItem != 0 )
+        if ( _staticLabel != 0 && _labelItem == 0 && _layout != 0 )
+        {
+            _staticLabel->setText( getNode( ).getLabel( ), font );
+            prepareGeometryChange( );
+            _br.setSize( _layout->preferredSize( ) );
+        }
+        else if ( _labelItem != 0 && _staticLabel == 0 )
         {
             _labelItem->setHtml( getNode( ).getLabel( ) );
             _labelItem->setFont( font );
@@ -308,10 +413,7 @@ void	NodeItem::updateItem( )
     }
 
     // Update edges
-    foreach ( Edge* edge, _node.getOutEdges( ) )
-        edge->getGraphItem( )->updateItem( );
-    foreach ( Edge* edge, _node.getInEdges( ) )
-        edge->getGraphItem( )->updateItem( );
+    _scene.scheduleNodeEdgesUpdate( _node );
 
     updateGeometry( );
 }
@@ -326,18 +428,67 @@ void	NodeItem::updateItemStyle( )
 /* NodeItem Drawing Management *///--------------------------------------------
 void	NodeItem::paint( QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget )
 {
-    Q_UNUSED( painter ); Q_UNUSED( option ); Q_UNUSED( widget );
+    Q_UNUSED( option ); Q_UNUSED( widget );
 
-	if ( !_shadowColor.isValid( ) && _shadowEffect != 0 )
-		_shadowEffect->setEnabled( false );
+    updateLodTier( getLodTier( getLod( painter ) ) );
+    if ( _lodTier != LodFull )
+        return;
     painter->setPen( Qt::red );
-    painter->drawRect( boundingRect( ) );
+    painter->drawRect( _br );
+}
+
+void	NodeItem::updateLodTier( LodTier lodTier )
+{
+    _lodTier = lodTier;
 }
 
 void	NodeItem::labelTextModified( )
 {
+    if ( _labelItem == 0 )
+        return;
     getNode( ).setLabel( _labelItem->toPlainText( ) );
+    if ( _staticLabel != 0 )
+    {
+        // Editor is only needed while editing in fast label mode (it is destroyed later since it is emitting)
+        _labelItem->deleteLater( );
+        _labelItem = 0;
+    }
     updateItem( );
+    update( );
+}
+
+QGraphicsLayoutItem*	NodeItem::getLabelLayoutItem( )
+{
+    if ( _staticLabel != 0 )
+        return _staticLabel;
+    return _labelItem;
+}
+
+void	NodeItem::paintLabel( QPainter* painter )
+{
+    if ( _staticLabel != 0 && _labelItem == 0 && _lodTier == LodFull )
+        _staticLabel->paint( painter );
+}
+
+void	NodeItem::editLabel( )
+{
+    if ( _staticLabel == 0 || _labelItem != 0 )
+        return;
+    QFont font;
+    qan::Style* style = _styleManager.getStyle( getNode( ) );
+    if ( style != 0 && style->has( "Font" ) )
+        font = style->get( "Font" ).value< QFont >( );
+
+    // Editor is not inserted in node layout, node keeps its static label size while the label is edited
+    _labelItem = new LabelEditorItem( getNode( ).getLabel( ), "<< label >>", this, 0 );
+    _labelItem->setHtml( getNode( ).getLabel( ) );
+    _labelItem->setFont( font );
+    _labelItem->setZValue( zValue( ) + 2. );
+    _labelItem->setPos( _staticLabel->geometry( ).topLeft( ) );
+    connect( _labelItem, SIGNAL( textModified( ) ), this, SLOT( labelTextModified( ) ) );
+    _labelItem->setTextInteractionFlags( Qt::TextEditorInteraction );
+    _labelItem->setFocus( Qt::MouseFocusReason );
+    update( );
 }
 
 /* Mouse Move/Drag Management *///---------------------------------------------
@@ -347,11 +498,28 @@ QVariant	NodeItem::itemChange( GraphicsItemChange change, const QVariant& value
 	{
 		//if ( !qFuzzyCompare( ( _node.getPosition( ) - pos( ) ).manhattanLength( ), 0. ) )
 		{
+			// Tiles cached under the node previous and new areas must be rasterized again
+			_scene.addDirtyRect( sceneBoundingRect( ).translated( _node.getPosition( ) - pos( ) ) );
+			_scene.addDirtyRect( sceneBoundingRect( ) );
 			_node.setPosition( pos( ) );
-			foreach ( Edge* edge, _node.getOutEdges( ) )
-				edge->getGraphItem( )->updateItem( );
-			foreach ( Edge* edge, _node.getInEdges( ) )
-				edge->getGraphItem( )->updateItem( );
+			_sceneShapeValid = false;
+
+			// While the scene is batching moves, edges are updated once when the batch ends
+			if ( _scene.isBatching( ) )
+			{
+				_scene.addBatchNode( _node );
+				return QGraphicsItem::itemChange( change, value );
+			}
+
+			// Invalidate routes before updating edges, routes crossing the node new or previous position must be updated too
+			Edge::Set rerouted;
+			if ( _scene.hasEdgeRouter( ) )
+				_scene.getEdgeRouter( ).nodeMoved( _node, rerouted );
+
+			// Edges are updated once per frame, whatever the number of moves of their endpoints
+			_scene.scheduleNodeEdgesUpdate( _node );
+			if ( !rerouted.isEmpty( ) )
+				_scene.updateReroutedEdges( rerouted );
 		}
 	}
 	return 	QGraphicsItem::itemChange( change, value );
@@ -41,10 +41,10 @@
 #include <QGraphicsRectItem>
 #include <QGraphicsTextItem>
 #include <QGraphicsProxyWidget>
-#include <QGraphicsDropShadowEffect>
 #include <QGraphicsSceneDragDropEvent>
 #include <QGraphicsLayoutItem>
 #include <QGraphicsLinearLayout>
+#include <QStaticText>
 
 // QT Solutions (qtpropertybrowser) headers
 #include "QtVariantProperty"
@@ -69,6 +69,11 @@ namespace qan { // ::qan
         enum { Type = UserType + 42 };
 
         virtual	int		type( ) const { return Type; }
+
+        //! Label is not drawn under a given level of detail (except while it is edited).
+        void            setLodThreshold( qreal lodThreshold ) { _lodThreshold = lodThreshold; }
+
+        virtual void	paint( QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget = 0 );
     private:
         Q_DISABLE_COPY( LabelEditorItem );
 
@@ -81,6 +86,8 @@ namespace qan { // ::qan
 
         QString			_defaultText;
 
+        qreal           _lodThreshold;
+
     signals:
         void			textModified( );
         //@}
@@ -98,6 +105,46 @@ namespace qan { // ::qan
     };
 
 
+    //! Models a static node label drawn by its node item with a cached QStaticText (used in fast label mode).
+    /*! Label is a graphics layout item without graphics item: its size is computed once when its text or font
+        changes, and it is painted by its node item with paintLabel(). See GraphScene::setFastLabels(). */
+    class StaticLabelItem : public QGraphicsLayoutItem
+    {
+        /*! \name StaticLabelItem Management *///------------------------------
+        //@{
+    public:
+        StaticLabelItem( QGraphicsLayoutItem* parentLayout );
+
+        //! Set label rich text and font, label metrics are computed once here.
+        void            setText( QString text, const QFont& font );
+
+        //! Paint label at its layout geometry, painter must be in label parent item CS.
+        void            paint( QPainter* painter );
+
+    private:
+        Q_DISABLE_COPY( StaticLabelItem );
+
+    protected:
+        QStaticText     _text;
+
+        QFont           _font;
+
+        //! Label size, including a margin equivalent to LabelEditorItem document margin.
+        QSizeF          _size;
+        //@}
+        //---------------------------------------------------------------------
+
+
+        /* Graphics layout item implementation *///----------------------------
+    public:
+        virtual void    updateGeometry( );
+
+    protected:
+        virtual QSizeF  sizeHint( Qt::SizeHint which, const QSizeF & constraint = QSizeF( ) ) const;
+        //---------------------------------------------------------------------
+    };
+
+
     //! Model an abstract node item in a Qt graphics view, with built-in style and graphics layout support.
     /*! FIXME: deprecated documentation.
 
@@ -146,9 +193,18 @@ namespace qan { // ::qan
     public:
         virtual QGraphicsItem*  getGraphicsItem( ) { return static_cast< QGraphicsItem* >( this ); }
 
-        virtual QRectF          boundingRect( ) const { return _br; }
+        //! Node bounding rect, including the area where a shadow could be painted (see getSceneContentRect()).
+        virtual QRectF          boundingRect( ) const { return _br.adjusted( -_shadowMargin, -_shadowMargin, _shadowMargin, _shadowMargin ); }
         virtual QPainterPath	shape( ) const;
 
+        //! Node content rect in scene CS, without its shadow.
+        virtual QRectF          getSceneContentRect( ) { return mapRectToScene( _br ); }
+
+        //! Node shape polygon in scene CS, polygon is cached until node scene position or size changes.
+        /*! Scene position is checked explicitly: nodes in a graph layout group do not send scene position changes,
+            their cached shape must still follow the group when it is dragged. */
+        virtual QPolygonF       getSceneShapePolygon( );
+
     public slots:
         virtual void            updateItem( );
         virtual void            updateItemStyle( );
@@ -156,6 +212,16 @@ namespace qan { // ::qan
     protected:
         QRectF&                 getBr( ) { return _br; }
         QRectF                  _br;
+
+        //! Invalidate the cached scene shape polygon, call when node shape changes without its position or size changing.
+        void                    invalidateSceneShape( ) { _sceneShapeValid = false; }
+
+        QPolygonF               _sceneShape;
+        //! Node content rect the cached scene shape has been computed for.
+        QRectF                  _sceneShapeBr;
+        //! Node scene position the cached scene shape has been computed for.
+        QPointF                 _sceneShapePos;
+        bool                    _sceneShapeValid;
         //@}
         //---------------------------------------------------------------------
 
@@ -170,14 +236,38 @@ namespace qan { // ::qan
         void            labelTextModified( );
 
     protected:
+        //! Update the level of detail tier node has been drawn with (shadow and label are drawn only at full detail).
+        void            updateLodTier( LodTier lodTier );
+
+        LodTier                     _lodTier;
+        QBrush                      _lodBrush;
+
+    public:
+        //! Create a label editor over a static label and give it focus (fast label mode only, see GraphScene::setFastLabels()).
+        void                        editLabel( );
+
+        bool                        hasStaticLabel( ) const { return _staticLabel != 0; }
+
+    protected:
+        //! Label editor, 0 in fast label mode when label is not being edited.
         LabelEditorItem*			getLabelItem( ) { return _labelItem; }
 
+        //! Return the layout item used for node label (either the static label or the label editor).
+        QGraphicsLayoutItem*        getLabelLayoutItem( );
+
+        //! Paint the static label at full level of detail (sub classes call it once their content is painted).
+        void                        paintLabel( QPainter* painter );
+
         LabelEditorItem*			_labelItem;
+        StaticLabelItem*            _staticLabel;
         QGraphicsItem*              _dragOverItem;
 
+        //! Shadow color, invalid when node has no shadow.
         QColor						_shadowColor;
         QPointF						_shadowOffset;
-        QGraphicsDropShadowEffect*	_shadowEffect;
+        qreal						_shadowBlur;
+        //! Distance from node content rect to its bounding rect, where a shadow could be painted (0. when node has no shadow).
+        qreal						_shadowMargin;
         QPen                        _itemPen;
         QBrush                      _itemBrush;
         qreal                       _borderWidth;
@@ -57,9 +57,9 @@ NodeRectItem::NodeRectItem( GraphScene& scene, Node& node, bool isMovable, bool
     setLayout( layout );
     layout->setContentsMargins( 2., 2., 2., 2. );
 
-    Q_ASSERT( getLabelItem( ) != 0 );
-    getLabelItem( )->setParentLayoutItem( getLayout( ) );
-    layout->addItem( getLabelItem( ) );
+    Q_ASSERT( getLabelLayoutItem( ) != 0 );
+    getLabelLayoutItem( )->setParentLayoutItem( getLayout( ) );
+    layout->addItem( getLabelLayoutItem( ) );
 
     prepareGeometryChange( );
     _br.setSize( getLayout( )->preferredSize( ) );
@@ -73,10 +73,10 @@ NodeRectItem::NodeRectItem( GraphScene& scene, Node& node, bool isMovable, bool
 
 NodeRectItem::~NodeRectItem( )
 {
-    if ( getLayout( ) != 0 && getLabelItem( ) != 0 )
+    if ( getLayout( ) != 0 && getLabelLayoutItem( ) != 0 )
     {
         QGraphicsLinearLayout* layout = static_cast< QGraphicsLinearLayout* >( getLayout( ) );
-        layout->removeItem( getLabelItem( ) );
+        layout->removeItem( getLabelLayoutItem( ) );
     }
 }
 //-----------------------------------------------------------------------------
@@ -89,22 +89,38 @@ void    NodeRectItem::paint( QPainter* painter, const QStyleOptionGraphicsItem*
 
     Q_UNUSED( option ); Q_UNUSED( widget );
 
+    QRectF br = _br;
+    if ( _lodTier == LodDot )
+    {
+        painter->fillRect( br, _itemPen.color( ) );
+        return;
+    }
+    if ( _lodTier == LodMinimal )
+    {
+        painter->setPen( QPen( _itemPen.color( ), 0. ) );    // Cosmetic pen
+        painter->setBrush( _lodBrush );
+        painter->drawRect( br );
+        return;
+    }
+
     qreal   shapeRadius( 4. );
+    if ( _lodTier == LodFull && _shadowColor.isValid( ) && _itemBrush.style( ) != Qt::NoBrush )    // Only shadow opaque nodes
+        _styleManager.drawShadow( painter, br, _shadowColor, _shadowOffset, _shadowBlur, shapeRadius );
     painter->setPen( _itemPen );
     painter->setBrush( _itemBrush );
-    QRectF br = boundingRect( );
     QRectF roundedRect = br.adjusted( _borderWidth / 2., _borderWidth / 2, -_borderWidth / 2., -_borderWidth / 2);
     painter->drawRoundedRect( roundedRect, shapeRadius, shapeRadius );
 
-    if ( _layout )
+    if ( _layout && _lodTier == LodFull && !hasStaticLabel( ) )   // Label is not drawn at lower tiers
         _layout->invalidate( );
+    paintLabel( painter );
 }
 
 QPainterPath	NodeRectItem::shape( ) const
 {
     QPainterPath path;
     qreal shapeRadius( 4. );
-    path.addRoundedRect( boundingRect( ), shapeRadius, shapeRadius );
+    path.addRoundedRect( _br, shapeRadius, shapeRadius );
     return path;
 }
 //-----------------------------------------------------------------------------
@@ -0,0 +1,235 @@
+/*
+	Copyright (C) 2008-2015 Benoit AUTHEMAN
+
+    This file is part of Qanava.
+
+    Qanava is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Qanava is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with Qanava.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//-----------------------------------------------------------------------------
+// This file is a part of the Qanava software.
+//
+// \file	qanOverlapRemoval.cpp
+// \author	benoit@qanava.org
+// \date	2015 October 19
+//-----------------------------------------------------------------------------
+
+// Qt headers
+#include <QMap>
+#include <QPair>
+#include <QtAlgorithms>
+
+// Qanava headers
+#include "./qanOverlapRemoval.h"
+
+
+namespace qan { // ::qan
+
+
+/* Overlap Removal Management *///---------------------------------------------
+static bool	nodeLessThan( const Node* a, const Node* b )
+{
+	int labelOrder = QString::compare( a->getLabel( ), b->getLabel( ) );
+	if ( labelOrder != 0 )
+		return labelOrder < 0;
+	return a->getSerial( ) < b->getSerial( );	// Nodes creation order, not their address
+}
+
+void	OverlapRemoval::layout( qan::Node::List& rootNodes, qan::Node::Set& nodes, QRectF br, qan::Node* center, QProgressDialog* progress )
+{
+	_iterationCount = 0;
+	if ( _layout != 0 )
+	{
+		_layout->layout( rootNodes, nodes, br, center, progress );
+		_iterationCount = _layout->getIterationCount( );
+	}
+
+	// Sort nodes so that result does not depend on set order
+	QVector< Node* > sortedNodes;
+	sortedNodes.reserve( nodes.size( ) );
+	foreach ( Node* node, nodes )
+		sortedNodes << node;
+	qSort( sortedNodes.begin( ), sortedNodes.end( ), nodeLessThan );
+
+	qreal margin = _spacing / 2.;
+	QVector< QRectF > rects( sortedNodes.size( ) );
+	for ( int n = 0; n < sortedNodes.size( ); n++ )
+		rects[ n ] = QRectF( sortedNodes[ n ]->getPosition( ), getNodeSize( *sortedNodes[ n ] ) ).adjusted( -margin, -margin, margin, margin );
+	removeOverlaps( rects );
+	for ( int n = 0; n < sortedNodes.size( ); n++ )
+		sortedNodes[ n ]->setPosition( rects[ n ].topLeft( ) + QPointF( margin, margin ) );
+}
+
+QString	OverlapRemoval::getParameters( ) const
+{
+	return QString( "qan::OverlapRemoval %1 (%2)" ).arg( _spacing ).arg( _layout != 0 ? _layout->getParameters( ) : QString( ) );
+}
+
+static void	sortCenters( const QVector< qreal >& centers, QVector< int >& order )
+{
+	QVector< QPair< qreal, int > > keys( centers.size( ) );
+	for ( int i = 0; i < centers.size( ); i++ )
+		keys[ i ] = qMakePair( centers[ i ], i );
+	qSort( keys );
+	order.resize( centers.size( ) );
+	for ( int i = 0; i < keys.size( ); i++ )
+		order[ i ] = keys[ i ].second;
+}
+
+void	OverlapRemoval::removeOverlaps( QVector< QRectF >& rects )
+{
+	if ( rects.size( ) < 2 )
+		return;
+
+	QVector< Constraint > constraints;
+	QVector< qreal > centers( rects.size( ) );
+	QVector< int > order;
+
+	// Horizontal pass
+	generateConstraints( rects, true, constraints );
+	for ( int r = 0; r < rects.size( ); r++ )
+		centers[ r ] = rects[ r ].center( ).x( );
+	sortCenters( centers, order );
+	solveConstraints( centers, order, constraints );
+	for ( int r = 0; r < rects.size( ); r++ )
+		rects[ r ].moveCenter( QPointF( centers[ r ], rects[ r ].center( ).y( ) ) );
+
+	// Vertical pass, separating all pairs still overlapping on x
+	constraints.resize( 0 );
+	generateConstraints( rects, false, constraints );
+	for ( int r = 0; r < rects.size( ); r++ )
+		centers[ r ] = rects[ r ].center( ).y( );
+	sortCenters( centers, order );
+	solveConstraints( centers, order, constraints );
+	for ( int r = 0; r < rects.size( ); r++ )
+		rects[ r ].moveCenter( QPointF( rects[ r ].center( ).x( ), centers[ r ] ) );
+}
+
+struct ScanEvent
+{
+	qreal	position;
+	bool	open;
+	int		rect;
+};
+
+static bool	scanEventLessThan( const ScanEvent& a, const ScanEvent& b )
+{
+	if ( a.position != b.position )
+		return a.position < b.position;
+	if ( a.open != b.open )
+		return !a.open;		// Close before open, touching rectangles do not overlap
+	return a.rect < b.rect;
+}
+
+/*!
+	The scan line moves along the other axis, active rectangles are ordered by center. When a rectangle is
+	opened, it is constrained with its left and right neighbours, when it is closed, its neighbours are
+	constrained together. In the horizontal pass, overlapping pairs whose vertical overlap is smaller than the
+	horizontal one are not constrained (they are separated by the vertical pass).
+ */
+void	OverlapRemoval::generateConstraints( const QVector< QRectF >& rects, bool horizontal, QVector< Constraint >& constraints )
+{
+	QVector< ScanEvent > events;
+	events.reserve( 2 * rects.size( ) );
+	for ( int r = 0; r < rects.size( ); r++ )
+	{
+		ScanEvent open = { horizontal ? rects[ r ].top( ) : rects[ r ].left( ), true, r };
+		ScanEvent close = { horizontal ? rects[ r ].bottom( ) : rects[ r ].right( ), false, r };
+		events << open << close;
+	}
+	qSort( events.begin( ), events.end( ), scanEventLessThan );
+
+	typedef QMap< QPair< qreal, int >, int > ScanLine;
+	ScanLine scanLine;
+	QVector< QPair< int, int > > pairs;
+	foreach ( const ScanEvent& event, events )
+	{
+		const QRectF& rect = rects[ event.rect ];
+		QPair< qreal, int > key( horizontal ? rect.center( ).x( ) : rect.center( ).y( ), event.rect );
+		if ( event.open )
+		{
+			ScanLine::iterator item = scanLine.insert( key, event.rect );
+			if ( item != scanLine.begin( ) )
+				pairs << qMakePair( ( item - 1 ).value( ), event.rect );
+			if ( item + 1 != scanLine.end( ) )
+				pairs << qMakePair( event.rect, ( item + 1 ).value( ) );
+		}
+		else
+		{
+			ScanLine::iterator item = scanLine.find( key );
+			if ( item == scanLine.end( ) )
+				continue;
+			if ( item != scanLine.begin( ) && item + 1 != scanLine.end( ) )
+				pairs << qMakePair( ( item - 1 ).value( ), ( item + 1 ).value( ) );
+			scanLine.erase( item );
+		}
+	}
+
+	for ( int p = 0; p < pairs.size( ); p++ )
+	{
+		const QRectF& left = rects[ pairs[ p ].first ];
+		const QRectF& right = rects[ pairs[ p ].second ];
+		qreal gap = ( horizontal ? left.width( ) + right.width( ) : left.height( ) + right.height( ) ) / 2.;
+		if ( horizontal )
+		{
+			qreal overlapX = gap - ( right.center( ).x( ) - left.center( ).x( ) );
+			qreal overlapY = qMin( left.bottom( ), right.bottom( ) ) - qMax( left.top( ), right.top( ) );
+			if ( overlapX > 0. && overlapY > 0. && overlapY < overlapX )
+				continue;
+		}
+		Constraint constraint = { pairs[ p ].first, pairs[ p ].second, gap };
+		constraints << constraint;
+	}
+}
+
+/*!
+	Constraints always go from a rectangle to a rectangle after it in order. The forward sweep pushes rectangles
+	to the right (minimal right displacements), the backward sweep pushes them to the left. Both solutions satisfy
+	every constraint, so does their average.
+ */
+void	OverlapRemoval::solveConstraints( QVector< qreal >& centers, const QVector< int >& order, const QVector< Constraint >& constraints )
+{
+	int n = centers.size( );
+	QVector< QVector< int > > incoming( n );
+	QVector< QVector< int > > outgoing( n );
+	for ( int c = 0; c < constraints.size( ); c++ )
+	{
+		incoming[ constraints[ c ].right ] << c;
+		outgoing[ constraints[ c ].left ] << c;
+	}
+
+	QVector< qreal > forward( centers );
+	for ( int o = 0; o < n; o++ )
+	{
+		int v = order[ o ];
+		foreach ( int c, incoming[ v ] )
+			forward[ v ] = qMax( forward[ v ], forward[ constraints[ c ].left ] + constraints[ c ].gap );
+	}
+
+	QVector< qreal > backward( centers );
+	for ( int o = n - 1; o >= 0; o-- )
+	{
+		int v = order[ o ];
+		foreach ( int c, outgoing[ v ] )
+			backward[ v ] = qMin( backward[ v ], backward[ constraints[ c ].right ] - constraints[ c ].gap );
+	}
+
+	for ( int v = 0; v < n; v++ )
+		centers[ v ] = ( forward[ v ] + backward[ v ] ) / 2.;
+}
+//-----------------------------------------------------------------------------
+
+
+} // ::qan
+
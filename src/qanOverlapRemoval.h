@@ -0,0 +1,114 @@
+/*
+	Copyright (C) 2008-2015 Benoit AUTHEMAN
+
+    This file is part of Qanava.
+
+    Qanava is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Qanava is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with Qanava.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//-----------------------------------------------------------------------------
+// This file is a part of the Qanava software.
+//
+// \file	qanOverlapRemoval.h
+// \author	benoit@qanava.org
+// \date	2015 October 19
+//-----------------------------------------------------------------------------
+
+
+#ifndef qanOverlapRemoval_h
+#define qanOverlapRemoval_h
+
+
+// Qanava headers
+#include "./qanLayout.h"
+
+
+// QT headers
+#include <QVector>
+#include <QRectF>
+
+
+//-----------------------------------------------------------------------------
+namespace qan { // ::qan
+
+	//! Remove nodes overlaps after an optional layout, keeping nodes relative order.
+	/*!
+		Overlaps are removed in two passes using real node sizes (see Layout::getNodeSize()). The horizontal
+		pass generates separation constraints between immediate neighbours on a scan line (Dwyer, Marriott and
+		Stuckey), skipping overlapping pairs that are cheaper to separate vertically. The vertical pass then
+		separates every remaining pair. Each pass solves its constraints with a forward (push right) and a
+		backward (push left) sweep whose feasible solutions are averaged, so nodes move symmetrically and never
+		swap. Overall complexity is O(n.log(n)).
+
+		\nosubgrouping
+	*/
+	class OverlapRemoval : public Layout
+	{
+		Q_OBJECT
+
+		/*! \name OverlapRemoval Constructor/Destructor *///--------------------
+		//@{
+	public:
+
+		//! OverlapRemoval constructor, wrapped layout ownership goes to this layout.
+		/*!	\param	layout	Optional layout applied before overlap removal (0 to only remove overlaps in current positions).
+			\param	spacing	Minimum distance between nodes.	*/
+		OverlapRemoval( Layout* layout = 0, qreal spacing = 10. ) : Layout( ), _layout( layout ), _spacing( spacing ) { }
+
+		virtual ~OverlapRemoval( ) { delete _layout; }
+
+	protected:
+
+		Layout*			_layout;
+
+		qreal			_spacing;
+		//@}
+		//---------------------------------------------------------------------
+
+
+
+		/*! \name Overlap Removal Management *///------------------------------
+		//@{
+	public:
+
+		virtual void	layout( qan::Node::List& rootNodes, qan::Node::Set& nodes, QRectF br, qan::Node* center, QProgressDialog* progress = 0 );
+
+		virtual QString	getParameters( ) const;
+
+		//! Move rectangles so that they no longer overlap.
+		static void		removeOverlaps( QVector< QRectF >& rects );
+
+	protected:
+
+		struct Constraint
+		{
+			int		left;
+			int		right;
+			qreal	gap;
+		};
+
+		//! Generate separation constraints between neighbours along a scan line (horizontal separation if horizontal is true).
+		static void		generateConstraints( const QVector< QRectF >& rects, bool horizontal, QVector< Constraint >& constraints );
+
+		//! Solve separation constraints for rectangles centers along one axis, order must be sorted by center.
+		static void		solveConstraints( QVector< qreal >& centers, const QVector< int >& order, const QVector< Constraint >& constraints );
+		//@}
+		//---------------------------------------------------------------------
+	};
+} // ::qan
+//-----------------------------------------------------------------------------
+
+
+#endif // qanOverlapRemoval_h
+
@@ -0,0 +1,114 @@
+/*
+	Copyright (C) 2008-2015 Benoit AUTHEMAN
+
+    This file is part of Qanava.
+
+    Qanava is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Qanava is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with Qanava.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//-----------------------------------------------------------------------------
+// This file is a part of the Qanava software.
+//
+// \file	qanPaintStatistics.cpp
+// \author	benoit@qanava.org
+// \date	2015 October 24
+//-----------------------------------------------------------------------------
+
+// Qanava headers
+#include "./qanPaintStatistics.h"
+
+
+namespace qan { // ::qan
+
+
+/* PaintStatistics Constructor/Destructor *///---------------------------------
+PaintStatistics::PaintStatistics( )
+{
+	reset( );
+}
+
+void	PaintStatistics::reset( )
+{
+	_paintedItems.clear( );
+	_edgeUpdateCount = 0;
+	_exposedArea = 0;
+	_backgroundTime = 0.;
+
+	_frameCount = 0;
+	_frameTimeHistogram = QVector< int >( getHistogramBounds( ).size( ) + 1, 0 );
+	_totalFrameTime = 0.;
+	_maxFrameTime = 0.;
+	_lastFrameTime = 0.;
+	_lastPaintedItems.clear( );
+	_lastEdgeUpdateCount = 0;
+	_totalEdgeUpdateCount = 0;
+	_lastExposedArea = 0;
+	_lastBackgroundTime = 0.;
+}
+//-----------------------------------------------------------------------------
+
+
+
+/* Counters Management *///----------------------------------------------------
+void	PaintStatistics::beginFrame( qint64 exposedArea )
+{
+	// Edge updates occuring since last frame are counted in this frame
+	_paintedItems.clear( );
+	_exposedArea = exposedArea;
+	_backgroundTime = 0.;
+}
+
+void	PaintStatistics::endFrame( qreal frameTime )
+{
+	QVector< qreal > bounds = getHistogramBounds( );
+	int bucket = 0;
+	while ( bucket < bounds.size( ) && frameTime >= bounds[ bucket ] )
+		bucket++;
+	_frameTimeHistogram[ bucket ]++;
+	_frameCount++;
+	_totalFrameTime += frameTime;
+	_maxFrameTime = qMax( _maxFrameTime, frameTime );
+	_lastFrameTime = frameTime;
+
+	_lastPaintedItems = _paintedItems;
+	_lastEdgeUpdateCount = _edgeUpdateCount;
+	_totalEdgeUpdateCount += _edgeUpdateCount;
+	_lastExposedArea = _exposedArea;
+	_lastBackgroundTime = _backgroundTime;
+	_edgeUpdateCount = 0;
+}
+//-----------------------------------------------------------------------------
+
+
+
+/* Statistics Access *///------------------------------------------------------
+QVector< qreal >	PaintStatistics::getHistogramBounds( )
+{
+	QVector< qreal > bounds;
+	bounds << 4. << 8. << 16.7 << 33.3 << 66.7 << 133.3;
+	return bounds;
+}
+
+int		PaintStatistics::getLastPaintedItemCount( ) const
+{
+	int count = 0;
+	foreach ( int typeCount, _lastPaintedItems )
+		count += typeCount;
+	return count;
+}
+//-----------------------------------------------------------------------------
+
+
+} // ::qan
+
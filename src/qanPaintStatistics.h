@@ -0,0 +1,161 @@
+/*
+	Copyright (C) 2008-2015 Benoit AUTHEMAN
+
+    This file is part of Qanava.
+
+    Qanava is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Qanava is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with Qanava.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//-----------------------------------------------------------------------------
+// This file is a part of the Qanava software.
+//
+// \file	qanPaintStatistics.h
+// \author	benoit@qanava.org
+// \date	2015 October 24
+//-----------------------------------------------------------------------------
+
+
+#ifndef qanPaintStatistics_h
+#define qanPaintStatistics_h
+
+
+// QT headers
+#include <QVector>
+#include <QMap>
+
+
+//-----------------------------------------------------------------------------
+namespace qan { // ::qan
+
+	//! Frame time and paint counters collected by a graph view (see GraphView::setPaintStatisticsEnabled()).
+	/*!
+		Counters are accumulated while a frame is painted (and, for edge updates, between two frames), then
+		published when the frame ends: getLast*() methods return the last complete frame counters, while the frame
+		time histogram and totals cover every frame since last reset().
+
+		\nosubgrouping
+	*/
+	class PaintStatistics
+	{
+		/*! \name PaintStatistics Constructor/Destructor *///-------------------
+		//@{
+	public:
+
+		PaintStatistics( );
+
+		//! Clear histogram, totals and last frame counters.
+		void			reset( );
+		//@}
+		//---------------------------------------------------------------------
+
+
+
+		/*! \name Counters Management *///-------------------------------------
+		//@{
+	public:
+
+		//! Start a frame, exposedArea is the exposed viewport area in pixels.
+		void			beginFrame( qint64 exposedArea );
+
+		//! End current frame and publish its counters.
+		void			endFrame( qreal frameTime );
+
+		//! Count items painted in current frame (by QGraphicsItem::type()).
+		void			addPaintedItems( int type, int count ) { _paintedItems[ type ] += count; }
+
+		void			addBackgroundTime( qreal time ) { _backgroundTime += time; }
+
+		//! Count an edge item update (see EdgeItem::updateItem()).
+		void			edgeUpdated( ) { _edgeUpdateCount++; }
+
+	protected:
+
+		QMap< int, int >	_paintedItems;
+
+		int					_edgeUpdateCount;
+
+		qint64				_exposedArea;
+
+		qreal				_backgroundTime;
+		//@}
+		//---------------------------------------------------------------------
+
+
+
+		/*! \name Statistics Access *///---------------------------------------
+		//@{
+	public:
+
+		//! Number of frames painted since last reset.
+		int					getFrameCount( ) const { return _frameCount; }
+
+		//! Return frame time histogram bucket upper bounds in ms, last bucket has no upper bound.
+		static QVector< qreal >	getHistogramBounds( );
+
+		//! Frame count per frame time bucket since last reset (see getHistogramBounds()).
+		const QVector< int >&	getFrameTimeHistogram( ) const { return _frameTimeHistogram; }
+
+		qreal				getMeanFrameTime( ) const { return _frameCount > 0 ? _totalFrameTime / _frameCount : 0.; }
+
+		qreal				getMaxFrameTime( ) const { return _maxFrameTime; }
+
+		//! Last frame paint time in ms.
+		qreal				getLastFrameTime( ) const { return _lastFrameTime; }
+
+		//! Items painted in the last frame by QGraphicsItem::type().
+		const QMap< int, int >&	getLastPaintedItems( ) const { return _lastPaintedItems; }
+
+		int					getLastPaintedItemCount( ) const;
+
+		//! Number of edge items updated since the frame before last frame.
+		int					getLastEdgeUpdateCount( ) const { return _lastEdgeUpdateCount; }
+
+		//! Exposed viewport area of the last frame in pixels.
+		qint64				getLastExposedArea( ) const { return _lastExposedArea; }
+
+		//! Time spent drawing the view background during the last frame in ms.
+		qreal				getLastBackgroundTime( ) const { return _lastBackgroundTime; }
+
+		int					getTotalEdgeUpdateCount( ) const { return _totalEdgeUpdateCount; }
+
+	protected:
+
+		int					_frameCount;
+
+		QVector< int >		_frameTimeHistogram;
+
+		qreal				_totalFrameTime;
+
+		qreal				_maxFrameTime;
+
+		qreal				_lastFrameTime;
+
+		QMap< int, int >	_lastPaintedItems;
+
+		int					_lastEdgeUpdateCount;
+
+		int					_totalEdgeUpdateCount;
+
+		qint64				_lastExposedArea;
+
+		qreal				_lastBackgroundTime;
+		//@}
+		//---------------------------------------------------------------------
+	};
+} // ::qan
+//-----------------------------------------------------------------------------
+
+
+#endif // qanPaintStatistics_h
+
@@ -27,6 +27,7 @@
 
 // Qt headers
 #include <QtMath>
+#include <QtAlgorithms>
 
 // Qanava headers
 #include "./qanSimpleLayout.h"
@@ -35,22 +36,45 @@
 namespace qan { // ::qan
 
 
+//! Order nodes by creation order, so that set layouts do not depend on the set iteration order.
+static bool	nodeSerialLessThan( const Node* a, const Node* b )
+{
+	return a->getSerial( ) < b->getSerial( );
+}
+
+static Node::List	getOrderedNodes( const Node::Set& nodes )
+{
+	Node::List orderedNodes = nodes.toList( );
+	qSort( orderedNodes.begin( ), orderedNodes.end( ), nodeSerialLessThan );
+	return orderedNodes;
+}
+
+
 /* Concentric Layout Management *///-------------------------------------------
 void	Concentric::layout( Graph& graph, QProgressDialog* progress )
+{
+	layout( graph.getNodes( ), graph.getM( ).sceneRect( ).center( ), progress );
+}
+
+void	Concentric::layout( qan::Node::List& rootNodes, qan::Node::Set& nodes, QRectF br, qan::Node* center, QProgressDialog* progress )
+{
+	Q_UNUSED( rootNodes );
+	layout( getOrderedNodes( nodes ), center != 0 ? center->getPosition( ) : br.center( ), progress );
+}
+
+void	Concentric::layout( const Node::List& nodes, QPointF center, QProgressDialog* progress )
 {
 	// Configure the progress monitor
 	if ( progress != 0 )
 	{
-		progress->setMaximum( graph.getNodeCount( ) );
+		progress->setMaximum( nodes.size( ) );
 		progress->setValue( 0 );
 	}
 
-	QPointF center = graph.getM( ).sceneRect( ).center( );
 	int		nodesPerCircle = ( int )( 360. / _azimutDelta );
-	Node::List::iterator nodeIter = graph.getNodes( ).begin( );
-	for ( int n = 0; n < ( int )graph.getNodes( ).size( ); n++, nodeIter++ )
+	for ( int n = 0; n < nodes.size( ); n++ )
 	{
-		Node& node = **nodeIter;
+		Node& node = *nodes.at( n );
 		double azimutIndex = ( n % nodesPerCircle );
 		double azimut = azimutIndex * _azimutDelta;
 
@@ -72,27 +96,31 @@ void	Concentric::layout( Graph& graph, QProgressDialog* progress )
 
 /* Colimacon Layout Management *///--------------------------------------------
 void	Colimacon::layout( Graph& graph, QProgressDialog* progress )
+{
+	layout( graph.getNodes( ), graph.getM( ).sceneRect( ).center( ), progress );
+}
+
+void	Colimacon::layout( qan::Node::List& rootNodes, qan::Node::Set& nodes, QRectF br, qan::Node* center, QProgressDialog* progress )
+{
+	Q_UNUSED( rootNodes );
+	layout( getOrderedNodes( nodes ), center != 0 ? center->getPosition( ) : br.center( ), progress );
+}
+
+void	Colimacon::layout( const Node::List& nodes, QPointF center, QProgressDialog* progress )
 {
 	// Configure the progress monitor
 	if ( progress != 0 )
 	{
-		progress->setMaximum( graph.getNodeCount( ) );
+		progress->setMaximum( nodes.size( ) );
 		progress->setValue( 0 );
 	}
 
-	QPointF center = graph.getM( ).sceneRect( ).center( );
-	int		nodesPerCircle = ( int )( 360. / _azimutDelta );
-	Q_UNUSED( nodesPerCircle );
-	Node::List::iterator nodeIter = graph.getNodes( ).begin( );
-	for ( int n = 0; n < ( int )graph.getNodes( ).size( ); n++, nodeIter++ )
+	for ( int n = 0; n < nodes.size( ); n++ )
 	{
-		Node& node = **nodeIter;
-		//double azimutIndex = ( double )( n % nodesPerCircle );
+		Node& node = *nodes.at( n );
 		double azimut = n * _azimutDelta;
-
-		//int circleIndex = 1 + ( int )( n / nodesPerCircle );
-		double cx = sin( azimut * 3.14156 / 180. ) * ( log( 1. + n ) * 10 * _circleInterval );
-		double cy = cos( azimut * 3.14156 / 180. ) * ( log( 1. + n ) * 10 * _circleInterval );
+		double cx = qSin( azimut * 3.14156 / 180. ) * ( qLn( 1. + n ) * 10 * _circleInterval );
+		double cy = qCos( azimut * 3.14156 / 180. ) * ( qLn( 1. + n ) * 10 * _circleInterval );
 
 		node.getPosition( ).rx( ) = center.x( ) + cx;
 		node.getPosition( ).ry( ) = center.y( ) + cy;
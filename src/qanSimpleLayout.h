@@ -67,6 +67,15 @@ namespace qan { // ::qan
 
 		//! .
 		virtual void	layout( Graph& graph, QProgressDialog* progress = 0 );
+
+		//! Layout a node set around center (or around br center if center is 0), nodes are placed in creation order.
+		virtual void	layout( qan::Node::List& rootNodes, qan::Node::Set& nodes, QRectF br, qan::Node* center, QProgressDialog* progress = 0 );
+
+		virtual QString	getParameters( ) const { return QString( "qan::Concentric %1 %2" ).arg( _azimutDelta ).arg( _circleInterval ); }
+
+	protected:
+
+		void			layout( const Node::List& nodes, QPointF center, QProgressDialog* progress );
 		//@}
 		//---------------------------------------------------------------------
 	};
@@ -102,6 +111,15 @@ namespace qan { // ::qan
 
 		//! .
 		virtual void	layout( Graph& graph, QProgressDialog* progress = 0 );
+
+		//! Layout a node set around center (or around br center if center is 0), nodes are placed in creation order.
+		virtual void	layout( qan::Node::List& rootNodes, qan::Node::Set& nodes, QRectF br, qan::Node* center, QProgressDialog* progress = 0 );
+
+		virtual QString	getParameters( ) const { return QString( "qan::Colimacon %1 %2" ).arg( _azimutDelta ).arg( _circleInterval ); }
+
+	protected:
+
+		void			layout( const Node::List& nodes, QPointF center, QProgressDialog* progress );
 		//@}
 		//---------------------------------------------------------------------
 	};
@@ -0,0 +1,585 @@
+/*
+	Copyright (C) 2008-2015 Benoit AUTHEMAN
+
+    This file is part of Qanava.
+
+    Qanava is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Qanava is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with Qanava.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//-----------------------------------------------------------------------------
+// This file is a part of the Qanava software.
+//
+// \file	qanStressLayout.cpp
+// \author	benoit@qanava.org
+// \date	2015 October 10
+//-----------------------------------------------------------------------------
+
+// Qt headers
+#include <QtMath>
+#include <QtConcurrent/QtConcurrentMap>
+
+// Qanava headers
+#include "./qanStressLayout.h"
+
+
+namespace qan { // ::qan
+
+
+/* Sparse Stress System *///---------------------------------------------------
+// Rows are processed by chunks of fixed size and partial sums are added in chunk order,
+// results are thus identical whatever the number of threads is.
+static const int	StressChunkSize = 256;
+
+//! Symmetric sparse stress terms stored by row (CSR), each term is stored in both of its rows.
+struct StressSystem
+{
+	QVector< int >		offsets;
+	QVector< int >		columns;
+	QVector< float >	weights;
+	QVector< float >	distances;
+	QVector< double >	diagonal;
+};
+
+struct StressTerm
+{
+	int		i;
+	int		j;
+	float	weight;
+	float	distance;
+};
+
+struct StressChunk
+{
+	int		begin;
+	int		end;
+	double	sum;
+};
+
+//! Compute something on a range of rows and return a partial sum.
+class StressKernel
+{
+public:
+	virtual ~StressKernel( ) { }
+	virtual double	run( int begin, int end ) = 0;
+};
+
+struct StressKernelFunctor
+{
+	typedef void result_type;
+	StressKernelFunctor( StressKernel* kernel ) : _kernel( kernel ) { }
+	void	operator()( StressChunk& chunk ) { chunk.sum = _kernel->run( chunk.begin, chunk.end ); }
+	StressKernel*	_kernel;
+};
+
+static double	parallelSum( StressKernel& kernel, int count )
+{
+	QVector< StressChunk > chunks;
+	for ( int begin = 0; begin < count; begin += StressChunkSize )
+	{
+		StressChunk chunk = { begin, qMin( begin + StressChunkSize, count ), 0. };
+		chunks << chunk;
+	}
+	if ( chunks.size( ) > 1 )
+		QtConcurrent::blockingMap( chunks, StressKernelFunctor( &kernel ) );
+	else if ( chunks.size( ) == 1 )
+		chunks[ 0 ].sum = kernel.run( chunks[ 0 ].begin, chunks[ 0 ].end );
+
+	double sum = 0.;
+	foreach ( const StressChunk& chunk, chunks )
+		sum += chunk.sum;
+	return sum;
+}
+
+//! Compute y = Lw.x (weighted Laplacian product) and return x.y.
+class LaplacianKernel : public StressKernel
+{
+public:
+	LaplacianKernel( const StressSystem& s, const double* x, double* y ) :
+		_offsets( s.offsets.constData( ) ), _columns( s.columns.constData( ) ), _weights( s.weights.constData( ) ),
+		_diagonal( s.diagonal.constData( ) ), _x( x ), _y( y ) { }
+
+	virtual double	run( int begin, int end )
+	{
+		double dot = 0.;
+		for ( int i = begin; i < end; i++ )
+		{
+			double yi = _diagonal[ i ] * _x[ i ];
+			for ( int t = _offsets[ i ]; t < _offsets[ i + 1 ]; t++ )
+				yi -= _weights[ t ] * _x[ _columns[ t ] ];
+			_y[ i ] = yi;
+			dot += yi * _x[ i ];
+		}
+		return dot;
+	}
+
+private:
+	const int*		_offsets;
+	const int*		_columns;
+	const float*	_weights;
+	const double*	_diagonal;
+	const double*	_x;
+	double*			_y;
+};
+
+//! Compute majorization right hand side b = Lz(X).X and return (twice) the current sparse stress.
+class MajorizationKernel : public StressKernel
+{
+public:
+	MajorizationKernel( const StressSystem& s, const double* x, const double* y, double* bx, double* by ) :
+		_offsets( s.offsets.constData( ) ), _columns( s.columns.constData( ) ), _weights( s.weights.constData( ) ),
+		_distances( s.distances.constData( ) ), _x( x ), _y( y ), _bx( bx ), _by( by ) { }
+
+	virtual double	run( int begin, int end )
+	{
+		double stress = 0.;
+		for ( int i = begin; i < end; i++ )
+		{
+			double bxi = 0., byi = 0.;
+			for ( int t = _offsets[ i ]; t < _offsets[ i + 1 ]; t++ )
+			{
+				int j = _columns[ t ];
+				double dx = _x[ i ] - _x[ j ];
+				double dy = _y[ i ] - _y[ j ];
+				double distance = qSqrt( dx * dx + dy * dy );
+				if ( distance > 1e-9 )
+				{
+					double f = _weights[ t ] * _distances[ t ] / distance;
+					bxi += f * dx;
+					byi += f * dy;
+				}
+				double delta = distance - _distances[ t ];
+				stress += _weights[ t ] * delta * delta;
+			}
+			_bx[ i ] = bxi;
+			_by[ i ] = byi;
+		}
+		return stress;
+	}
+
+private:
+	const int*		_offsets;
+	const int*		_columns;
+	const float*	_weights;
+	const float*	_distances;
+	const double*	_x;
+	const double*	_y;
+	double*			_bx;
+	double*			_by;
+};
+
+//! Return sum(w.d.|xi-xj|) or sum(w.|xi-xj|^2), used to compute the scale minimizing stress of an initial placement.
+class ScaleKernel : public StressKernel
+{
+public:
+	ScaleKernel( const StressSystem& s, const double* x, const double* y, bool numerator ) :
+		_offsets( s.offsets.constData( ) ), _columns( s.columns.constData( ) ), _weights( s.weights.constData( ) ),
+		_distances( s.distances.constData( ) ), _x( x ), _y( y ), _numerator( numerator ) { }
+
+	virtual double	run( int begin, int end )
+	{
+		double sum = 0.;
+		for ( int i = begin; i < end; i++ )
+			for ( int t = _offsets[ i ]; t < _offsets[ i + 1 ]; t++ )
+			{
+				int j = _columns[ t ];
+				double dx = _x[ i ] - _x[ j ];
+				double dy = _y[ i ] - _y[ j ];
+				double distance2 = dx * dx + dy * dy;
+				sum += ( _numerator ? _weights[ t ] * _distances[ t ] * qSqrt( distance2 ) : _weights[ t ] * distance2 );
+			}
+		return sum;
+	}
+
+private:
+	const int*		_offsets;
+	const int*		_columns;
+	const float*	_weights;
+	const float*	_distances;
+	const double*	_x;
+	const double*	_y;
+	bool			_numerator;
+};
+
+//! Solve Lw.x = b with a Jacobi preconditioned conjugate gradient, x is used as the initial guess.
+static void	solveConjugateGradient( const StressSystem& s, const QVector< double >& b, QVector< double >& x, int maxIterations, double tolerance )
+{
+	int n = x.size( );
+	QVector< double > ax( n );
+	{
+		LaplacianKernel kernel( s, x.constData( ), ax.data( ) );
+		parallelSum( kernel, n );
+	}
+
+	QVector< double > r( n ), z( n ), p( n ), ap( n );
+	double rz = 0., bb = 0.;
+	for ( int i = 0; i < n; i++ )
+	{
+		double d = ( s.diagonal[ i ] > 0. ? s.diagonal[ i ] : 1. );
+		r[ i ] = b[ i ] - ax[ i ];
+		z[ i ] = r[ i ] / d;
+		p[ i ] = z[ i ];
+		rz += r[ i ] * z[ i ];
+		bb += b[ i ] * b[ i ];
+	}
+	if ( bb <= 0. )
+		return;
+
+	double threshold = tolerance * tolerance * bb;
+	for ( int iter = 0; iter < maxIterations; iter++ )
+	{
+		LaplacianKernel kernel( s, p.constData( ), ap.data( ) );
+		double pap = parallelSum( kernel, n );
+		if ( pap <= 0. )
+			break;
+
+		double alpha = rz / pap;
+		double rr = 0.;
+		for ( int i = 0; i < n; i++ )
+		{
+			x[ i ] += alpha * p[ i ];
+			r[ i ] -= alpha * ap[ i ];
+			rr += r[ i ] * r[ i ];
+		}
+		if ( rr < threshold )
+			break;
+
+		double rzNew = 0.;
+		for ( int i = 0; i < n; i++ )
+		{
+			z[ i ] = r[ i ] / ( s.diagonal[ i ] > 0. ? s.diagonal[ i ] : 1. );
+			rzNew += r[ i ] * z[ i ];
+		}
+		double beta = rzNew / rz;
+		for ( int i = 0; i < n; i++ )
+			p[ i ] = z[ i ] + beta * p[ i ];
+		rz = rzNew;
+	}
+}
+
+//! Compute the dominant eigenvector of a k x k symmetric matrix by power iteration (optionally orthogonal to a given vector), return its eigenvalue.
+static double	dominantEigenvector( const QVector< double >& m, int k, QVector< double >& v, const QVector< double >* orthogonal = 0 )
+{
+	v.resize( k );
+	for ( int q = 0; q < k; q++ )
+		v[ q ] = 1. + q / ( double )k;	// Deterministic start vector
+
+	QVector< double > w( k );
+	double lambda = 0.;
+	for ( int iter = 0; iter < 200; iter++ )
+	{
+		if ( orthogonal != 0 )
+		{
+			double projection = 0.;
+			for ( int q = 0; q < k; q++ )
+				projection += v[ q ] * orthogonal->at( q );
+			for ( int q = 0; q < k; q++ )
+				v[ q ] -= projection * orthogonal->at( q );
+		}
+		double norm = 0.;
+		for ( int q = 0; q < k; q++ )
+			norm += v[ q ] * v[ q ];
+		norm = qSqrt( norm );
+		if ( norm < 1e-12 )
+			return 0.;
+		for ( int q = 0; q < k; q++ )
+			v[ q ] /= norm;
+
+		lambda = 0.;
+		double wNorm = 0.;
+		for ( int a = 0; a < k; a++ )
+		{
+			double wa = 0.;
+			for ( int b = 0; b < k; b++ )
+				wa += m[ a * k + b ] * v[ b ];
+			w[ a ] = wa;
+			lambda += v[ a ] * wa;
+			wNorm += wa * wa;
+		}
+		wNorm = qSqrt( wNorm );
+		if ( wNorm < 1e-12 )
+			return 0.;
+
+		double change = 0.;
+		for ( int q = 0; q < k; q++ )
+		{
+			double wq = w[ q ] / wNorm;
+			change += ( wq - v[ q ] ) * ( wq - v[ q ] );
+			v[ q ] = wq;
+		}
+		if ( change < 1e-18 )
+			break;
+	}
+	return lambda;
+}
+//-----------------------------------------------------------------------------
+
+
+
+/* Stress Layout Generation Management *///------------------------------------
+void	StressMajorization::layout( qan::Node::List& rootNodes, qan::Node::Set& nodes, QRectF br, qan::Node* center, QProgressDialog* progress )
+{
+	Q_UNUSED( rootNodes ); Q_UNUSED( center );
+	_iterationCount = 0;
+
+	GraphIndex index( nodes );
+	int n = index.getNodeCount( );
+	if ( n == 0 )
+		return;
+	if ( progress != 0 )
+	{
+		progress->setMaximum( _maxIterations );
+		progress->setValue( 0 );
+	}
+
+	// Collect graph theoretical distances from pivots and generate an initial placement
+	QVector< int > pivots;
+	QVector< QVector< int > > distances;
+	selectPivots( index, pivots, distances );
+
+	QVector< double > x, y;
+	if ( !initializePivotMds( n, distances, x, y ) )
+	{
+		x.resize( n ); y.resize( n );
+		for ( int i = 0; i < n; i++ )	// Degenerated graphs: place nodes on a circle
+		{
+			qreal angle = 2. * M_PI * i / n;
+			x[ i ] = qCos( angle ) * n / ( 2. * M_PI );
+			y[ i ] = qSin( angle ) * n / ( 2. * M_PI );
+		}
+	}
+
+	// Build sparse stress terms: adjacent nodes, and pivots weighted by the size of their region (nodes closer to this pivot than to any other)
+	QVector< int > pivotRanks( n, -1 );
+	for ( int q = 0; q < pivots.size( ); q++ )
+		pivotRanks[ pivots[ q ] ] = q;
+
+	QVector< int > regionSizes( pivots.size( ), 0 );
+	for ( int i = 0; i < n; i++ )
+	{
+		int nearest = -1;
+		for ( int q = 0; q < pivots.size( ); q++ )
+			if ( distances[ q ][ i ] >= 0 && ( nearest < 0 || distances[ q ][ i ] < distances[ nearest ][ i ] ) )
+				nearest = q;
+		if ( nearest >= 0 )
+			regionSizes[ nearest ]++;
+	}
+
+	QVector< StressTerm > terms;
+	terms.reserve( index.getEdgeCount( ) + n * pivots.size( ) );
+	const QVector< int >& adjacents = index.getAdjacents( );
+	const QVector< float >& weights = index.getWeights( );
+	for ( int i = 0; i < n; i++ )
+	{
+		for ( int a = index.getOffset( i ); a < index.getOffset( i ) + index.getDegree( i ); a++ )
+			if ( adjacents[ a ] > i )	// Store each undirected edge once
+			{
+				StressTerm term = { i, adjacents[ a ], ( float )( qMax( weights[ a ], 0.01f ) / ( _edgeLength * _edgeLength ) ), ( float )_edgeLength };
+				terms << term;
+			}
+		for ( int q = 0; q < pivots.size( ); q++ )
+		{
+			int hops = distances[ q ][ i ];
+			if ( hops <= 1 )	// Pivot itself, adjacent nodes (already in edges terms) or unreachable pivot
+				continue;
+			if ( pivotRanks[ i ] >= 0 && pivotRanks[ i ] > q )	// Pivot to pivot terms are stored once
+				continue;
+			float distance = ( float )( hops * _edgeLength );
+			StressTerm term = { i, pivots[ q ], regionSizes[ q ] / ( distance * distance ), distance };
+			terms << term;
+		}
+	}
+
+	StressSystem system;
+	system.offsets.fill( 0, n + 1 );
+	foreach ( const StressTerm& term, terms )
+	{
+		system.offsets[ term.i + 1 ]++;
+		system.offsets[ term.j + 1 ]++;
+	}
+	for ( int i = 0; i < n; i++ )
+		system.offsets[ i + 1 ] += system.offsets[ i ];
+	system.columns.resize( terms.size( ) * 2 );
+	system.weights.resize( terms.size( ) * 2 );
+	system.distances.resize( terms.size( ) * 2 );
+	system.diagonal.fill( 0., n );
+	QVector< int > fill( system.offsets );
+	foreach ( const StressTerm& term, terms )
+	{
+		int ti = fill[ term.i ]++;
+		system.columns[ ti ] = term.j; system.weights[ ti ] = term.weight; system.distances[ ti ] = term.distance;
+		int tj = fill[ term.j ]++;
+		system.columns[ tj ] = term.i; system.weights[ tj ] = term.weight; system.distances[ tj ] = term.distance;
+		system.diagonal[ term.i ] += term.weight;
+		system.diagonal[ term.j ] += term.weight;
+	}
+	terms.clear( );
+
+	// Scale initial placement to minimize stress, then slightly perturb coincident nodes
+	{
+		ScaleKernel numerator( system, x.constData( ), y.constData( ), true );
+		ScaleKernel denominator( system, x.constData( ), y.constData( ), false );
+		double num = parallelSum( numerator, n );
+		double den = parallelSum( denominator, n );
+		double scale = ( den > 0. ? num / den : _edgeLength );
+		for ( int i = 0; i < n; i++ )
+		{
+			x[ i ] = x[ i ] * scale + 1e-3 * _edgeLength * ( ( i * 7919 ) % 101 ) / 101.;
+			y[ i ] = y[ i ] * scale + 1e-3 * _edgeLength * ( ( i * 104729 ) % 103 ) / 103.;
+		}
+	}
+
+	// Stress majorization
+	QVector< double > bx( n ), by( n );
+	double previousStress = -1.;
+	for ( int iter = 0; iter < _maxIterations; iter++ )
+	{
+		MajorizationKernel kernel( system, x.constData( ), y.constData( ), bx.data( ), by.data( ) );
+		double stress = parallelSum( kernel, n ) / 2.;
+		if ( previousStress >= 0. && previousStress - stress < _tolerance * previousStress )
+			break;
+		previousStress = stress;
+
+		solveConjugateGradient( system, bx, x, 25, 1e-3 );
+		solveConjugateGradient( system, by, y, 25, 1e-3 );
+		_iterationCount++;
+
+		if ( progress != 0 )
+			progress->setValue( iter );
+		if ( progress != 0 && progress->wasCanceled( ) )
+			break;
+	}
+
+	// Center the layout in br and convert centers to nodes top left position
+	double minX = x[ 0 ], maxX = x[ 0 ], minY = y[ 0 ], maxY = y[ 0 ];
+	for ( int i = 1; i < n; i++ )
+	{
+		minX = qMin( minX, x[ i ] ); maxX = qMax( maxX, x[ i ] );
+		minY = qMin( minY, y[ i ] ); maxY = qMax( maxY, y[ i ] );
+	}
+	QPointF offset = br.center( ) - QPointF( ( minX + maxX ) / 2., ( minY + maxY ) / 2. );
+	for ( int i = 0; i < n; i++ )
+	{
+		Node* node = index.getNode( i );
+		QSizeF size = getNodeSize( *node );
+		node->setPosition( QPointF( x[ i ], y[ i ] ) + offset - QPointF( size.width( ) / 2., size.height( ) / 2. ) );
+	}
+
+	if ( progress != 0 )
+		progress->close( );
+}
+
+QString	StressMajorization::getParameters( ) const
+{
+	return QString( "qan::StressMajorization %1 %2 %3 %4" ).arg( _edgeLength ).arg( _pivotCount ).arg( _maxIterations ).arg( _tolerance );
+}
+
+/*!
+	First pivot is the node with maximum degree, then the node maximizing the distance to already selected
+	pivots is choosen (unreachable nodes first, so that every connected component get a pivot when possible).
+ */
+void	StressMajorization::selectPivots( const GraphIndex& index, QVector< int >& pivots, QVector< QVector< int > >& distances )
+{
+	int n = index.getNodeCount( );
+	int k = qMin( qMax( _pivotCount, 1 ), n );
+
+	int pivot = 0;
+	for ( int i = 1; i < n; i++ )
+		if ( index.getDegree( i ) > index.getDegree( pivot ) )
+			pivot = i;
+
+	QVector< int > minDistances( n, n + 1 );
+	for ( int q = 0; q < k; q++ )
+	{
+		pivots << pivot;
+		distances << QVector< int >( );
+		index.bfs( pivot, distances.last( ) );
+
+		const QVector< int >& pivotDistances = distances.last( );
+		int next = 0;
+		for ( int i = 0; i < n; i++ )
+		{
+			minDistances[ i ] = qMin( minDistances[ i ], pivotDistances[ i ] < 0 ? n : pivotDistances[ i ] );
+			if ( minDistances[ i ] > minDistances[ next ] )
+				next = i;
+		}
+		if ( minDistances[ next ] == 0 )	// Every node is a pivot
+			break;
+		pivot = next;
+	}
+}
+
+bool	StressMajorization::initializePivotMds( int n, const QVector< QVector< int > >& distances, QVector< double >& x, QVector< double >& y )
+{
+	int k = distances.size( );
+	if ( n < 3 || k < 2 )
+		return false;
+
+	int maxDistance = 0;
+	foreach ( const QVector< int >& pivotDistances, distances )
+		foreach ( int d, pivotDistances )
+			maxDistance = qMax( maxDistance, d );
+
+	// Double centered squared distances matrix C (n x k, row major), unreachable nodes are considered just behind the farthest node
+	QVector< double > c( n * k );
+	QVector< double > rowMeans( n, 0. ), columnMeans( k, 0. );
+	double mean = 0.;
+	for ( int i = 0; i < n; i++ )
+		for ( int q = 0; q < k; q++ )
+		{
+			int d = distances[ q ][ i ];
+			double d2 = ( d < 0 ? ( maxDistance + 1. ) * ( maxDistance + 1. ) : ( double )d * d );
+			c[ i * k + q ] = d2;
+			rowMeans[ i ] += d2 / k;
+			columnMeans[ q ] += d2 / n;
+			mean += d2;
+		}
+	mean /= ( double )n * k;
+	for ( int i = 0; i < n; i++ )
+		for ( int q = 0; q < k; q++ )
+			c[ i * k + q ] = -0.5 * ( c[ i * k + q ] - rowMeans[ i ] - columnMeans[ q ] + mean );
+
+	// Two dominant eigenvectors of Ct.C (k x k) give the MDS axis
+	QVector< double > m( k * k, 0. );
+	for ( int i = 0; i < n; i++ )
+	{
+		const double* ci = c.constData( ) + i * k;
+		for ( int a = 0; a < k; a++ )
+			for ( int b = 0; b <= a; b++ )
+				m[ a * k + b ] += ci[ a ] * ci[ b ];
+	}
+	for ( int a = 0; a < k; a++ )
+		for ( int b = a + 1; b < k; b++ )
+			m[ a * k + b ] = m[ b * k + a ];
+
+	QVector< double > v1, v2;
+	if ( dominantEigenvector( m, k, v1 ) <= 1e-12 )
+		return false;
+	if ( dominantEigenvector( m, k, v2, &v1 ) <= 1e-12 )
+		return false;
+
+	x.fill( 0., n );
+	y.fill( 0., n );
+	for ( int i = 0; i < n; i++ )
+		for ( int q = 0; q < k; q++ )
+		{
+			x[ i ] += c[ i * k + q ] * v1[ q ];
+			y[ i ] += c[ i * k + q ] * v2[ q ];
+		}
+	return true;
+}
+//-----------------------------------------------------------------------------
+
+
+} // ::qan
+
@@ -0,0 +1,112 @@
+/*
+	Copyright (C) 2008-2015 Benoit AUTHEMAN
+
+    This file is part of Qanava.
+
+    Qanava is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Qanava is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with Qanava.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//-----------------------------------------------------------------------------
+// This file is a part of the Qanava software.
+//
+// \file	qanStressLayout.h
+// \author	benoit@qanava.org
+// \date	2015 October 10
+//-----------------------------------------------------------------------------
+
+
+#ifndef qanStressLayout_h
+#define qanStressLayout_h
+
+
+// Qanava headers
+#include "./qanLayout.h"
+#include "./qanGraphIndex.h"
+
+
+// QT headers
+#include <QVector>
+
+
+//-----------------------------------------------------------------------------
+namespace qan { // ::qan
+
+	//! Layout an undirected graph by sparse stress majorization.
+	/*!
+		Stress is approximated with terms for adjacent nodes and for a subset of k pivot nodes
+		(sparse stress, Ortmann, Klimenta and Brandes), graph theoretical distances are computed
+		with k BFS traversals. Initial positions are generated with pivot MDS (Brandes and Pich),
+		each majorization step then solves the weighted Laplacian system with a Jacobi preconditioned
+		conjugate gradient. Matrix products are computed in parallel, an iteration costs O(k.(n+m)).
+
+		Layout is deterministic: pivots, initial positions and iterations only depend on the input
+		nodes labels and topology.
+
+		\nosubgrouping
+	*/
+	class StressMajorization : public Layout
+	{
+		Q_OBJECT
+
+		/*! \name StressMajorization Constructor/Destructor *///----------------
+		//@{
+	public:
+
+		//! StressMajorization constructor.
+		/*!	\param	edgeLength		Desired distance between adjacent nodes centers.
+			\param	pivotCount		Number of pivots used for initial placement and sparse stress terms.
+			\param	maxIterations	Maximum number of majorization steps.
+			\param	tolerance		Stop iterating when relative stress decrease falls below tolerance.	*/
+		StressMajorization( qreal edgeLength = 100., int pivotCount = 40, int maxIterations = 100, qreal tolerance = 1e-4 ) :
+			Layout( ), _edgeLength( edgeLength ), _pivotCount( pivotCount ), _maxIterations( maxIterations ),
+			_tolerance( tolerance ) { }
+
+	protected:
+
+		qreal			_edgeLength;
+
+		int				_pivotCount;
+
+		int				_maxIterations;
+
+		qreal			_tolerance;
+		//@}
+		//---------------------------------------------------------------------
+
+
+
+		/*! \name Stress Layout Generation Management *///---------------------
+		//@{
+	public:
+
+		virtual void	layout( qan::Node::List& rootNodes, qan::Node::Set& nodes, QRectF br, qan::Node* center, QProgressDialog* progress = 0 );
+
+		virtual QString	getParameters( ) const;
+
+	protected:
+
+		//! Select pivots with a max/min strategy starting from the node with maximum degree, and collect pivots BFS distances.
+		void			selectPivots( const GraphIndex& index, QVector< int >& pivots, QVector< QVector< int > >& distances );
+
+		//! Generate initial centers positions with pivot MDS (x and y are in graph theoretical distance units).
+		bool			initializePivotMds( int nodeCount, const QVector< QVector< int > >& distances, QVector< double >& x, QVector< double >& y );
+		//@}
+		//---------------------------------------------------------------------
+	};
+} // ::qan
+//-----------------------------------------------------------------------------
+
+
+#endif // qanStressLayout_h
+
@@ -36,6 +36,9 @@
 #include <QVariant>
 #include <QFont>
 #include <QSet>
+#include <QImage>
+#include <QtMath>
+#include <qdrawutil.h>
 
 
 namespace qan { // ::qan
@@ -94,6 +97,10 @@ StyleManager::StyleManager( qan::Graph* graph, QObject* parent ) :
 	nodeStyle->addProperty( "Has Shadow", QVariant( true ) );
 	nodeStyle->addProperty( "Shadow Color", QVariant( QColor( 50, 50, 50 ) ) );
 	nodeStyle->addProperty( "Shadow Offset", QVariant( QSizeF( 2., 2. ) ) );
+	nodeStyle->addProperty( "Shadow Blur", QVariant( 2.0 ) );
+	nodeStyle->addProperty( "Lod Full Detail", QVariant( 0.6 ) );
+	nodeStyle->addProperty( "Lod Reduced Detail", QVariant( 0.3 ) );
+	nodeStyle->addProperty( "Lod Minimal Detail", QVariant( 0.1 ) );
 
 	qan::Style* edgeStyle = addStyle( "default edge", "qan::Edge" );
 	lineStyles.clear( ); lineStyles << "Solid line" << "Dash line" << "Dot line" << "Dash Dot line" << "Dash Dot Dot line";
@@ -102,6 +109,9 @@ StyleManager::StyleManager( qan::Graph* graph, QObject* parent ) :
 	edgeStyle->addProperty( "Line Width", QVariant( 1.2 ) );
 	edgeStyle->addProperty( "Arrow Size", QVariant( 4.0 ) );
     edgeStyle->addProperty( "Draw Bounding Rect", QVariant( false ) );
+	edgeStyle->addProperty( "Lod Full Detail", QVariant( 0.6 ) );
+	edgeStyle->addProperty( "Lod Reduced Detail", QVariant( 0.3 ) );
+	edgeStyle->addProperty( "Lod Minimal Detail", QVariant( 0.1 ) );
 
 	qan::Style* hEdgeStyle = addStyle( "default hyper edge", "qan::HEdge" );
 	lineStyles.clear( ); lineStyles << "Solid line" << "Dash line" << "Dot line" << "Dash Dot line" << "Dash Dot Dot line";
@@ -115,6 +125,9 @@ StyleManager::StyleManager( qan::Graph* graph, QObject* parent ) :
 	hEdgeStyle->addProperty( "Line In Style", QtVariantPropertyManager::enumTypeId(),  lineStyles );
 	hEdgeStyle->addProperty( "Line Out Style", QtVariantPropertyManager::enumTypeId(),  lineStyles );
 	hEdgeStyle->addProperty( "Hyper Line Width", QVariant( 1.2 ) );
+	hEdgeStyle->addProperty( "Lod Full Detail", QVariant( 0.6 ) );
+	hEdgeStyle->addProperty( "Lod Reduced Detail", QVariant( 0.3 ) );
+	hEdgeStyle->addProperty( "Lod Minimal Detail", QVariant( 0.1 ) );
 }
 
 StyleManager::~StyleManager( )
@@ -123,6 +136,7 @@ StyleManager::~StyleManager( )
 	foreach ( Style* style, styles )
 			delete style;
 	clearImages( );
+	clearShadows( );
 }
 //-----------------------------------------------------------------------------
 
@@ -206,9 +220,8 @@ void	StyleManager::styleEdge( qan::Edge& edge, QString styleName, bool updateIte
 	if ( style != 0 )
 	{
 		_edgeStyleMap.insert( &edge, style );
-		GraphItem* edgeItem = _graph.getM( ).getGraphItem( edge );	// Update edge item with the new style
-		if ( edgeItem != 0 && updateItem )
-			edgeItem->updateItemStyle( );
+		if ( updateItem )	// Update edge item (or edge layer) with the new style
+			_graph.getM( ).updateEdgeItemStyle( edge );
 	}
 }
 
@@ -272,11 +285,7 @@ void	StyleManager::propertyValueChanged( QtProperty* p, const QVariant& value )
 				node->getGraphItem( )->updateItemStyle( );
 		}
 		foreach ( qan::Edge* edge, edges )
-		{
-			GraphItem* edgeItem = _graph.getM( ).getGraphItem( *edge );
-			if ( edgeItem != 0 )
-				edgeItem->updateItemStyle( );
-		}
+			_graph.getM( ).updateEdgeItemStyle( *edge );
 	}
 }
 //-----------------------------------------------------------------------------
@@ -305,5 +314,113 @@ void	StyleManager::clearImages( )
 //-----------------------------------------------------------------------------
 
 
+/* Shadow Cache Management *///------------------------------------------------
+/*!
+	The cached pixmap only depends on color, blur and corner radius (offset is applied when drawing). Corners are
+	drawn unscaled while borders and center are stretched to fit rect, so a single pixmap serves every rect size.
+ */
+void	StyleManager::drawShadow( QPainter* painter, const QRectF& rect, QColor color, QPointF offset, qreal blurRadius, qreal cornerRadius )
+{
+	if ( painter == 0 || !color.isValid( ) || rect.isEmpty( ) )
+		return;
+	QPixmap shadow = getShadow( color, blurRadius, cornerRadius );
+	if ( shadow.isNull( ) )
+		return;
+
+	int blurExtent = getShadowBlurExtent( blurRadius );
+	int patch = getShadowPatchSize( blurRadius, cornerRadius );
+	QRect target = rect.translated( offset ).adjusted( -blurExtent, -blurExtent, blurExtent, blurExtent ).toAlignedRect( );
+	int targetPatch = qMin( patch, qMin( target.width( ), target.height( ) ) / 2 );	// Shrink corners for rects smaller than the nine-patch
+	qDrawBorderPixmap( painter, target, QMargins( targetPatch, targetPatch, targetPatch, targetPatch ),
+					   shadow, shadow.rect( ), QMargins( patch, patch, patch, patch ) );
+}
+
+//! Blur a premultiplied image along one axis with a box filter, pixels outside of the image are transparent.
+static void	boxBlur( QImage& image, int radius, bool horizontal )
+{
+	QRgb* bits = reinterpret_cast< QRgb* >( image.bits( ) );
+	int rowStride = image.bytesPerLine( ) / 4;
+	int length = horizontal ? image.width( ) : image.height( );
+	int lines = horizontal ? image.height( ) : image.width( );
+	int step = horizontal ? 1 : rowStride;
+	int lineStep = horizontal ? rowStride : 1;
+	int window = 2 * radius + 1;
+
+	QVector< QRgb > source( length );
+	for ( int l = 0; l < lines; l++ )
+	{
+		QRgb* line = bits + l * lineStep;
+		for ( int i = 0; i < length; i++ )
+			source[ i ] = line[ i * step ];
+		for ( int i = 0; i < length; i++ )
+		{
+			int a = 0, r = 0, g = 0, b = 0;
+			for ( int k = qMax( 0, i - radius ); k <= qMin( length - 1, i + radius ); k++ )
+			{
+				a += qAlpha( source[ k ] );
+				r += qRed( source[ k ] );
+				g += qGreen( source[ k ] );
+				b += qBlue( source[ k ] );
+			}
+			line[ i * step ] = qRgba( r / window, g / window, b / window, a / window );
+		}
+	}
+}
+
+QPixmap	StyleManager::getShadow( QColor color, qreal blurRadius, qreal cornerRadius )
+{
+	QString key = QString( "%1_%2_%3" ).arg( color.rgba( ) ).arg( blurRadius ).arg( cornerRadius );
+	QPixmap shadow = _nameShadowMap.value( key, QPixmap( ) );
+	if ( !shadow.isNull( ) )
+		return shadow;
+
+	// Render the shape with a one pixel wide center, then blur it (three box blur passes approximate a gaussian blur)
+	int blurExtent = getShadowBlurExtent( blurRadius );
+	int patch = getShadowPatchSize( blurRadius, cornerRadius );
+	int size = 2 * patch + 1;
+	QImage image( size, size, QImage::Format_ARGB32_Premultiplied );
+	image.fill( Qt::transparent );
+	{
+		QPainter painter( &image );
+		painter.setRenderHint( QPainter::Antialiasing );
+		painter.setPen( Qt::NoPen );
+		painter.setBrush( color );
+		QRectF shape( blurExtent, blurExtent, size - 2 * blurExtent, size - 2 * blurExtent );
+		painter.drawRoundedRect( shape, cornerRadius, cornerRadius );
+	}
+	int boxRadius = blurExtent / 3;
+	for ( int pass = 0; pass < 3 && boxRadius > 0; pass++ )
+	{
+		boxBlur( image, boxRadius, true );
+		boxBlur( image, boxRadius, false );
+	}
+
+	shadow = QPixmap::fromImage( image );
+	_nameShadowMap.insert( key, shadow );
+	return shadow;
+}
+
+qreal	StyleManager::getShadowMargin( QPointF offset, qreal blurRadius )
+{
+	return qMax( qAbs( offset.x( ) ), qAbs( offset.y( ) ) ) + getShadowBlurExtent( blurRadius ) + 1.;
+}
+
+void	StyleManager::clearShadows( )
+{
+	_nameShadowMap.clear( );
+}
+
+int		StyleManager::getShadowBlurExtent( qreal blurRadius )
+{
+	return 3 * qMax( 1, qRound( blurRadius / 2. ) );
+}
+
+int		StyleManager::getShadowPatchSize( qreal blurRadius, qreal cornerRadius )
+{
+	return 2 * getShadowBlurExtent( blurRadius ) + qCeil( qMax( cornerRadius, 0. ) );
+}
+//-----------------------------------------------------------------------------
+
+
 } // ::qan
 
@@ -36,6 +36,8 @@
 #include <QList>
 #include <QMap>
 #include <QAbstractListModel>
+#include <QPixmap>
+#include <QPainter>
 
 // QT Solutions (qtpropertybrowser) headers
 #include "QtVariantProperty"
@@ -196,6 +198,42 @@ namespace qan // ::qan
 		NameImageMap	_nameImageMap;
 		//@}
 		//---------------------------------------------------------------------
+
+
+		/*! \name Shadow Cache Management *///---------------------------------
+		//@{
+	public:
+
+		//! Draw a blurred rounded rect shadow under a given rect (in painter CS) using a cached nine-patch pixmap.
+		/*!	\param	rect			Rect of the shape casting the shadow.
+			\param	offset			Shadow offset relatively to rect.
+			\param	blurRadius		Shadow blur radius.
+			\param	cornerRadius	Radius of the shape rounded corners (0. for a rectangular shape). */
+		void			drawShadow( QPainter* painter, const QRectF& rect, QColor color, QPointF offset, qreal blurRadius, qreal cornerRadius );
+
+		//! Get a cached nine-patch shadow pixmap, pixmap is rendered and blurred on the first request for a combination of parameters.
+		QPixmap			getShadow( QColor color, qreal blurRadius, qreal cornerRadius );
+
+		//! Get the distance a shadow could be drawn outside of the rect casting it.
+		static qreal	getShadowMargin( QPointF offset, qreal blurRadius );
+
+		//! Clear all cached shadow pixmaps.
+		void			clearShadows( );
+
+	protected:
+
+		//! Get the distance a blurred shape spreads outside of its border for a given blur radius.
+		static int		getShadowBlurExtent( qreal blurRadius );
+
+		//! Get the size of a shadow nine-patch corner.
+		static int		getShadowPatchSize( qreal blurRadius, qreal cornerRadius );
+
+		typedef QMap< QString, QPixmap >	NameShadowMap;
+
+		//! Map shadow parameters to pre-blurred nine-patch pixmaps.
+		NameShadowMap	_nameShadowMap;
+		//@}
+		//---------------------------------------------------------------------
 	};
 } // ::qan
 //-----------------------------------------------------------------------------
@@ -0,0 +1,306 @@
+/*
+	Copyright (C) 2008-2015 Benoit AUTHEMAN
+
+    This file is part of Qanava.
+
+    Qanava is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Qanava is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with Qanava.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//-----------------------------------------------------------------------------
+// This file is a part of the Qanava software.
+//
+// \file	qanTileCache.cpp
+// \author	benoit@qanava.org
+// \date	2015 October 23
+//-----------------------------------------------------------------------------
+
+// Qt headers
+#include <QPainter>
+#include <QPicture>
+#include <QThread>
+#include <QtMath>
+#include <QtConcurrent/QtConcurrentRun>
+
+// Qanava headers
+#include "./qanTileCache.h"
+#include "./qanGraphScene.h"
+
+
+namespace qan { // ::qan
+
+
+/* TileCache Constructor/Destructor *///---------------------------------------
+TileCache::TileCache( QGraphicsView& view, int tileSize ) :
+	QObject( &view ),
+	_view( view ),
+	_scene( 0 ),
+	_tileSize( qMax( 16, tileSize ) ),
+	_capacity( 256 ),
+	_maxPending( qMax( 2, QThread::idealThreadCount( ) ) ),
+	_recordBudget( 8 ),
+	_level( 0 )
+{
+	_refreshTimer.setSingleShot( true );
+	_refreshTimer.setInterval( 250 );
+	connect( &_refreshTimer, SIGNAL( timeout( ) ), this, SLOT( refresh( ) ) );
+	_recordTimer.setSingleShot( true );
+	_recordTimer.setInterval( 0 );
+	connect( &_recordTimer, SIGNAL( timeout( ) ), this, SLOT( recordTiles( ) ) );
+	setScene( view.scene( ) );
+}
+
+TileCache::~TileCache( )
+{
+	foreach ( QFutureWatcher< QImage >* watcher, _pendingTiles.keys( ) )
+	{
+		watcher->waitForFinished( );
+		delete watcher;
+	}
+}
+
+/*!	When the scene is a qan::GraphScene, tiles are invalidated with the areas of graph items changes, wherever
+	they occur: tiles prefetched out of the view and areas repainted in other views are invalidated too.
+ */
+void	TileCache::setScene( QGraphicsScene* scene )
+{
+	if ( scene != _scene )
+	{
+		GraphScene* graphScene = qobject_cast< GraphScene* >( _scene );
+		if ( graphScene != 0 )
+			disconnect( graphScene, SIGNAL( contentChanged( const QList< QRectF >& ) ), this, SLOT( invalidate( const QList< QRectF >& ) ) );
+		_scene = scene;
+		graphScene = qobject_cast< GraphScene* >( _scene );
+		if ( graphScene != 0 )
+			connect( graphScene, SIGNAL( contentChanged( const QList< QRectF >& ) ), this, SLOT( invalidate( const QList< QRectF >& ) ) );
+	}
+	clear( );
+}
+//-----------------------------------------------------------------------------
+
+
+
+/* Tile Management *///--------------------------------------------------------
+static QImage	rasterizeTile( QPicture picture, int tileSize )
+{
+	QImage image( tileSize, tileSize, QImage::Format_ARGB32_Premultiplied );
+	image.fill( Qt::transparent );
+	QPainter painter( &image );
+	picture.play( &painter );
+	return image;
+}
+
+int		TileCache::getLevel( qreal scale )
+{
+	return qRound( 2. * qLn( qMax( scale, 0.0001 ) ) / qLn( 2. ) );
+}
+
+qreal	TileCache::getLevelScale( int level )
+{
+	return qPow( 2., level / 2. );
+}
+
+QRectF	TileCache::getTileRect( const TileKey& key ) const
+{
+	qreal extent = _tileSize / getLevelScale( key.level );
+	return QRectF( key.x * extent, key.y * extent, extent, extent );
+}
+
+void	TileCache::draw( QPainter& painter, const QRectF& exposedRect, qreal scale, QVector< QRectF >& liveRects )
+{
+	_level = getLevel( scale );
+	qreal extent = _tileSize / getLevelScale( _level );
+	int left = qFloor( exposedRect.left( ) / extent );
+	int right = qFloor( exposedRect.right( ) / extent );
+	int top = qFloor( exposedRect.top( ) / extent );
+	int bottom = qFloor( exposedRect.bottom( ) / extent );
+	if ( ( right - left + 1 ) * ( bottom - top + 1 ) > _capacity / 2 )
+	{
+		liveRects.append( exposedRect );	// Too many tiles to be cached, everything is drawn live
+		return;
+	}
+
+	bool smooth = painter.testRenderHint( QPainter::SmoothPixmapTransform );
+	painter.setRenderHint( QPainter::SmoothPixmapTransform, true );	// Tiles are scaled when view scale is between two levels
+	for ( int y = top; y <= bottom; y++ )
+		for ( int x = left; x <= right; x++ )
+		{
+			TileKey key = { _level, x, y };
+			QHash< TileKey, QImage >::const_iterator tile = _tiles.constFind( key );
+			if ( tile == _tiles.constEnd( ) )
+			{
+				liveRects.append( getTileRect( key ) );
+				continue;
+			}
+			painter.drawImage( getTileRect( key ), tile.value( ) );
+			_tileOrder.removeOne( key );
+			_tileOrder.append( key );
+		}
+	painter.setRenderHint( QPainter::SmoothPixmapTransform, smooth );
+
+	// Recording scene items is as expensive as painting them, it is never done while the view is painting
+	_visibleRect = exposedRect;
+	_prefetchRect = exposedRect.adjusted( -exposedRect.width( ) / 2., -exposedRect.height( ) / 2.,
+										  exposedRect.width( ) / 2., exposedRect.height( ) / 2. );
+	scheduleRecording( );
+}
+
+void	TileCache::clear( )
+{
+	_staleTiles.unite( _pendingKeys );
+	_tiles.clear( );
+	_tileOrder.clear( );
+	_liveTiles.clear( );
+}
+
+/*!	Invalidated tiles of the current level inside the prefetch area are drawn live until the scene has not changed
+	for a while, so that tiles under edited or animated items are not recorded again at every frame.
+ */
+void	TileCache::invalidate( const QList< QRectF >& rects )
+{
+	if ( rects.isEmpty( ) )
+		return;
+	QRectF dirtyBr;
+	foreach ( const QRectF& rect, rects )
+		dirtyBr |= rect;
+	foreach ( const TileKey& key, _tiles.keys( ) )
+	{
+		QRectF tileRect = getTileRect( key );
+		if ( !tileRect.intersects( dirtyBr ) )
+			continue;
+		foreach ( const QRectF& rect, rects )
+			if ( tileRect.intersects( rect ) )
+			{
+				_tiles.remove( key );
+				_tileOrder.removeOne( key );
+				break;
+			}
+	}
+	foreach ( const TileKey& key, _pendingKeys )
+		foreach ( const QRectF& rect, rects )
+			if ( getTileRect( key ).intersects( rect ) )
+				_staleTiles.insert( key );
+
+	qreal extent = _tileSize / getLevelScale( _level );
+	foreach ( const QRectF& rect, rects )
+	{
+		QRectF liveRect = rect.intersected( _prefetchRect );
+		if ( liveRect.isEmpty( ) )
+			continue;
+		for ( int y = qFloor( liveRect.top( ) / extent ); y <= qFloor( liveRect.bottom( ) / extent ); y++ )
+			for ( int x = qFloor( liveRect.left( ) / extent ); x <= qFloor( liveRect.right( ) / extent ); x++ )
+			{
+				TileKey key = { _level, x, y };
+				_liveTiles.insert( key );
+			}
+	}
+	_refreshTimer.start( );
+}
+
+void	TileCache::tileRasterized( )
+{
+	QFutureWatcher< QImage >* watcher = static_cast< QFutureWatcher< QImage >* >( sender( ) );
+	TileKey key = _pendingTiles.take( watcher );
+	_pendingKeys.remove( key );
+	if ( !_staleTiles.remove( key ) )
+		insertTile( key, watcher->result( ) );
+	watcher->deleteLater( );
+
+	// Tile content is already drawn live in the view, there is no need to update it: continue prefetching
+	scheduleRecording( );
+}
+
+void	TileCache::refresh( )
+{
+	_liveTiles.clear( );
+	scheduleRecording( );
+}
+
+void	TileCache::scheduleRecording( )
+{
+	if ( !_recordTimer.isActive( ) )
+		_recordTimer.start( );
+}
+
+/*!	When the budget is spent, recording continues in the next event loop iteration, so that user input and
+	view repaints are processed between recorded tiles. When the maximum number of pending tiles is reached,
+	recording continues when a tile has been rasterized.
+ */
+void	TileCache::recordTiles( )
+{
+	QElapsedTimer timer;
+	timer.start( );
+	if ( requestTiles( _visibleRect, timer ) && requestTiles( _prefetchRect, timer ) )
+		return;		// Every missing tile is cached or being rasterized
+	if ( _pendingTiles.size( ) < _maxPending )
+		scheduleRecording( );
+}
+
+bool	TileCache::requestTiles( const QRectF& rect, const QElapsedTimer& timer )
+{
+	if ( _scene == 0 || rect.isEmpty( ) )
+		return true;
+	qreal extent = _tileSize / getLevelScale( _level );
+	int left = qFloor( rect.left( ) / extent );
+	int right = qFloor( rect.right( ) / extent );
+	int top = qFloor( rect.top( ) / extent );
+	int bottom = qFloor( rect.bottom( ) / extent );
+	if ( ( right - left + 1 ) * ( bottom - top + 1 ) > _capacity )
+		return true;
+	for ( int y = top; y <= bottom; y++ )
+		for ( int x = left; x <= right; x++ )
+		{
+			TileKey key = { _level, x, y };
+			if ( _tiles.contains( key ) || _pendingKeys.contains( key ) || _liveTiles.contains( key ) )
+				continue;
+			if ( _pendingTiles.size( ) >= _maxPending || timer.elapsed( ) >= _recordBudget )
+				return false;
+			request( key );
+		}
+	return true;
+}
+
+/*!	Items are painted in the picture with the tile level scale, so that items level of detail matches the level.
+ */
+void	TileCache::request( const TileKey& key )
+{
+	QRectF tileRect = getTileRect( key );
+	qreal levelScale = getLevelScale( key.level );
+	QPicture picture;
+	QPainter painter( &picture );
+	painter.setRenderHints( _view.renderHints( ) );
+	painter.scale( levelScale, levelScale );
+	painter.translate( -tileRect.topLeft( ) );
+	_scene->render( &painter, tileRect, tileRect, Qt::IgnoreAspectRatio );
+	painter.end( );
+
+	QFutureWatcher< QImage >* watcher = new QFutureWatcher< QImage >( );
+	connect( watcher, SIGNAL( finished( ) ), this, SLOT( tileRasterized( ) ) );
+	_pendingTiles.insert( watcher, key );
+	_pendingKeys.insert( key );
+	watcher->setFuture( QtConcurrent::run( rasterizeTile, picture, _tileSize ) );
+}
+
+void	TileCache::insertTile( const TileKey& key, const QImage& image )
+{
+	_tiles.insert( key, image );
+	_tileOrder.removeOne( key );
+	_tileOrder.append( key );
+	while ( _tiles.size( ) > _capacity && !_tileOrder.isEmpty( ) )
+		_tiles.remove( _tileOrder.takeFirst( ) );
+}
+//-----------------------------------------------------------------------------
+
+
+} // ::qan
+
@@ -0,0 +1,216 @@
+/*
+	Copyright (C) 2008-2015 Benoit AUTHEMAN
+
+    This file is part of Qanava.
+
+    Qanava is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Qanava is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with Qanava.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//-----------------------------------------------------------------------------
+// This file is a part of the Qanava software.
+//
+// \file	qanTileCache.h
+// \author	benoit@qanava.org
+// \date	2015 October 23
+//-----------------------------------------------------------------------------
+
+
+#ifndef qanTileCache_h
+#define qanTileCache_h
+
+
+// QT headers
+#include <QObject>
+#include <QGraphicsView>
+#include <QFutureWatcher>
+#include <QImage>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QSet>
+#include <QList>
+#include <QVector>
+#include <QRectF>
+
+
+//-----------------------------------------------------------------------------
+namespace qan { // ::qan
+
+	//! Tile coordinates at a given zoom level.
+	struct TileKey
+	{
+		int		level;
+		int		x;
+		int		y;
+
+		bool	operator==( const TileKey& key ) const { return level == key.level && x == key.x && y == key.y; }
+	};
+
+	inline uint	qHash( const TileKey& key ) { return ::qHash( key.level ) ^ ::qHash( key.x * 73856093 ) ^ ::qHash( key.y * 19349663 ); }
+
+	//! Cache rasterized scene tiles at quantized zoom levels for a graphics view.
+	/*!
+		The scene is split in square tiles of getTileSize() pixels at zoom levels quantized by half octaves. A
+		missing tile is recorded in a QPicture on the GUI thread (QGraphicsScene is not thread safe), then rasterized
+		in a QImage on a worker thread. Tiles are never recorded while the view is painting: recording is queued in
+		the event loop and limited to a time budget per event loop iteration (see setRecordBudget()).
+
+		Tiles are invalidated with the areas of graph items changes published by qan::GraphScene::contentChanged(),
+		including tiles prefetched out of the view, and by the view with the rects of its repainted regions for
+		other items (see GraphView::setTileCacheEnabled()). The cache does not listen to QGraphicsScene::changed(),
+		since a connection to this signal disables scene direct updates to its views. Recently invalidated tiles are not rasterized again until the scene content
+		under them has been stable for a while: items being edited or animated are drawn live by the view.
+
+		See GraphView::setTileCacheEnabled().
+
+		\nosubgrouping
+	*/
+	class TileCache : public QObject
+	{
+		Q_OBJECT
+
+		/*! \name TileCache Constructor/Destructor *///-------------------------
+		//@{
+	public:
+
+		//! TileCache constructor, cache is owned by the given view.
+		TileCache( QGraphicsView& view, int tileSize = 256 );
+
+		//! Wait for pending rasterizations before destroying the cache.
+		virtual ~TileCache( );
+
+		//! Set the scene rendered in tiles (cache is cleared).
+		void			setScene( QGraphicsScene* scene );
+
+	protected:
+
+		QGraphicsView&	_view;
+
+		QGraphicsScene*	_scene;
+		//@}
+		//---------------------------------------------------------------------
+
+
+
+		/*! \name Tile Management *///-----------------------------------------
+		//@{
+	public:
+
+		//! Draw cached tiles covering an exposed rect (in scene CS) at a given view scale.
+		/*! Tiles that are missing or have been invalidated recently are returned in liveRects (in scene CS), items
+			under them must be drawn by the caller. Recording of missing tiles in and around the exposed rect is
+			scheduled once control returns to the event loop. */
+		void			draw( QPainter& painter, const QRectF& exposedRect, qreal scale, QVector< QRectF >& liveRects );
+
+		//! Remove all cached tiles, pending rasterizations results are discarded.
+		void			clear( );
+
+		int				getTileSize( ) const { return _tileSize; }
+
+		//! Set the maximum number of cached tiles (default to 256), least recently drawn tiles are evicted first.
+		void			setCapacity( int capacity ) { _capacity = qMax( 1, capacity ); }
+
+		int				getCapacity( ) const { return _capacity; }
+
+		//! Set the maximum time spent recording tiles on the GUI thread per event loop iteration, in ms (default to 8ms).
+		/*! At least one tile is recorded per iteration, whatever the budget. */
+		void			setRecordBudget( int recordBudget ) { _recordBudget = qMax( 1, recordBudget ); }
+
+		int				getRecordBudget( ) const { return _recordBudget; }
+
+		//! Return the quantized zoom level of a view scale.
+		static int		getLevel( qreal scale );
+
+		//! Return the view scale of a quantized zoom level.
+		static qreal	getLevelScale( int level );
+
+		//! Return a tile rect in scene CS.
+		QRectF			getTileRect( const TileKey& key ) const;
+
+	public slots:
+
+		//! Invalidate tiles intersecting dirty scene rects.
+		void			invalidate( const QList< QRectF >& rects );
+
+	protected slots:
+
+		void			tileRasterized( );
+
+		//! Allow invalidated tiles to be rasterized again.
+		void			refresh( );
+
+		//! Record missing tiles of the last drawn rect, then of the prefetch area, until the record budget is spent.
+		void			recordTiles( );
+
+	protected:
+
+		//! Schedule recordTiles() once control returns to the event loop, multiple calls are coalesced.
+		void			scheduleRecording( );
+
+		//! Request rasterization of missing tiles in a rect (in scene CS) at the current level.
+		/*! Return false if recording has been interrupted by the record budget or by the maximum number of pending tiles. */
+		bool			requestTiles( const QRectF& rect, const QElapsedTimer& timer );
+
+		//! Record a tile content and start its rasterization on a worker thread.
+		void			request( const TileKey& key );
+
+		//! Insert a rasterized tile, evicting least recently drawn tiles.
+		void			insertTile( const TileKey& key, const QImage& image );
+
+		int				_tileSize;
+
+		int				_capacity;
+
+		//! Maximum number of tiles being rasterized at the same time.
+		int				_maxPending;
+
+		//! Maximum tile recording time per event loop iteration in ms.
+		int				_recordBudget;
+
+		//! Zoom level of the last draw.
+		int				_level;
+
+		//! Last drawn rect, its missing tiles are recorded first.
+		QRectF			_visibleRect;
+
+		//! Area around the last drawn rect where missing tiles are prefetched.
+		QRectF			_prefetchRect;
+
+		QHash< TileKey, QImage >	_tiles;
+
+		//! Cached tiles, least recently drawn first.
+		QList< TileKey >			_tileOrder;
+
+		QHash< QFutureWatcher< QImage >*, TileKey >	_pendingTiles;
+
+		QSet< TileKey >				_pendingKeys;
+
+		//! Pending tiles invalidated during their rasterization, results are discarded.
+		QSet< TileKey >				_staleTiles;
+
+		//! Tiles invalidated recently, drawn live until refresh().
+		QSet< TileKey >				_liveTiles;
+
+		QTimer						_refreshTimer;
+
+		QTimer						_recordTimer;
+		//@}
+		//---------------------------------------------------------------------
+	};
+} // ::qan
+//-----------------------------------------------------------------------------
+
+
+#endif // qanTileCache_h
+
@@ -77,7 +77,7 @@ QRectF	HierarchyTree::layout( Node& node, QPointF topLeft, int depth, QProgressD
 
 	// Setup position of this node
 	node.setPosition( topLeft );
-	topLeft.rx( ) += node.getGraphicsItem( )->sceneBoundingRect( ).width( ) + _spacing.x( );
+	topLeft.rx( ) += getNodeSize( node ).width( ) + _spacing.x( );
 
 	// Set subnodes position
 	QRectF subNodesBr;
@@ -92,14 +92,14 @@ QRectF	HierarchyTree::layout( Node& node, QPointF topLeft, int depth, QProgressD
 	QPointF nodePosition( node.getPosition( ) );
 	if ( node.getOutDegree( ) != 0 )	// do not adjust height if there is no multiple sub nodes
 	{
-		nodePosition.ry( ) = subNodesBr.top( ) + ( subNodesBr.height( ) - node.getGraphicsItem( )->sceneBoundingRect( ).height( ) ) / 2.; 
+		nodePosition.ry( ) = subNodesBr.top( ) + ( subNodesBr.height( ) - getNodeSize( node ).height( ) ) / 2.; 
 		node.setPosition( nodePosition );
 	}
 
 	if ( progress != 0 )
 		progress->setValue( progress->value( ) + 1 );
 
-	return subNodesBr.united( QRectF( node.getPosition( ), node.getGraphicsItem( )->sceneBoundingRect( ).size( ) ) );
+	return subNodesBr.united( QRectF( node.getPosition( ), getNodeSize( node ) ) );
 }
 //-----------------------------------------------------------------------------
 
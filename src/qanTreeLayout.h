@@ -64,6 +64,8 @@ namespace qan { // ::qan
 		//! Layout a node group as a hierarchy tree.
 		virtual void	layout( qan::Node::List& rootNodes, qan::Node::Set& nodes, QRectF br, qan::Node* center, QProgressDialog* progress = 0 );
 
+		virtual QString	getParameters( ) const { return QString( "qan::HierarchyTree %1 %2" ).arg( _spacing.x( ) ).arg( _spacing.y( ) ); }
+
 	protected:
 
 		//! Layout a node hierarchy as a hierarchy tree.
@@ -4,7 +4,7 @@ FORMS		= qanMainWindow.ui
 CONFIG		+= qt warn_on
 DEFINES		+= QANAVA  
 LANGUAGE	= C++
-QT		+= widgets xml core gui
+QT		+= widgets xml core gui concurrent
 INCLUDEPATH += ../../src $(QTPROPERTYBROWSER)/src
 
 RESOURCES += container.qrc
@@ -3,7 +3,7 @@ TARGET		= test-custom
 CONFIG		+= qt warn_on
 DEFINES		+= QANAVA  
 LANGUAGE	= C++
-QT		+= widgets core gui
+QT		+= widgets core gui concurrent
 INCLUDEPATH += ../../src $(QTPROPERTYBROWSER)/src
 
 RESOURCES += custom.qrc
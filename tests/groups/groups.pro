@@ -4,7 +4,7 @@ FORMS		= qanMainWindow.ui
 CONFIG		+= qt warn_on
 DEFINES		+= QANAVA  
 LANGUAGE	= C++
-QT		+= widgets core gui
+QT		+= widgets core gui concurrent
 INCLUDEPATH     += ../../src $(QTPROPERTYBROWSER)/src
 
 SOURCES	+=  qanApp.cpp          \
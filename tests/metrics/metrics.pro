@@ -0,0 +1,27 @@
+TEMPLATE	= app
+TARGET		= test-metrics
+CONFIG		+= qt warn_on console
+DEFINES		+= QANAVA  
+LANGUAGE	= C++
+QT		+= widgets core gui concurrent
+INCLUDEPATH     += ../../src $(QTPROPERTYBROWSER)/src
+
+SOURCES	+=  qanMetrics.cpp
+
+CONFIG(debug, debug|release) {
+    linux-g++*: LIBS	+= -L../../build/ -lqanavad -L$(QTPROPERTYBROWSER)/lib -lqtpropertybrowserd
+    android:    LIBS	+= -L../../build/ -lqanavad -L$(QTPROPERTYBROWSER)/lib -lqtpropertybrowserd
+    win32:      PRE_TARGETDEPS += ../../build/qanavad.lib
+    win32:      OBJECTS_DIR = ./Debug
+    win32:      LIBS	+= ../../build/qanavad.lib $(QTPROPERTYBROWSER)/lib/libqtpropertybrowserd.lib
+}
+
+CONFIG(release, debug|release) {
+    linux-g++*: LIBS	+= -L../../build/ -lqanava -L$(QTPROPERTYBROWSER)/lib -lqtpropertybrowser
+    android:    LIBS	+= -L../../build/ -lqanava -L$(QTPROPERTYBROWSER)/lib -lqtpropertybrowser
+    win32:      PRE_TARGETDEPS += ../../build/qanava.lib
+    win32:      OBJECTS_DIR = ./Release
+    win32:      LIBS	+= ../../build/qanava.lib $(QTPROPERTYBROWSER)/lib/libqtpropertybrowser.lib
+}
+
+
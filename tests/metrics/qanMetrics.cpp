@@ -0,0 +1,401 @@
+/*
+	Copyright (C) 2008-2015 Benoit AUTHEMAN
+
+    This file is part of Qanava.
+
+    Qanava is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Qanava is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with Qanava.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//-----------------------------------------------------------------------------
+// This file is a part of the Qanava software.
+//
+// \file	qanMetrics.cpp
+// \author	benoit@qanava.org
+// \date	2015 October 18
+//-----------------------------------------------------------------------------
+
+// Layout metrics driver: run every layout over a generated graph corpus and write a CSV report.
+//
+// Usage: test-metrics [-platform offscreen] [-o report.csv] [-crossings segmentCount] [-clicks itemCount] [-reload itemCount] [-routes caseCount]
+//	-o			Write report to a file instead of standard output.
+//	-crossings	Only benchmark crossing counting on segmentCount random segments (1000000 for example).
+//	-clicks		Only benchmark GraphScene::getNodeAt() latency on a scene of itemCount node and edge items (200000 for example).
+//	-reload		Only benchmark load and Graph::clear() cycles of a graph with itemCount node and edge items shown in a view.
+//	-routes		Only check EdgeRouter::route() on caseCount random obstacle sets (100 for example), exit code is 1 if a route is invalid.
+
+
+// Qanava headers
+#include "../../src/qanGraph.h"
+#include "../../src/qanLayout.h"
+#include "../../src/qanSimpleLayout.h"
+#include "../../src/qanTreeLayout.h"
+#include "../../src/qanStressLayout.h"
+#include "../../src/qanComponentLayout.h"
+#include "../../src/qanOverlapRemoval.h"
+#include "../../src/qanLayoutMetrics.h"
+#include "../../src/qanEdgeRouter.h"
+
+// QT headers
+#include <QApplication>
+#include <QGraphicsView>
+#include <QFile>
+#include <QTextStream>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QtMath>
+
+using namespace qan;
+
+
+//-----------------------------------------------------------------------------
+static const char*	graphNames[] = { "random", "tree", "grid", "disconnected" };
+static const int	graphCount = 4;
+
+static const char*	layoutNames[] = { "random", "undirected", "concentric", "colimacon", "hierarchy", "stress", "component_stress", "undirected_overlap" };
+static const int	layoutCount = 8;
+
+//! Insert a random DAG (edges always go from a lower to a higher node index).
+static void	generateRandom( Graph& graph, int nodeCount, int edgeCount, QString prefix )
+{
+	Node::List nodes;
+	for ( int n = 0; n < nodeCount; n++ )
+		nodes << graph.insertNode( QString( "%1%2" ).arg( prefix ).arg( n ) );
+	for ( int e = 0; e < edgeCount; e++ )
+	{
+		int a = qrand( ) % nodeCount;
+		int b = qrand( ) % nodeCount;
+		if ( a == b || graph.hasEdge( *nodes[ qMin( a, b ) ], *nodes[ qMax( a, b ) ] ) )
+			continue;
+		graph.insertEdge( *nodes[ qMin( a, b ) ], *nodes[ qMax( a, b ) ] );
+	}
+}
+
+//! Generate the corpus graph of a given index, generation is deterministic.
+static void	generateGraph( Graph& graph, int graphIndex )
+{
+	qsrand( 42 + graphIndex );
+	switch ( graphIndex )
+	{
+	case 0:
+		generateRandom( graph, 200, 400, "r" );
+		break;
+	case 1:		// Complete binary tree
+	{
+		Node::List nodes;
+		for ( int n = 0; n < 255; n++ )
+		{
+			nodes << graph.insertNode( QString( "t%1" ).arg( n ) );
+			if ( n > 0 )
+				graph.insertEdge( *nodes[ ( n - 1 ) / 2 ], *nodes[ n ] );
+		}
+	}
+		break;
+	case 2:		// 15x15 grid
+	{
+		const int size = 15;
+		Node::List nodes;
+		for ( int n = 0; n < size * size; n++ )
+			nodes << graph.insertNode( QString( "g%1" ).arg( n ) );
+		for ( int y = 0; y < size; y++ )
+			for ( int x = 0; x < size; x++ )
+			{
+				if ( x + 1 < size )
+					graph.insertEdge( *nodes[ y * size + x ], *nodes[ y * size + x + 1 ] );
+				if ( y + 1 < size )
+					graph.insertEdge( *nodes[ y * size + x ], *nodes[ ( y + 1 ) * size + x ] );
+			}
+	}
+		break;
+	case 3:
+		for ( int c = 0; c < 4; c++ )
+			generateRandom( graph, 50, 80, QString( "c%1_" ).arg( c ) );
+		break;
+	}
+}
+
+static Layout*	createLayout( int layoutIndex )
+{
+	switch ( layoutIndex )
+	{
+	case 0: return new Random( );
+	case 1: return new UndirectedGraph( );
+	case 2: return new Concentric( );
+	case 3: return new Colimacon( );
+	case 4: return new HierarchyTree( );
+	case 5: return new StressMajorization( );
+	case 6: return new ComponentLayout( new LayoutFactory< StressMajorization >( ) );
+	case 7: return new OverlapRemoval( new UndirectedGraph( ) );
+	}
+	return 0;
+}
+
+static void	runLayouts( QTextStream& report )
+{
+	report << "graph,layout," << LayoutMetrics::getCsvHeader( ) << "\n";
+	for ( int g = 0; g < graphCount; g++ )
+		for ( int l = 0; l < layoutCount; l++ )
+		{
+			// Use a fresh graph for each layout, so that layouts do not depend on previous positions
+			Graph* graph = new Graph( );
+			generateGraph( *graph, g );
+			Layout* layout = createLayout( l );
+
+			LayoutMetrics metrics;
+			metrics.measure( *graph, *layout, QRectF( 0., 0., 1500., 1500. ) );
+			report << graphNames[ g ] << "," << layoutNames[ l ] << "," << metrics.toCsv( ) << "\n";
+			report.flush( );
+
+			delete layout;
+			delete graph;
+		}
+}
+
+//! Count crossings of randomly oriented segments spread uniformly, with an average length close to the grid cell size.
+static void	runCrossings( QTextStream& report, int segmentCount )
+{
+	qsrand( 42 );
+	qreal side = 100. * qSqrt( ( qreal )segmentCount );
+	QVector< QLineF > segments;
+	segments.reserve( segmentCount );
+	for ( int s = 0; s < segmentCount; s++ )
+	{
+		QPointF p( side * ( qrand( ) / ( qreal )RAND_MAX ), side * ( qrand( ) / ( qreal )RAND_MAX ) );
+		qreal angle = 2. * M_PI * ( qrand( ) / ( qreal )RAND_MAX );
+		qreal length = 150. * ( qrand( ) / ( qreal )RAND_MAX );
+		segments << QLineF( p, p + QPointF( length * qCos( angle ), length * qSin( angle ) ) );
+	}
+
+	QElapsedTimer timer;
+	timer.start( );
+	qint64 crossings = LayoutMetrics::countCrossings( segments, QVector< int >( ) );
+	report << "segments,crossings,wall_time_ms\n";
+	report << segmentCount << "," << crossings << "," << timer.elapsed( ) << "\n";
+}
+
+//! Insert a side x side grid of nodes spaced by 100 units, a grid with n nodes has close to 2n edges.
+static void	insertGrid( Graph& graph, int side )
+{
+	Node::List nodes;
+	for ( int n = 0; n < side * side; n++ )
+	{
+		Node* node = graph.insertNode( QString( "n%1" ).arg( n ) );
+		node->setPosition( QPointF( ( n % side ) * 100., ( n / side ) * 100. ) );
+		nodes << node;
+	}
+	for ( int y = 0; y < side; y++ )
+		for ( int x = 0; x < side; x++ )
+		{
+			if ( x + 1 < side )
+				graph.insertEdge( *nodes[ y * side + x ], *nodes[ y * side + x + 1 ] );
+			if ( y + 1 < side )
+				graph.insertEdge( *nodes[ y * side + x ], *nodes[ ( y + 1 ) * side + x ] );
+		}
+	graph.getM( ).updatePositions( );
+}
+
+//! Measure node picking latency on a grid graph with and without the scene index.
+static void	runClicks( QTextStream& report, int itemCount )
+{
+	int side = qMax( 2, ( int )qSqrt( itemCount / 3. ) );
+	Graph* graph = new Graph( );
+	GraphScene& scene = graph->getM( );
+	scene.suspendIndex( );
+	insertGrid( *graph, side );
+
+	report << "items,index,clicks,hits,index_build_ms,mean_click_us\n";
+	const int clickCount = 1000;
+	for ( int i = 0; i < 2; i++ )
+	{
+		QElapsedTimer timer;
+		timer.start( );
+		if ( i == 0 )
+			scene.resumeIndex( );
+		else
+			scene.setIndexPolicy( GraphScene::IndexNever );
+		scene.items( QPointF( 0., 0. ) );	// Force index build
+		qint64 buildTime = timer.elapsed( );
+
+		qsrand( 42 );
+		int hits = 0;
+		timer.restart( );
+		for ( int c = 0; c < clickCount; c++ )
+		{
+			QPointF p( side * 100. * ( qrand( ) / ( qreal )RAND_MAX ), side * 100. * ( qrand( ) / ( qreal )RAND_MAX ) );
+			if ( scene.getNodeAt( p ) != 0 )
+				hits++;
+		}
+		qint64 clickTime = timer.nsecsElapsed( ) / 1000;
+		report << scene.items( ).size( ) << "," << ( i == 0 ? "bsp" : "none" ) << "," << clickCount << "," << hits << ","
+			   << buildTime << "," << ( clickTime / ( qreal )clickCount ) << "\n";
+		report.flush( );
+	}
+	delete graph;
+}
+
+//! Measure dataset switching: load a grid graph in a scene attached to a view, then clear the graph, several times.
+static void	runReload( QTextStream& report, int itemCount )
+{
+	int side = qMax( 2, ( int )qSqrt( itemCount / 3. ) );
+	Graph* graph = new Graph( );
+	GraphScene& scene = graph->getM( );
+	QGraphicsView* view = new QGraphicsView( &scene );	// Not shown, scene still notifies its views
+
+	report << "cycle,nodes,edges,items,load_ms,clear_ms\n";
+	const int cycleCount = 5;
+	for ( int c = 0; c < cycleCount; c++ )
+	{
+		QElapsedTimer timer;
+		timer.start( );
+		scene.suspendIndex( );
+		insertGrid( *graph, side );
+		scene.resumeIndex( );
+		qint64 loadTime = timer.elapsed( );
+		int nodeCount = graph->getNodeCount( );
+		int edgeCount = graph->getEdges( ).size( );
+		int sceneItemCount = scene.items( ).size( );
+
+		timer.restart( );
+		graph->clear( );
+		qint64 clearTime = timer.elapsed( );
+		report << c << "," << nodeCount << "," << edgeCount << "," << sceneItemCount << "," << loadTime << "," << clearTime << "\n";
+		report.flush( );
+	}
+	delete view;
+	delete graph;
+}
+
+static QRectF	randomRect( qreal side )
+{
+	QPointF p( side * ( qrand( ) / ( qreal )RAND_MAX ), side * ( qrand( ) / ( qreal )RAND_MAX ) );
+	return QRectF( p, QSizeF( 20. + qrand( ) % 100, 20. + qrand( ) % 60 ) );
+}
+
+static bool	isOnBorder( const QPointF& p, const QRectF& rect )
+{
+	const qreal e = 0.001;
+	return rect.adjusted( -e, -e, e, e ).contains( p ) && !rect.adjusted( e, e, -e, -e ).contains( p );
+}
+
+//! Return true if an axis aligned segment goes through an obstacle interior.
+static bool	isBlocked( const QPointF& a, const QPointF& b, const QRectF& obstacle )
+{
+	const qreal e = 0.001;
+	QRectF inside = obstacle.adjusted( e, e, -e, -e );
+	if ( a.y( ) == b.y( ) )
+		return a.y( ) > inside.top( ) && a.y( ) < inside.bottom( ) && qMax( a.x( ), b.x( ) ) > inside.left( ) && qMin( a.x( ), b.x( ) ) < inside.right( );
+	return a.x( ) > inside.left( ) && a.x( ) < inside.right( ) && qMax( a.y( ), b.y( ) ) > inside.top( ) && qMin( a.y( ), b.y( ) ) < inside.bottom( );
+}
+
+//! Check orthogonal routes on random obstacle sets: segments must be axis aligned, start on source border and end on
+//! destination border. Return the number of invalid routes.
+/*! Segments going through an obstacle are reported but not considered invalid, since the router falls back to an
+	elbow route when obstacles enclose the source or the destination. */
+static int	runRoutes( QTextStream& report, int caseCount )
+{
+	qsrand( 42 );
+	EdgeRouter router;
+	int invalidCount = 0;
+	report << "case,obstacles,points,orthogonal,endpoints,blocked_segments\n";
+	for ( int c = 0; c < caseCount; c++ )
+	{
+		QRectF srcRect = randomRect( 1000. );
+		QRectF dstRect = randomRect( 1000. );
+		if ( srcRect.intersects( dstRect ) )
+			dstRect.translate( 0., srcRect.bottom( ) - dstRect.top( ) + 50. );
+		QVector< QRectF > obstacles;
+		for ( int o = 0; o < 12; o++ )
+		{
+			QRectF obstacle = randomRect( 1000. );
+			if ( !obstacle.intersects( srcRect.adjusted( -10., -10., 10., 10. ) ) && !obstacle.intersects( dstRect.adjusted( -10., -10., 10., 10. ) ) )
+				obstacles << obstacle;
+		}
+
+		QPolygonF polyline = router.route( srcRect, dstRect, obstacles );
+		bool orthogonal = polyline.size( ) >= 2;
+		int blockedSegments = 0;
+		for ( int p = 1; p < polyline.size( ); p++ )
+		{
+			if ( polyline[ p - 1 ].x( ) != polyline[ p ].x( ) && polyline[ p - 1 ].y( ) != polyline[ p ].y( ) )
+			{
+				orthogonal = false;
+				continue;
+			}
+			foreach ( const QRectF& obstacle, obstacles )
+				if ( isBlocked( polyline[ p - 1 ], polyline[ p ], obstacle ) )
+				{
+					blockedSegments++;
+					break;
+				}
+		}
+		bool endpoints = polyline.size( ) >= 2 && isOnBorder( polyline.first( ), srcRect ) && isOnBorder( polyline.last( ), dstRect );
+		if ( !orthogonal || !endpoints )
+			invalidCount++;
+		report << c << "," << obstacles.size( ) << "," << polyline.size( ) << "," << orthogonal << "," << endpoints << "," << blockedSegments << "\n";
+	}
+	report << "invalid_routes," << invalidCount << "\n";
+	return invalidCount;
+}
+
+int	main( int argc, char** argv )
+{
+	QApplication app( argc, argv );
+
+	QString fileName;
+	int segmentCount = 0;
+	int itemCount = 0;
+	int reloadCount = 0;
+	int routeCount = 0;
+	QStringList arguments = app.arguments( );
+	for ( int a = 1; a < arguments.size( ) - 1; a++ )
+	{
+		if ( arguments[ a ] == "-o" )
+			fileName = arguments[ ++a ];
+		else if ( arguments[ a ] == "-crossings" )
+			segmentCount = arguments[ ++a ].toInt( );
+		else if ( arguments[ a ] == "-clicks" )
+			itemCount = arguments[ ++a ].toInt( );
+		else if ( arguments[ a ] == "-reload" )
+			reloadCount = arguments[ ++a ].toInt( );
+		else if ( arguments[ a ] == "-routes" )
+			routeCount = arguments[ ++a ].toInt( );
+	}
+
+	QFile file;
+	if ( !fileName.isEmpty( ) )
+	{
+		file.setFileName( fileName );
+		if ( !file.open( QIODevice::WriteOnly | QIODevice::Text ) )
+		{
+			qWarning( "test-metrics: can't open %s", qPrintable( fileName ) );
+			return 1;
+		}
+	}
+	else
+		file.open( stdout, QIODevice::WriteOnly | QIODevice::Text );
+	QTextStream report( &file );
+
+	if ( segmentCount > 0 )
+		runCrossings( report, segmentCount );
+	else if ( itemCount > 0 )
+		runClicks( report, itemCount );
+	else if ( reloadCount > 0 )
+		runReload( report, reloadCount );
+	else if ( routeCount > 0 )
+		return ( runRoutes( report, routeCount ) > 0 ? 1 : 0 );
+	else
+		runLayouts( report );
+	return 0;
+}
+//-----------------------------------------------------------------------------
+